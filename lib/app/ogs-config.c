@@ -132,6 +132,19 @@ int ogs_config_read()
     return OGS_OK;
 }
 
+#define MAX_NUM_OF_UE_TIMER     8   /* Num of Timer per UE */
+#define MAX_NUM_OF_XACT_TIMER   2   /* Num of Timer per Transaction */
+#define MIN_NUM_OF_XACT         512
+#define MIN_NUM_OF_TIMER        512
+
+static void recalculate_timer_pool_size(void)
+{
+    /* Transactions include the 1/16 reserve of ogs_gtp_xact_init() */
+    self.pool.timer = MIN_NUM_OF_TIMER +
+        self.pool.ue * MAX_NUM_OF_UE_TIMER + self.pool.bearer +
+        (self.pool.xact + self.pool.xact/16 + 1) * MAX_NUM_OF_XACT_TIMER;
+}
+
 static void recalculate_pool_size(void)
 {
 #define MAX_NUM_OF_BEARER       4   /* Num of Bearer per APN(Session) */
@@ -143,6 +156,9 @@ static void recalculate_pool_size(void)
     self.pool.bearer = self.pool.sess * MAX_NUM_OF_BEARER;
     self.pool.tunnel = self.pool.bearer * MAX_NUM_OF_TUNNEL;
     self.pool.pf = self.pool.bearer * MAX_NUM_OF_PF;
+
+    self.pool.xact = ogs_max(self.pool.ue, MIN_NUM_OF_XACT);
+    recalculate_timer_pool_size();
 }
 
 static int config_prepare(void)
@@ -163,6 +179,14 @@ static int config_prepare(void)
     self.max.enb = MAX_NUM_OF_ENB;
     self.max.ue = MAX_NUM_OF_UE;
 
+#define GTPU_BATCH_SIZE             32  /* Num of Datagram per syscall */
+    self.parameter.gtpu_batch = GTPU_BATCH_SIZE;
+
+#define DB_CACHE_SIZE               65536   /* KB */
+    self.parameter.db_cache = DB_CACHE_SIZE;
+#define DB_CACHE_TTL                5       /* Seconds */
+    self.parameter.db_cache_ttl = DB_CACHE_TTL;
+
 #define MAX_NUM_OF_PACKET_POOL      65536
     self.pool.packet = MAX_NUM_OF_PACKET_POOL;
 
@@ -182,6 +206,40 @@ static int ogs_app_ctx_validation(void)
         return OGS_ERROR;
     }
 
+    if (self.parameter.gtpu_batch < 1 ||
+        self.parameter.gtpu_batch > OGS_MAX_NUM_OF_MMSG) {
+        ogs_error("`gtpu_batch` must be between 1 and %d in `%s`",
+                OGS_MAX_NUM_OF_MMSG, self.file);
+        return OGS_ERROR;
+    }
+
+    if (self.parameter.gtpu_worker < 0) {
+        ogs_error("`gtpu_worker` must not be negative in `%s`", self.file);
+        return OGS_ERROR;
+    }
+
+    if (self.pool.xact < 1 || self.pool.timer < 1) {
+        ogs_error("`pool.xact` and `pool.timer` must be positive in `%s`",
+                self.file);
+        return OGS_ERROR;
+    }
+
+    if (self.parameter.mme_worker < 0 || self.parameter.mme_worker > 32) {
+        ogs_error("`mme_worker` must be between 0 and 32 in `%s`", self.file);
+        return OGS_ERROR;
+    }
+
+    if (self.parameter.db_cache < 0) {
+        ogs_error("`db_cache` must not be negative in `%s`", self.file);
+        return OGS_ERROR;
+    }
+
+    if (self.parameter.db_cache_ttl < 0) {
+        ogs_error("`db_cache_ttl` must not be negative in `%s`",
+                self.file);
+        return OGS_ERROR;
+    }
+
     return OGS_OK;
 }
 int ogs_config_parse()
@@ -218,6 +276,8 @@ int ogs_config_parse()
                 } else if (!strcmp(logger_key, "domain")) {
                     self.logger.domain =
                         ogs_yaml_iter_value(&logger_iter);
+                } else if (!strcmp(logger_key, "async")) {
+                    self.logger.async = ogs_yaml_iter_bool(&logger_iter);
                 }
             }
         } else if (!strcmp(root_key, "parameter")) {
@@ -253,6 +313,24 @@ int ogs_config_parse()
                 } else if (!strcmp(parameter_key, "no_slaac")) {
                     self.parameter.no_slaac =
                         ogs_yaml_iter_bool(&parameter_iter);
+                } else if (!strcmp(parameter_key, "gtpu_batch")) {
+                    const char *v = ogs_yaml_iter_value(&parameter_iter);
+                    if (v) self.parameter.gtpu_batch = atoi(v);
+                } else if (!strcmp(parameter_key, "gtpu_worker")) {
+                    const char *v = ogs_yaml_iter_value(&parameter_iter);
+                    if (v) self.parameter.gtpu_worker = atoi(v);
+                } else if (!strcmp(parameter_key, "mme_worker")) {
+                    const char *v = ogs_yaml_iter_value(&parameter_iter);
+                    if (v) self.parameter.mme_worker = atoi(v);
+                } else if (!strcmp(parameter_key, "db_cache")) {
+                    const char *v = ogs_yaml_iter_value(&parameter_iter);
+                    if (v) self.parameter.db_cache = atoi(v);
+                } else if (!strcmp(parameter_key, "db_cache_ttl")) {
+                    const char *v = ogs_yaml_iter_value(&parameter_iter);
+                    if (v) self.parameter.db_cache_ttl = atoi(v);
+                } else if (!strcmp(parameter_key, "timer_wheel")) {
+                    self.parameter.timer_wheel =
+                        ogs_yaml_iter_bool(&parameter_iter);
                 } else
                     ogs_warn("unknown key `%s`", parameter_key);
             }
@@ -350,6 +428,16 @@ int ogs_config_parse()
                     const char *v = ogs_yaml_iter_value(&pool_iter);
                     if (v)
                         self.pool.packet = atoi(v);
+                } else if (!strcmp(pool_key, "xact")) {
+                    const char *v = ogs_yaml_iter_value(&pool_iter);
+                    if (v) {
+                        self.pool.xact = atoi(v);
+                        recalculate_timer_pool_size();
+                    }
+                } else if (!strcmp(pool_key, "timer")) {
+                    const char *v = ogs_yaml_iter_value(&pool_iter);
+                    if (v)
+                        self.pool.timer = atoi(v);
                 } else
                     ogs_warn("unknown key `%s`", pool_key);
             }
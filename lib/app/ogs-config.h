@@ -39,6 +39,7 @@ typedef struct ogs_config_s {
         const char *file;
         const char *level;
         const char *domain;
+        int async;
     } logger;
 
     struct {
@@ -54,6 +55,20 @@ typedef struct ogs_config_s {
         int prefer_ipv4;
         int multicast;
         int no_slaac;
+
+        /* User Plane */
+        int gtpu_batch;
+        int gtpu_worker;
+
+        /* Control Plane */
+        int mme_worker;
+
+        /* Subscriber Database */
+        int db_cache;           /* KB, 0: Disabled */
+        int db_cache_ttl;       /* Seconds without change streams */
+
+        /* Timer */
+        int timer_wheel;
     } parameter;
 
     ogs_sockopt_t sockopt;
@@ -79,6 +94,9 @@ typedef struct ogs_config_s {
         int bearer;
         int tunnel;
         int pf;
+
+        int xact;       /* GTP Transaction */
+        int timer;      /* Timer per Timer Manager */
     } pool;
 } ogs_config_t;
 
@@ -86,6 +86,10 @@ int ogs_app_initialize(const char *default_config, const char *const argv[])
      */
     ogs_pkbuf_default_create(&ogs_config()->pool.defconfig);
 
+    /* Every Timer Manager created from now on uses these settings */
+    ogs_core()->timer.pool = ogs_config()->pool.timer;
+    ogs_core()->timer.wheel = ogs_config()->parameter.timer_wheel;
+
     /**************************************************************************
      * Stage 4 : Setup LOG Module
      */
@@ -110,6 +114,11 @@ int ogs_app_initialize(const char *default_config, const char *const argv[])
             ogs_config()->logger.domain, ogs_config()->logger.level);
     if (rv != OGS_OK) return rv;
 
+    if (ogs_config()->logger.async) {
+        if (ogs_log_async_start() != OGS_OK)
+            ogs_warn("asynchronous logging is not available");
+    }
+
     /**************************************************************************
      * Stage 5 : Setup Database Module
      */
@@ -123,6 +132,7 @@ void ogs_app_terminate(void)
 {
     ogs_config_final();
 
+    ogs_log_async_stop();
     ogs_pkbuf_default_destroy();
 
     ogs_core_terminate();
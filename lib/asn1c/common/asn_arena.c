@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "asn_arena.h"
+
+/* First chunk and arena together fit a 2048-byte cluster of ogs_malloc() */
+#define ARENA_CHUNK_SIZE 1984
+
+#define ARENA_ALIGN(__sIZE) (((__sIZE) + 7) & ~((size_t)7))
+
+typedef struct arena_chunk_s {
+    struct arena_chunk_s *next;
+    uint8_t *pos;
+    uint8_t *end;
+} arena_chunk_t;
+
+struct ogs_asn_arena_s {
+    arena_chunk_t *chunk;       /* carved from; older chunks follow */
+    ogs_asn_arena_t *prev;      /* current arena before entering */
+    arena_chunk_t first;
+};
+
+/*
+ * Precedes every block. The tag sits where ogs_malloc() keeps its pkbuf
+ * pointer, with bit 0 set so that FREEMEM() can tell the two apart.
+ */
+typedef struct arena_block_s {
+    size_t size;
+    uintptr_t tag;
+} arena_block_t;
+
+static __thread ogs_asn_arena_t *current;
+
+ogs_asn_arena_t *ogs_asn_arena_create(void)
+{
+    ogs_asn_arena_t *arena = NULL;
+
+    arena = ogs_malloc(sizeof(*arena) + ARENA_CHUNK_SIZE);
+    ogs_assert(arena);
+
+    arena->first.next = NULL;
+    arena->first.pos = (uint8_t *)(arena + 1);
+    arena->first.end = arena->first.pos + ARENA_CHUNK_SIZE;
+    arena->chunk = &arena->first;
+    arena->prev = NULL;
+
+    return arena;
+}
+
+void ogs_asn_arena_destroy(ogs_asn_arena_t *arena)
+{
+    arena_chunk_t *chunk = NULL, *next = NULL;
+
+    ogs_assert(arena);
+    ogs_assert(arena != current);
+
+    for (chunk = arena->chunk; chunk != &arena->first; chunk = next) {
+        next = chunk->next;
+        ogs_free(chunk);
+    }
+
+    ogs_free(arena);
+}
+
+void ogs_asn_arena_enter(ogs_asn_arena_t *arena)
+{
+    ogs_assert(arena);
+
+    arena->prev = current;
+    current = arena;
+}
+
+void ogs_asn_arena_leave(ogs_asn_arena_t *arena)
+{
+    ogs_assert(arena);
+    ogs_assert(arena == current);
+
+    current = arena->prev;
+    arena->prev = NULL;
+}
+
+ogs_asn_arena_t *ogs_asn_arena_current(void)
+{
+    return current;
+}
+
+static arena_block_t *arena_block(const void *ptr)
+{
+    return (arena_block_t *)ptr - 1;
+}
+
+ogs_asn_arena_t *ogs_asn_arena_find(const void *ptr)
+{
+    uintptr_t tag;
+
+    if (!ptr)
+        return NULL;
+
+    tag = arena_block(ptr)->tag;
+    if (!(tag & 1))
+        return NULL;
+
+    return (ogs_asn_arena_t *)(tag & ~(uintptr_t)1);
+}
+
+static void *arena_alloc(ogs_asn_arena_t *arena, size_t size)
+{
+    arena_chunk_t *chunk = arena->chunk;
+    arena_block_t *block = NULL;
+    size_t need = sizeof(*block) + ARENA_ALIGN(size);
+
+    if ((size_t)(chunk->end - chunk->pos) < need) {
+        size_t chunk_size = ogs_max(need, ARENA_CHUNK_SIZE);
+
+        chunk = ogs_malloc(sizeof(*chunk) + chunk_size);
+        ogs_assert(chunk);
+        chunk->pos = (uint8_t *)(chunk + 1);
+        chunk->end = chunk->pos + chunk_size;
+
+        /* Oversized blocks get their own chunk behind the current one */
+        if (need > ARENA_CHUNK_SIZE && arena->chunk != &arena->first) {
+            chunk->next = arena->chunk->next;
+            arena->chunk->next = chunk;
+        } else {
+            chunk->next = arena->chunk;
+            arena->chunk = chunk;
+        }
+    }
+
+    block = (arena_block_t *)chunk->pos;
+    block->size = size;
+    block->tag = (uintptr_t)arena | 1;
+    chunk->pos += need;
+
+    return block + 1;
+}
+
+void *ogs_asn_malloc(size_t size)
+{
+    if (current)
+        return arena_alloc(current, size);
+
+    return ogs_malloc(size);
+}
+
+void *ogs_asn_calloc(size_t nmemb, size_t size)
+{
+    void *ptr = NULL;
+
+    if (!current)
+        return ogs_calloc(nmemb, size);
+
+    ptr = arena_alloc(current, nmemb * size);
+    memset(ptr, 0, nmemb * size);
+
+    return ptr;
+}
+
+void *ogs_asn_realloc(void *ptr, size_t size)
+{
+    ogs_asn_arena_t *arena = NULL;
+    arena_block_t *block = NULL;
+    arena_chunk_t *chunk = NULL;
+    void *new = NULL;
+
+    if (!ptr)
+        return ogs_asn_malloc(size);
+
+    arena = ogs_asn_arena_find(ptr);
+    if (!arena)
+        return ogs_realloc(ptr, size);
+
+    if (!size)
+        return NULL;
+
+    block = arena_block(ptr);
+    chunk = arena->chunk;
+
+    /* SEQUENCE OF arrays grow one element at a time; extend in place */
+    if ((uint8_t *)ptr + ARENA_ALIGN(block->size) == chunk->pos &&
+        (size_t)(chunk->end - (uint8_t *)ptr) >= ARENA_ALIGN(size)) {
+        chunk->pos = (uint8_t *)ptr + ARENA_ALIGN(size);
+        block->size = size;
+        return ptr;
+    }
+
+    new = arena_alloc(arena, size);
+    memcpy(new, ptr, ogs_min(block->size, size));
+
+    return new;
+}
+
+void ogs_asn_free(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    /* Arena blocks are released with the arena itself */
+    if (ogs_asn_arena_find(ptr))
+        return;
+
+    ogs_free(ptr);
+}
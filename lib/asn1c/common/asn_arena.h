@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASN_ARENA_H
+#define ASN_ARENA_H
+
+#include "ogs-core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Bump allocator behind CALLOC()/MALLOC()/REALLOC()/FREEMEM().
+ *
+ * While an arena is entered on the calling thread, the asn1c allocations
+ * are carved out of it and FREEMEM() of such a block does nothing; the
+ * memory goes back in one piece with ogs_asn_arena_destroy().
+ * Without an arena, the macros fall back to ogs_malloc()/ogs_free().
+ */
+typedef struct ogs_asn_arena_s ogs_asn_arena_t;
+
+ogs_asn_arena_t *ogs_asn_arena_create(void);
+void ogs_asn_arena_destroy(ogs_asn_arena_t *arena);
+
+void ogs_asn_arena_enter(ogs_asn_arena_t *arena);
+void ogs_asn_arena_leave(ogs_asn_arena_t *arena);
+ogs_asn_arena_t *ogs_asn_arena_current(void);
+
+ogs_asn_arena_t *ogs_asn_arena_find(const void *ptr);
+
+void *ogs_asn_malloc(size_t size);
+void *ogs_asn_calloc(size_t nmemb, size_t size);
+void *ogs_asn_realloc(void *ptr, size_t size);
+void ogs_asn_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASN_ARENA_H */
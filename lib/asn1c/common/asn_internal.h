@@ -29,11 +29,11 @@ int get_asn1c_environment_version(void);	/* Run-time version */
 #define	REALLOC(oldptr, size)	realloc(oldptr, size)
 #define	FREEMEM(ptr)		free(ptr)
 #else
-#include "ogs-core.h"
-#define	CALLOC(nmemb, size)	ogs_calloc(nmemb, size)
-#define	MALLOC(size)		ogs_malloc(size)
-#define	REALLOC(oldptr, size)	ogs_realloc(oldptr, size)
-#define	FREEMEM(ptr)		ogs_free(ptr)
+#include "asn_arena.h"
+#define	CALLOC(nmemb, size)	ogs_asn_calloc(nmemb, size)
+#define	MALLOC(size)		ogs_asn_malloc(size)
+#define	REALLOC(oldptr, size)	ogs_asn_realloc(oldptr, size)
+#define	FREEMEM(ptr)		ogs_asn_free(ptr)
 #endif
 
 #define	asn_debug_indent	0
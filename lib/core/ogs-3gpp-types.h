@@ -99,6 +99,7 @@ typedef struct ogs_e_cgi_s {
 #define OGS_IPV4_LEN                4
 #define OGS_IPV6_LEN                16
 #define OGS_IPV4V6_LEN              20
+#define OGS_IPV6_DEFAULT_PREFIX_LEN 64
 typedef struct ogs_ip_s {
     union {
         uint32_t addr;
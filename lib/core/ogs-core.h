@@ -90,6 +90,7 @@ typedef struct {
 
     struct {
         int pool;
+        int wheel;      /* 1: Timing wheel, 0: Red-black tree */
     } timer;
 
     struct {
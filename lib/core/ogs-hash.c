@@ -40,16 +40,32 @@ struct ogs_hash_t {
     unsigned int        count, max, seed;
     ogs_hashfunc_t      hash_func;
     ogs_hash_entry_t    *free;  /* List of recycled entries */
+
+    /*
+     * While growing, buckets below rehash_index have been moved from
+     * old_array to array, a few more on every insertion.
+     */
+    ogs_hash_entry_t    **old_array;
+    unsigned int        old_max, rehash_index;
 };
 
 #define INITIAL_MAX 15 /* tunable == 2^n - 1 */
+#define REHASH_STEP 64 /* buckets moved per insertion while growing */
 
+/* Not ogs_calloc(); large tables outgrow the biggest pkbuf cluster */
 static ogs_hash_entry_t **alloc_array(ogs_hash_t *ht, unsigned int max)
 {
-   return ogs_calloc(1, sizeof(*ht->array) * (max + 1));
+    ogs_hash_entry_t **array = calloc(max + 1, sizeof(*ht->array));
+    ogs_assert(array);
+    return array;
 }
 
 ogs_hash_t *ogs_hash_make()
+{
+    return ogs_hash_make_size(0);
+}
+
+ogs_hash_t *ogs_hash_make_size(unsigned int size)
 {
     ogs_hash_t *ht;
     ogs_time_t now = ogs_get_monotonic_time();
@@ -59,11 +75,17 @@ ogs_hash_t *ogs_hash_make()
     ht->free = NULL;
     ht->count = 0;
     ht->max = INITIAL_MAX;
+    while (ht->max < size)
+        ht->max = ht->max * 2 + 1;
     ht->seed = (unsigned int)((now >> 32) ^ now ^ 
                               (uintptr_t)ht ^ (uintptr_t)&now) - 1;
     ht->array = alloc_array(ht, ht->max);
     ht->hash_func = NULL;
 
+    ht->old_array = NULL;
+    ht->old_max = 0;
+    ht->rehash_index = 0;
+
     return ht;
 }
 
@@ -91,18 +113,33 @@ void ogs_hash_destroy(ogs_hash_t *ht)
         he = next_he;
     }
 
-    ogs_free(ht->array);
+    free(ht->old_array);
+    free(ht->array);
     ogs_free(ht);
 }
 
 ogs_hash_index_t *ogs_hash_next(ogs_hash_index_t *hi)
 {
+    ogs_hash_t *ht = hi->ht;
+    unsigned int index;
+
     hi->this = hi->next;
     while (!hi->this) {
-        if (hi->index > hi->ht->max)
+        /* Buckets of old_array first, then those of array */
+        index = hi->index;
+        if (ht->old_array) {
+            if (index <= ht->old_max) {
+                hi->this = ht->old_array[hi->index++];
+                continue;
+            }
+            index -= ht->old_max + 1;
+        }
+
+        if (index > ht->max)
             return NULL;
 
-        hi->this = hi->ht->array[hi->index++];
+        hi->this = ht->array[index];
+        hi->index++;
     }
     hi->next = hi->this->next;
     return hi;
@@ -153,82 +190,108 @@ void *ogs_hash_this_val(ogs_hash_index_t *hi)
     return val;
 }
 
-static void expand_array(ogs_hash_t *ht)
+static void rehash_step(ogs_hash_t *ht, unsigned int n)
 {
-    ogs_hash_index_t *hi;
-    ogs_hash_entry_t **new_array;
-    unsigned int new_max;
-
-    new_max = ht->max * 2 + 1;
-    new_array = alloc_array(ht, new_max);
-    for (hi = ogs_hash_first(ht); hi; hi = ogs_hash_next(hi)) {
-        unsigned int i = hi->this->hash & new_max;
-        hi->this->next = new_array[i];
-        new_array[i] = hi->this;
+    ogs_hash_entry_t *he, *next;
+    unsigned int i;
+
+    while (n-- && ht->rehash_index <= ht->old_max) {
+        for (he = ht->old_array[ht->rehash_index]; he; he = next) {
+            next = he->next;
+            i = he->hash & ht->max;
+            he->next = ht->array[i];
+            ht->array[i] = he;
+        }
+        ht->old_array[ht->rehash_index++] = NULL;
+    }
+
+    if (ht->rehash_index > ht->old_max) {
+        free(ht->old_array);
+        ht->old_array = NULL;
     }
-    ogs_free(ht->array);
-    ht->array = new_array;
-    ht->max = new_max;
+}
+
+static void expand_array(ogs_hash_t *ht)
+{
+    /* Cannot happen with REHASH_STEP > 1, but never keep three arrays */
+    if (ht->old_array)
+        rehash_step(ht, ht->old_max + 1);
+
+    ht->old_array = ht->array;
+    ht->old_max = ht->max;
+    ht->rehash_index = 0;
+
+    ht->max = ht->max * 2 + 1;
+    ht->array = alloc_array(ht, ht->max);
+}
+
+/* Called after each insertion; replacing or deleting moves nothing */
+static void grow_array(ogs_hash_t *ht)
+{
+    if (ht->old_array)
+        rehash_step(ht, REHASH_STEP);
+    else if (ht->count > ht->max)
+        expand_array(ht);
+}
+
+static ogs_inline uint32_t rotl32(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
 }
 
 static unsigned int hashfunc_default(
         const char *char_key, int *klen, unsigned int hash)
 {
-    const unsigned char *key = (const unsigned char *)char_key;
-    const unsigned char *p;
-    int i;
-    
     /*
-     * This is the popular `times 33' hash algorithm which is used by
-     * perl and also appears in Berkeley DB. This is one of the best
-     * known hash functions for strings because it is both computed
-     * very fast and distributes very well.
-     *
-     * The originator may be Dan Bernstein but the code in Berkeley DB
-     * cites Chris Torek as the source. The best citation I have found
-     * is "Chris Torek, Hash function for text in C, Usenet message
-     * <27038@mimsy.umd.edu> in comp.lang.c , October, 1990." in Rich
-     * Salz's USENIX 1992 paper about INN which can be found at
-     * <http://citeseer.nj.nec.com/salz92internetnews.html>.
-     *
-     * The magic of number 33, i.e. why it works better than many other
-     * constants, prime or not, has never been adequately explained by
-     * anyone. So I try an explanation: if one experimentally tests all
-     * multipliers between 1 and 256 (as I did while writing a low-level
-     * data structure library some time ago) one detects that even
-     * numbers are not useable at all. The remaining 128 odd numbers
-     * (except for the number 1) work more or less all equally well.
-     * They all distribute in an acceptable way and this way fill a hash
-     * table with an average percent of approx. 86%.
-     *
-     * If one compares the chi^2 values of the variants (see
-     * Bob Jenkins ``Hashing Frequently Asked Questions'' at
-     * http://burtleburtle.net/bob/hash/hashfaq.html for a description
-     * of chi^2), the number 33 not even has the best value. But the
-     * number 33 and a few other equally good numbers like 17, 31, 63,
-     * 127 and 129 have nevertheless a great advantage to the remaining
-     * numbers in the large set of possible multipliers: their multiply
-     * operation can be replaced by a faster operation based on just one
-     * shift plus either a single addition or subtraction operation. And
-     * because a hash function has to both distribute good _and_ has to
-     * be very fast to compute, those few numbers should be preferred.
-     *
-     *                  -- Ralf S. Engelschall <rse@engelschall.com>
+     * MurmurHash3 (x86_32) by Austin Appleby, placed in the public domain.
+     * Four bytes per round and a proper finalizer; IMSI and GUTI keys,
+     * which differ in a few trailing digits, spread over all buckets.
      */
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    const unsigned char *key = (const unsigned char *)char_key;
+    const unsigned char *tail;
+    uint32_t h = hash, k;
+    int i, len;
 
-    if (*klen == OGS_HASH_KEY_STRING) {
-        for (p = key; *p; p++) {
-            hash = hash * 33 + *p;
-        }
-        *klen = p - key;
+    if (*klen == OGS_HASH_KEY_STRING)
+        *klen = strlen(char_key);
+    len = *klen;
+
+    for (i = 0; i + 4 <= len; i += 4) {
+        memcpy(&k, key + i, 4);
+
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+
+        h ^= k;
+        h = rotl32(h, 13);
+        h = h * 5 + 0xe6546b64;
     }
-    else {
-        for (p = key, i = *klen; i; i--, p++) {
-            hash = hash * 33 + *p;
-        }
+
+    tail = key + i;
+    k = 0;
+    if ((len & 3) == 3)
+        k ^= tail[2] << 16;
+    if ((len & 3) >= 2)
+        k ^= tail[1] << 8;
+    if ((len & 3) >= 1) {
+        k ^= tail[0];
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+        h ^= k;
     }
 
-    return hash;
+    h ^= len;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    return h;
 }
 
 unsigned int ogs_hashfunc_default(const char *char_key, int *klen)
@@ -247,6 +310,17 @@ static ogs_hash_entry_t **find_entry(ogs_hash_t *ht,
     else
         hash = hashfunc_default(key, &klen, ht->seed);
 
+    /* not moved yet */
+    if (ht->old_array) {
+        for (hep = &ht->old_array[hash & ht->old_max], he = *hep;
+             he; hep = &he->next, he = *hep) {
+            if (he->hash == hash
+                && he->klen == klen
+                && memcmp(he->key, key, klen) == 0)
+                return hep;
+        }
+    }
+
     /* scan linked list */
     for (hep = &ht->array[hash & ht->max], he = *hep;
          he; hep = &he->next, he = *hep) {
@@ -286,6 +360,7 @@ void *ogs_hash_get(ogs_hash_t *ht, const void *key, int klen)
 void ogs_hash_set(ogs_hash_t *ht, const void *key, int klen, const void *val)
 {
     ogs_hash_entry_t **hep;
+    unsigned int count = ht->count;
     hep = find_entry(ht, key, klen, val);
     if (*hep) {
         if (!val) {
@@ -299,9 +374,8 @@ void ogs_hash_set(ogs_hash_t *ht, const void *key, int klen, const void *val)
             /* replace entry */
             (*hep)->val = val;
             /* check that the collision rate isn't too high */
-            if (ht->count > ht->max) {
-                expand_array(ht);
-            }
+            if (ht->count > count)
+                grow_array(ht);
         }
     }
     /* else key not present and val==NULL */
@@ -311,13 +385,13 @@ void *ogs_hash_get_or_set(ogs_hash_t *ht,
         const void *key, int klen, const void *val)
 {
     ogs_hash_entry_t **hep;
+    unsigned int count = ht->count;
     hep = find_entry(ht, key, klen, val);
     if (*hep) {
         val = (*hep)->val;
         /* check that the collision rate isn't too high */
-        if (ht->count > ht->max) {
-            expand_array(ht);
-        }
+        if (ht->count > count)
+            grow_array(ht);
         return (void *)val;
     }
     /* else key not present and val==NULL */
@@ -36,6 +36,8 @@ typedef unsigned int (*ogs_hashfunc_t)(const char *key, int *klen);
 unsigned int ogs_hashfunc_default(const char *key, int *klen);
 
 ogs_hash_t *ogs_hash_make(void);
+/* Buckets for size entries up front, so that the table never grows */
+ogs_hash_t *ogs_hash_make_size(unsigned int size);
 ogs_hash_t *ogs_hash_make_custom(ogs_hashfunc_t ogs_hash_func);
 void ogs_hash_destroy(ogs_hash_t *ht);
 
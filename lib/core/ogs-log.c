@@ -27,6 +27,10 @@
 #include <stdarg.h>
 #endif
 
+#if HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
 #include "ogs-core.h"
 
 #define TA_NOR              "\033[0m"       /* all off */
@@ -95,6 +99,50 @@ static OGS_LIST(log_list);
 static OGS_POOL(domain_pool, ogs_log_domain_t);
 static OGS_LIST(domain_list);
 
+uint8_t *__ogs_log_level = NULL;
+
+/* Per producer thread; must be a power of 2 above OGS_HUGE_LEN */
+#define LOG_RING_SIZE       (64 * 1024)
+#define LOG_RECORD_ALIGN(__sIZE) (((__sIZE) + 15) & ~((size_t)15))
+#define LOG_IOV_MAX         64
+#define LOG_ASYNC_INTERVAL  ogs_time_from_msec(10)
+
+typedef struct log_record_s {
+    ogs_log_t *log;             /* NULL pads the ring up to its end */
+    uint32_t len;
+} log_record_t;
+
+/*
+ * Single producer, single consumer. The owner thread advances head,
+ * the writer thread advances tail; both run freely and wrap.
+ */
+typedef struct log_ring_s {
+    ogs_lnode_t node;
+
+    uint32_t head;
+    uint32_t tail;
+
+    uint32_t dropped;           /* bumped by the owner on overflow */
+    uint32_t reported;          /* already written out by the writer */
+
+    uint8_t buf[LOG_RING_SIZE];
+} log_ring_t;
+
+static struct {
+    bool enabled;
+    bool running;
+
+    ogs_thread_t *thread;
+    ogs_thread_mutex_t mutex;
+    ogs_thread_cond_t cond;
+
+    ogs_list_t ring_list;
+    uint32_t generation;        /* bumped by each start */
+} async;
+
+static __thread log_ring_t *ring_self;
+static __thread uint32_t ring_generation;
+
 static ogs_log_t *add_log(ogs_log_type_e type);
 static int file_cycle(ogs_log_t *log);
 
@@ -110,6 +158,11 @@ static char *log_linefeed(char *buf, char *last);
 
 static void file_writer(
         ogs_log_t *log, ogs_log_level_e level, const char *string);
+static void async_push(ogs_log_t *log, const char *string, size_t len);
+static void async_drain(void);
+#if HAVE_SYS_UIO_H
+static void async_main(void *data);
+#endif
 
 void ogs_log_init(void)
 {
@@ -119,6 +172,11 @@ void ogs_log_init(void)
     ogs_pool_init(&domain_pool, ogs_core()->log.domain_pool);
     ogs_list_init(&domain_list);
 
+    /* Unknown ids fall through to ogs_log_printf() */
+    __ogs_log_level = malloc(ogs_core()->log.domain_pool + 1);
+    ogs_assert(__ogs_log_level);
+    memset(__ogs_log_level, OGS_LOG_FULL, ogs_core()->log.domain_pool + 1);
+
     ogs_log_add_domain("core", ogs_core()->log.level);
     ogs_log_add_stderr();
 }
@@ -128,6 +186,9 @@ void ogs_log_final(void)
     ogs_log_t *log, *saved_log;
     ogs_log_domain_t *domain, *saved_domain;
 
+    /* Stopped before the pkbuf pool that ogs_thread_destroy() frees to */
+    ogs_assert(!async.enabled);
+
     ogs_list_for_each_safe(&log_list, saved_log, log)
         ogs_log_remove(log);
     ogs_pool_final(&log_pool);
@@ -135,6 +196,9 @@ void ogs_log_final(void)
     ogs_list_for_each_safe(&domain_list, saved_domain, domain)
         ogs_log_remove_domain(domain);
     ogs_pool_final(&domain_pool);
+
+    free(__ogs_log_level);
+    __ogs_log_level = NULL;
 }
 
 void ogs_log_cycle(void)
@@ -151,6 +215,66 @@ void ogs_log_cycle(void)
     }
 }
 
+int ogs_log_async_start(void)
+{
+#if HAVE_SYS_UIO_H
+    if (async.enabled)
+        return OGS_OK;
+
+    ogs_thread_mutex_init(&async.mutex);
+    ogs_thread_cond_init(&async.cond);
+    ogs_list_init(&async.ring_list);
+
+    async.generation++;
+    async.running = true;
+    async.thread = ogs_thread_create(async_main, NULL);
+    ogs_assert(async.thread);
+
+    async.enabled = true;
+
+    return OGS_OK;
+#else
+    return OGS_ERROR;
+#endif
+}
+
+void ogs_log_async_stop(void)
+{
+    log_ring_t *ring = NULL, *saved_ring = NULL;
+
+    if (!async.enabled)
+        return;
+
+    async.enabled = false;
+
+    ogs_thread_mutex_lock(&async.mutex);
+    async.running = false;
+    ogs_thread_cond_signal(&async.cond);
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    ogs_thread_destroy(async.thread);
+    async.thread = NULL;
+
+    /* Threads still holding a ring get a new one after the next start */
+    ogs_list_for_each_safe(&async.ring_list, saved_ring, ring) {
+        ogs_list_remove(&async.ring_list, ring);
+        free(ring);
+    }
+
+    ogs_thread_cond_destroy(&async.cond);
+    ogs_thread_mutex_destroy(&async.mutex);
+}
+
+void ogs_log_async_flush(void)
+{
+    if (!async.enabled)
+        return;
+
+    ogs_thread_mutex_lock(&async.mutex);
+    async_drain();
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+
 ogs_log_t *ogs_log_add_stderr(void)
 {
     ogs_log_t *log = NULL;
@@ -192,7 +316,14 @@ void ogs_log_remove(ogs_log_t *log)
 {
     ogs_assert(log);
 
-    ogs_list_remove(&log_list, log);
+    if (async.enabled) {
+        ogs_thread_mutex_lock(&async.mutex);
+        async_drain();
+        ogs_list_remove(&log_list, log);
+        ogs_thread_mutex_unlock(&async.mutex);
+    } else {
+        ogs_list_remove(&log_list, log);
+    }
 
     if (log->type == OGS_LOG_FILE_TYPE) {
         ogs_assert(log->file.out);
@@ -203,6 +334,12 @@ void ogs_log_remove(ogs_log_t *log)
     ogs_pool_free(&log_pool, log);
 }
 
+static void set_domain_level(ogs_log_domain_t *domain, ogs_log_level_e level)
+{
+    domain->level = level;
+    __ogs_log_level[domain->id] = level;
+}
+
 ogs_log_domain_t *ogs_log_add_domain(const char *name, ogs_log_level_e level)
 {
     ogs_log_domain_t *domain = NULL;
@@ -214,7 +351,7 @@ ogs_log_domain_t *ogs_log_add_domain(const char *name, ogs_log_level_e level)
 
     domain->name = name;
     domain->id = ogs_pool_index(&domain_pool, domain);
-    domain->level = level;
+    set_domain_level(domain, level);
 
     ogs_list_add(&domain_list, domain);
 
@@ -238,6 +375,8 @@ void ogs_log_remove_domain(ogs_log_domain_t *domain)
 {
     ogs_assert(domain);
 
+    __ogs_log_level[domain->id] = OGS_LOG_FULL;
+
     ogs_list_remove(&domain_list, domain);
     ogs_pool_free(&domain_pool, domain);
 }
@@ -251,7 +390,7 @@ void ogs_log_set_domain_level(int id, ogs_log_level_e level)
     domain = ogs_pool_find(&domain_pool, id);
     ogs_assert(domain);
 
-    domain->level = level;
+    set_domain_level(domain, level);
 }
 
 ogs_log_level_e ogs_log_get_domain_level(int id)
@@ -333,13 +472,13 @@ void ogs_log_set_mask_level(const char *_mask, ogs_log_level_e level)
 
             domain = ogs_log_find_domain(name);
             if (domain)
-                domain->level = level;
+                set_domain_level(domain, level);
         }
 
         ogs_free(mask);
     } else {
         ogs_list_for_each(&domain_list, domain)
-            domain->level = level;
+            set_domain_level(domain, level);
     }
 }
 
@@ -426,8 +565,13 @@ void ogs_log_vprintf(ogs_log_level_e level, int id,
                 p = log_linefeed(p, last);
         }
 
-        log->writer(log, level, logstr);
-        
+        if (async.enabled && level > OGS_LOG_FATAL) {
+            async_push(log, logstr, p - logstr);
+        } else {
+            ogs_log_async_flush();
+            log->writer(log, level, logstr);
+        }
+
         if (log->type == OGS_LOG_STDERR_TYPE)
             wrote_stderr = 1;
     }
@@ -470,6 +614,39 @@ void ogs_log_printf(ogs_log_level_e level, int id,
     va_end(args);
 }
 
+int ogs_log_ratelimit(ogs_log_ratelimit_t *ratelimit,
+    ogs_log_level_e level, int domain_id,
+    const char *file, int line, const char *func)
+{
+    ogs_time_t now;
+    int suppressed;
+
+    ogs_assert(ratelimit);
+
+    /* Racy across threads; an off-by-a-few count is fine here */
+    now = ogs_get_monotonic_time();
+    if (!ratelimit->begin ||
+        now - ratelimit->begin >= OGS_LOG_RATELIMIT_INTERVAL) {
+        suppressed = ratelimit->suppressed;
+
+        ratelimit->begin = now;
+        ratelimit->count = 0;
+        ratelimit->suppressed = 0;
+
+        if (suppressed)
+            ogs_log_printf(level, domain_id, 0, file, line, func, 0,
+                    "%d messages suppressed", suppressed);
+    }
+
+    if (ratelimit->count < OGS_LOG_RATELIMIT_BURST) {
+        ratelimit->count++;
+        return 1;
+    }
+
+    ratelimit->suppressed++;
+    return 0;
+}
+
 void ogs_log_hexdump_func(ogs_log_level_e level, int id,
         const unsigned char *data, size_t len)
 {
@@ -519,7 +696,13 @@ static ogs_log_t *add_log(ogs_log_type_e type)
     log->print.fileline = 1;
     log->print.linefeed = 1;
 
-    ogs_list_add(&log_list, log);
+    if (async.enabled) {
+        ogs_thread_mutex_lock(&async.mutex);
+        ogs_list_add(&log_list, log);
+        ogs_thread_mutex_unlock(&async.mutex);
+    } else {
+        ogs_list_add(&log_list, log);
+    }
 
     return log;
 }
@@ -530,10 +713,16 @@ static int file_cycle(ogs_log_t *log)
     ogs_assert(log->file.out);
     ogs_assert(log->file.name);
 
+    if (async.enabled)
+        ogs_thread_mutex_lock(&async.mutex);
+
     fclose(log->file.out);
     log->file.out = fopen(log->file.name, "a");
     ogs_assert(log->file.out);
 
+    if (async.enabled)
+        ogs_thread_mutex_unlock(&async.mutex);
+
     return 0;
 }
 
@@ -623,3 +812,192 @@ static void file_writer(
     fflush(log->file.out);
 }
 
+
+#if HAVE_SYS_UIO_H
+static log_ring_t *ring_create(void)
+{
+    log_ring_t *ring = NULL;
+
+    /* Not ogs_malloc(); the pkbuf pool may log */
+    ring = malloc(sizeof *ring);
+    ogs_assert(ring);
+    memset(ring, 0, offsetof(log_ring_t, buf));
+
+    ogs_thread_mutex_lock(&async.mutex);
+    ogs_list_add(&async.ring_list, ring);
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    return ring;
+}
+
+static void async_push(ogs_log_t *log, const char *string, size_t len)
+{
+    log_ring_t *ring = NULL;
+    log_record_t *record = NULL;
+    uint32_t head, tail, offset;
+    size_t need, pad = 0;
+
+    if (!ring_self || ring_generation != async.generation) {
+        ring_self = ring_create();
+        ring_generation = async.generation;
+    }
+    ring = ring_self;
+
+    head = ring->head;
+    tail = ogs_atomic_load(&ring->tail);
+
+    need = LOG_RECORD_ALIGN(sizeof(*record) + len);
+    offset = head & (LOG_RING_SIZE - 1);
+    if (offset + need > LOG_RING_SIZE)
+        pad = LOG_RING_SIZE - offset;
+
+    if (need + pad > LOG_RING_SIZE - (head - tail)) {
+        ogs_atomic_inc(&ring->dropped);
+        return;
+    }
+
+    if (pad) {
+        record = (log_record_t *)(ring->buf + offset);
+        record->log = NULL;
+        record->len = pad - sizeof(*record);
+        head += pad;
+        offset = 0;
+    }
+
+    record = (log_record_t *)(ring->buf + offset);
+    record->log = log;
+    record->len = len;
+    memcpy(record + 1, string, len);
+
+    head += need;
+    ogs_atomic_store(&ring->head, head);
+
+    /* Otherwise the writer picks it up on its next tick */
+    if (head - tail > LOG_RING_SIZE / 2)
+        ogs_thread_cond_signal(&async.cond);
+}
+
+static void log_writev(ogs_log_t *log, struct iovec *iov, int iovcnt)
+{
+    ssize_t n;
+    int fd = fileno(log->file.out);
+
+    while (iovcnt) {
+        n = writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        while (iovcnt && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt) {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+static void ring_report_dropped(log_ring_t *ring)
+{
+    ogs_log_t *log = NULL;
+    uint32_t dropped = ogs_atomic_load(&ring->dropped);
+    char logstr[OGS_HUGE_LEN];
+    char *p, *last;
+    struct iovec iov;
+
+    if (dropped == ring->reported)
+        return;
+
+    ogs_list_for_each(&log_list, log) {
+        p = logstr;
+        last = logstr + OGS_HUGE_LEN;
+
+        if (log->print.timestamp)
+            p = log_timestamp(p, last, log->print.color);
+        if (log->print.level)
+            p = log_level(p, last, OGS_LOG_WARN, log->print.color);
+        p = ogs_slprintf(p, last, "%u log records dropped",
+                dropped - ring->reported);
+        p = log_linefeed(p, last);
+
+        iov.iov_base = logstr;
+        iov.iov_len = p - logstr;
+        log_writev(log, &iov, 1);
+    }
+
+    ring->reported = dropped;
+}
+
+/* Batches the records of each log into writev(); called with the mutex */
+static void ring_drain(log_ring_t *ring)
+{
+    ogs_log_t *log = NULL;
+    log_record_t *record = NULL;
+    struct iovec iov[LOG_IOV_MAX];
+    uint32_t head, tail, pos;
+    int iovcnt;
+
+    head = ogs_atomic_load(&ring->head);
+    tail = ring->tail;
+
+    if (head != tail) {
+        ogs_list_for_each(&log_list, log) {
+            iovcnt = 0;
+            for (pos = tail; pos != head;
+                    pos += LOG_RECORD_ALIGN(sizeof(*record) + record->len)) {
+                record = (log_record_t *)
+                    (ring->buf + (pos & (LOG_RING_SIZE - 1)));
+                if (record->log != log)
+                    continue;
+
+                iov[iovcnt].iov_base = record + 1;
+                iov[iovcnt].iov_len = record->len;
+                if (++iovcnt == LOG_IOV_MAX) {
+                    log_writev(log, iov, iovcnt);
+                    iovcnt = 0;
+                }
+            }
+            if (iovcnt)
+                log_writev(log, iov, iovcnt);
+        }
+
+        ogs_atomic_store(&ring->tail, head);
+    }
+
+    ring_report_dropped(ring);
+}
+
+static void async_drain(void)
+{
+    log_ring_t *ring = NULL;
+
+    ogs_list_for_each(&async.ring_list, ring)
+        ring_drain(ring);
+}
+
+static void async_main(void *data)
+{
+    ogs_thread_mutex_lock(&async.mutex);
+    while (async.running) {
+        async_drain();
+        ogs_thread_cond_timedwait(
+                &async.cond, &async.mutex, LOG_ASYNC_INTERVAL);
+    }
+    async_drain();
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+#else
+static void async_push(ogs_log_t *log, const char *string, size_t len)
+{
+    log->writer(log, OGS_LOG_NONE, string);
+}
+
+static void async_drain(void)
+{
+}
+#endif
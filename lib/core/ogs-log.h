@@ -32,6 +32,14 @@ extern "C" {
 #define OGS_LOG_DOMAIN      1
 #endif
 
+/*
+ * Messages above OGS_LOG_COMPILE_LEVEL are compiled out, e.g.
+ * -DOGS_LOG_COMPILE_LEVEL=OGS_LOG_INFO drops ogs_debug() and ogs_trace().
+ */
+#ifndef OGS_LOG_COMPILE_LEVEL
+#define OGS_LOG_COMPILE_LEVEL OGS_LOG_FULL
+#endif
+
 #define ogs_fatal(...) ogs_log_message(OGS_LOG_FATAL, 0, __VA_ARGS__)
 #define ogs_error(...) ogs_log_message(OGS_LOG_ERROR, 0, __VA_ARGS__)
 #define ogs_warn(...) ogs_log_message(OGS_LOG_WARN, 0, __VA_ARGS__)
@@ -39,18 +47,49 @@ extern "C" {
 #define ogs_debug(...) ogs_log_message(OGS_LOG_DEBUG, 0, __VA_ARGS__)
 #define ogs_trace(...) ogs_log_message(OGS_LOG_TRACE, 0, __VA_ARGS__)
 
+/* Arguments are not evaluated unless the message will be logged */
+#define ogs_log_enabled(level, domain_id) \
+    ((level) <= OGS_LOG_COMPILE_LEVEL && \
+     (!__ogs_log_level || (level) <= __ogs_log_level[domain_id]))
+
 #define ogs_log_message(level, err, ...) \
+    (ogs_log_enabled(level, OGS_LOG_DOMAIN) ? \
     ogs_log_printf(level, OGS_LOG_DOMAIN, \
     err, __FILE__, __LINE__, OGS_FUNC,  \
-    0, __VA_ARGS__) 
+    0, __VA_ARGS__) : (void)0)
 
 #define ogs_log_print(level, ...) \
+    (ogs_log_enabled(level, OGS_LOG_DOMAIN) ? \
     ogs_log_printf(level, OGS_LOG_DOMAIN, \
     0, NULL, 0, NULL,  \
-    1, __VA_ARGS__) 
+    1, __VA_ARGS__) : (void)0)
 
 #define ogs_log_hexdump(level, _d, _l) \
-    ogs_log_hexdump_func(level, OGS_LOG_DOMAIN, _d, _l)
+    (ogs_log_enabled(level, OGS_LOG_DOMAIN) ? \
+    ogs_log_hexdump_func(level, OGS_LOG_DOMAIN, _d, _l) : (void)0)
+
+/*
+ * At most OGS_LOG_RATELIMIT_BURST messages per call site every
+ * OGS_LOG_RATELIMIT_INTERVAL; the rest are counted and reported
+ * with the first message of the next interval.
+ */
+#define OGS_LOG_RATELIMIT_INTERVAL ogs_time_from_sec(1)
+#define OGS_LOG_RATELIMIT_BURST 10
+
+#define ogs_log_ratelimited(level, ...) \
+    do { \
+        static ogs_log_ratelimit_t __ogs_ratelimit; \
+        if (ogs_log_enabled(level, OGS_LOG_DOMAIN) && \
+            ogs_log_ratelimit(&__ogs_ratelimit, level, OGS_LOG_DOMAIN, \
+                __FILE__, __LINE__, OGS_FUNC)) \
+            ogs_log_printf(level, OGS_LOG_DOMAIN, \
+                0, __FILE__, __LINE__, OGS_FUNC, 0, __VA_ARGS__); \
+    } while (0)
+
+#define ogs_error_ratelimited(...) \
+    ogs_log_ratelimited(OGS_LOG_ERROR, __VA_ARGS__)
+#define ogs_warn_ratelimited(...) \
+    ogs_log_ratelimited(OGS_LOG_WARN, __VA_ARGS__)
 
 typedef enum {
     OGS_LOG_NONE,
@@ -67,10 +106,27 @@ typedef enum {
 typedef struct ogs_log_s ogs_log_t;
 typedef struct ogs_log_domain_s ogs_log_domain_t;
 
+/* Level of each domain, indexed by domain id */
+extern uint8_t *__ogs_log_level;
+
+typedef struct ogs_log_ratelimit_s {
+    ogs_time_t begin;
+    int count;
+    int suppressed;
+} ogs_log_ratelimit_t;
+
 void ogs_log_init(void);
 void ogs_log_final(void);
 void ogs_log_cycle(void);
 
+/*
+ * Records are queued on a ring of the calling thread and written out
+ * by a writer thread; ogs_fatal() flushes the rings and writes in place.
+ */
+int ogs_log_async_start(void);
+void ogs_log_async_stop(void);
+void ogs_log_async_flush(void);
+
 ogs_log_t *ogs_log_add_stderr(void);
 ogs_log_t *ogs_log_add_file(const char *name);
 void ogs_log_remove(ogs_log_t *log);
@@ -99,6 +155,10 @@ void ogs_log_printf(ogs_log_level_e level, int domain_id,
     int content_only, const char *format, ...)
     OGS_GNUC_PRINTF(8, 9);
 
+int ogs_log_ratelimit(ogs_log_ratelimit_t *ratelimit,
+    ogs_log_level_e level, int domain_id,
+    const char *file, int line, const char *func);
+
 void ogs_log_hexdump_func(ogs_log_level_e level, int domain_id,
     const unsigned char *data, size_t len);
 
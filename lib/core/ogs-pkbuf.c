@@ -61,12 +61,37 @@ typedef struct ogs_pkbuf_pool_s {
     ogs_thread_mutex_t mutex;
 } ogs_pkbuf_pool_t;
 
+#define OGS_NUM_OF_CLUSTER_CLASS    7
+static const unsigned int cluster_size[OGS_NUM_OF_CLUSTER_CLASS] = {
+    OGS_CLUSTER_128_SIZE, OGS_CLUSTER_256_SIZE, OGS_CLUSTER_512_SIZE,
+    OGS_CLUSTER_1024_SIZE, OGS_CLUSTER_2048_SIZE, OGS_CLUSTER_8192_SIZE,
+    OGS_CLUSTER_BIG_SIZE,
+};
+
+#define OGS_PKBUF_CACHE_SIZE        64
+
+typedef struct ogs_pkbuf_cache_s {
+    ogs_pkbuf_pool_t *pool;
+
+    bool owned;
+    ogs_thread_self_t owner;
+
+    /* One for the cache itself and one per pkbuf handed out */
+    unsigned int ref;
+
+    /* Free pkbuf with its cluster attached, per cluster class */
+    int num[OGS_NUM_OF_CLUSTER_CLASS];
+    ogs_pkbuf_t *pkbuf[OGS_NUM_OF_CLUSTER_CLASS][OGS_PKBUF_CACHE_SIZE];
+} ogs_pkbuf_cache_t;
+
 static OGS_POOL(pkbuf_pool, ogs_pkbuf_pool_t);
 static ogs_pkbuf_pool_t *default_pool = NULL;
 
 static ogs_cluster_t *cluster_alloc(
         ogs_pkbuf_pool_t *pool, unsigned int size);
 static void cluster_free(ogs_pkbuf_pool_t *pool, ogs_cluster_t *cluster);
+static bool cache_put(ogs_pkbuf_cache_t *cache, ogs_pkbuf_t *pkbuf);
+static void cache_unref(ogs_pkbuf_cache_t *cache);
 
 void *ogs_pkbuf_put_data(
         ogs_pkbuf_t *pkbuf, const void *data, unsigned int len)
@@ -101,6 +126,24 @@ void ogs_pkbuf_default_init(ogs_pkbuf_config_t *config)
     config->cluster_big_pool = 8;
 }
 
+/*
+ * User plane pool : most packets are either small (TCP ACK, DNS)
+ * or close to the MTU, so only a few 8192 clusters are kept
+ */
+void ogs_pkbuf_packet_init(ogs_pkbuf_config_t *config, int num_of_packet)
+{
+    ogs_assert(config);
+    ogs_assert(num_of_packet > 0);
+    memset(config, 0, sizeof *config);
+
+    config->cluster_128_pool = num_of_packet;
+    config->cluster_256_pool = ogs_max(num_of_packet / 4, 1);
+    config->cluster_512_pool = ogs_max(num_of_packet / 4, 1);
+    config->cluster_1024_pool = ogs_max(num_of_packet / 4, 1);
+    config->cluster_2048_pool = num_of_packet;
+    config->cluster_8192_pool = ogs_max(num_of_packet / 8, 128);
+}
+
 void ogs_pkbuf_default_create(ogs_pkbuf_config_t *config)
 {
     default_pool = ogs_pkbuf_pool_create(config);
@@ -181,7 +224,7 @@ ogs_pkbuf_t *ogs_pkbuf_alloc(ogs_pkbuf_pool_t *pool, unsigned int size)
     ogs_assert(pkbuf);
     memset(pkbuf, 0, sizeof(*pkbuf));
 
-    cluster->ref++;
+    ogs_atomic_inc(&cluster->ref);
 
     ogs_thread_mutex_unlock(&pool->mutex);
 
@@ -202,7 +245,9 @@ ogs_pkbuf_t *ogs_pkbuf_alloc(ogs_pkbuf_pool_t *pool, unsigned int size)
 void ogs_pkbuf_free(ogs_pkbuf_t *pkbuf)
 {
     ogs_pkbuf_pool_t *pool = NULL;
+    ogs_pkbuf_cache_t *cache = NULL;
     ogs_cluster_t *cluster = NULL;
+    bool last;
     ogs_assert(pkbuf);
 
     pool = pkbuf->pool;
@@ -211,15 +256,24 @@ void ogs_pkbuf_free(ogs_pkbuf_t *pkbuf)
     cluster = pkbuf->cluster;
     ogs_assert(cluster);
 
-    ogs_thread_mutex_lock(&pool->mutex);
+    cache = pkbuf->cache;
 
-    cluster->ref--;
-    if (cluster->ref == 0)
-        cluster_free(pool, pkbuf->cluster);
+    /* Copies may be freed by other threads at the same time */
+    last = ogs_atomic_dec(&cluster->ref) == 0;
 
-    ogs_pool_free(&pool->pkbuf, pkbuf);
+    /* The owner of the cache takes back its own pkbuf without a lock */
+    if (!last || !cache || !cache_put(cache, pkbuf)) {
+        ogs_thread_mutex_lock(&pool->mutex);
 
-    ogs_thread_mutex_unlock(&pool->mutex);
+        if (last)
+            cluster_free(pool, cluster);
+        ogs_pool_free(&pool->pkbuf, pkbuf);
+
+        ogs_thread_mutex_unlock(&pool->mutex);
+    }
+
+    if (cache)
+        cache_unref(cache);
 }
 
 ogs_pkbuf_t *ogs_pkbuf_copy(ogs_pkbuf_t *pkbuf)
@@ -236,57 +290,85 @@ ogs_pkbuf_t *ogs_pkbuf_copy(ogs_pkbuf_t *pkbuf)
     ogs_pool_alloc(&pool->pkbuf, &newbuf);
     ogs_assert(newbuf);
     memcpy(newbuf, pkbuf, sizeof *pkbuf);
+    newbuf->cache = NULL;
 
-    newbuf->cluster->ref++;
+    ogs_atomic_inc(&newbuf->cluster->ref);
 
     ogs_thread_mutex_unlock(&pool->mutex);
 
     return newbuf;
 }
 
+static int cluster_class(unsigned int size)
+{
+    int i;
+
+    for (i = 0; i < OGS_NUM_OF_CLUSTER_CLASS; i++)
+        if (size <= cluster_size[i])
+            return i;
+
+    ogs_fatal("invalid size = %d", size);
+    ogs_assert_if_reached();
+    return -1;
+}
+
+static void *cluster_buffer_alloc(ogs_pkbuf_pool_t *pool, int i)
+{
+    void *buffer = NULL;
+
+    switch (i) {
+    case 0:
+        ogs_pool_alloc(&pool->cluster_128, (ogs_cluster_128_t**)&buffer);
+        break;
+    case 1:
+        ogs_pool_alloc(&pool->cluster_256, (ogs_cluster_256_t**)&buffer);
+        break;
+    case 2:
+        ogs_pool_alloc(&pool->cluster_512, (ogs_cluster_512_t**)&buffer);
+        break;
+    case 3:
+        ogs_pool_alloc(&pool->cluster_1024, (ogs_cluster_1024_t**)&buffer);
+        break;
+    case 4:
+        ogs_pool_alloc(&pool->cluster_2048, (ogs_cluster_2048_t**)&buffer);
+        break;
+    case 5:
+        ogs_pool_alloc(&pool->cluster_8192, (ogs_cluster_8192_t**)&buffer);
+        break;
+    case 6:
+        ogs_pool_alloc(&pool->cluster_big, (ogs_cluster_big_t**)&buffer);
+        break;
+    default:
+        ogs_assert_if_reached();
+    }
+
+    return buffer;
+}
+
 static ogs_cluster_t *cluster_alloc(
         ogs_pkbuf_pool_t *pool, unsigned int size)
 {
     ogs_cluster_t *cluster = NULL;
     void *buffer = NULL;
+    int i;
     ogs_assert(pool);
 
     ogs_pool_alloc(&pool->cluster, &cluster);
     ogs_assert(cluster);
     memset(cluster, 0, sizeof(*cluster));
 
-    if (size <= OGS_CLUSTER_128_SIZE) {
-        ogs_pool_alloc(&pool->cluster_128, (ogs_cluster_128_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_128_SIZE;
-    } else if (size <= OGS_CLUSTER_256_SIZE) {
-        ogs_pool_alloc(&pool->cluster_256, (ogs_cluster_256_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_256_SIZE;
-    } else if (size <= OGS_CLUSTER_512_SIZE) {
-        ogs_pool_alloc(&pool->cluster_512, (ogs_cluster_512_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_512_SIZE;
-    } else if (size <= OGS_CLUSTER_1024_SIZE) {
-        ogs_pool_alloc(&pool->cluster_1024, (ogs_cluster_1024_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_1024_SIZE;
-    } else if (size <= OGS_CLUSTER_2048_SIZE) {
-        ogs_pool_alloc(&pool->cluster_2048, (ogs_cluster_2048_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_2048_SIZE;
-    } else if (size <= OGS_CLUSTER_8192_SIZE) {
-        ogs_pool_alloc(&pool->cluster_8192, (ogs_cluster_8192_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_8192_SIZE;
-    } else if (size <= OGS_CLUSTER_BIG_SIZE) {
-        ogs_pool_alloc(&pool->cluster_big, (ogs_cluster_big_t**)&buffer);
-        ogs_assert(buffer);
-        cluster->size = OGS_CLUSTER_BIG_SIZE;
-    } else {
-        ogs_fatal("invalid size = %d", size);
+    /* Borrow from a larger class if the best fit is exhausted */
+    for (i = cluster_class(size); i < OGS_NUM_OF_CLUSTER_CLASS; i++) {
+        buffer = cluster_buffer_alloc(pool, i);
+        if (buffer)
+            break;
+    }
+    if (!buffer) {
+        ogs_fatal("cluster exhausted : size = %d", size);
         ogs_assert_if_reached();
     }
+
+    cluster->size = cluster_size[i];
     cluster->buffer = buffer;
 
     return cluster;
@@ -327,3 +409,146 @@ static void cluster_free(ogs_pkbuf_pool_t *pool, ogs_cluster_t *cluster)
     ogs_pool_free(&pool->cluster, cluster);
 }
 
+
+ogs_pkbuf_cache_t *ogs_pkbuf_cache_create(ogs_pkbuf_pool_t *pool)
+{
+    ogs_pkbuf_cache_t *cache = NULL;
+
+    if (pool == NULL)
+        pool = default_pool;
+    ogs_assert(pool);
+
+    cache = calloc(1, sizeof *cache);
+    ogs_assert(cache);
+
+    cache->pool = pool;
+    cache->ref = 1;
+
+    return cache;
+}
+
+static void cache_unref(ogs_pkbuf_cache_t *cache)
+{
+    if (ogs_atomic_dec(&cache->ref) == 0)
+        free(cache);
+}
+
+static void cache_drain(ogs_pkbuf_cache_t *cache, int i, int count)
+{
+    ogs_pkbuf_pool_t *pool = cache->pool;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_thread_mutex_lock(&pool->mutex);
+    while (count-- > 0 && cache->num[i] > 0) {
+        pkbuf = cache->pkbuf[i][--cache->num[i]];
+        cluster_free(pool, pkbuf->cluster);
+        ogs_pool_free(&pool->pkbuf, pkbuf);
+    }
+    ogs_thread_mutex_unlock(&pool->mutex);
+}
+
+static void cache_fill(ogs_pkbuf_cache_t *cache, int i, int count)
+{
+    ogs_pkbuf_pool_t *pool = cache->pool;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_cluster_t *cluster = NULL;
+    void *buffer = NULL;
+
+    ogs_thread_mutex_lock(&pool->mutex);
+    while (count-- > 0 && cache->num[i] < OGS_PKBUF_CACHE_SIZE &&
+            pool->pkbuf.avail > 0 && pool->cluster.avail > 0) {
+        buffer = cluster_buffer_alloc(pool, i);
+        if (!buffer)
+            break;
+
+        ogs_pool_alloc(&pool->cluster, &cluster);
+        ogs_assert(cluster);
+        memset(cluster, 0, sizeof(*cluster));
+        cluster->size = cluster_size[i];
+        cluster->buffer = buffer;
+
+        ogs_pool_alloc(&pool->pkbuf, &pkbuf);
+        ogs_assert(pkbuf);
+        memset(pkbuf, 0, sizeof(*pkbuf));
+        pkbuf->cluster = cluster;
+        pkbuf->pool = pool;
+        pkbuf->cache = cache;
+
+        cache->pkbuf[i][cache->num[i]++] = pkbuf;
+    }
+    ogs_thread_mutex_unlock(&pool->mutex);
+}
+
+static bool cache_put(ogs_pkbuf_cache_t *cache, ogs_pkbuf_t *pkbuf)
+{
+    int i;
+
+    if (!ogs_atomic_load(&cache->owned) ||
+        !ogs_thread_equal(cache->owner, ogs_thread_self()))
+        return false;
+
+    i = cluster_class(pkbuf->cluster->size);
+    if (cache->num[i] == OGS_PKBUF_CACHE_SIZE)
+        cache_drain(cache, i, OGS_PKBUF_CACHE_SIZE / 2);
+
+    cache->pkbuf[i][cache->num[i]++] = pkbuf;
+
+    return true;
+}
+
+ogs_pkbuf_t *ogs_pkbuf_cache_alloc(
+        ogs_pkbuf_cache_t *cache, unsigned int size)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_cluster_t *cluster = NULL;
+    int i;
+
+    ogs_assert(cache);
+
+    if (!cache->owned) {
+        cache->owner = ogs_thread_self();
+        ogs_atomic_store(&cache->owned, true);
+    }
+    ogs_assert(ogs_thread_equal(cache->owner, ogs_thread_self()));
+
+    i = cluster_class(size);
+    if (cache->num[i] == 0)
+        cache_fill(cache, i, OGS_PKBUF_CACHE_SIZE / 2);
+
+    if (cache->num[i] == 0) {
+        /* Exhausted, let the pool borrow from a larger class */
+        pkbuf = ogs_pkbuf_alloc(cache->pool, size);
+        pkbuf->cache = cache;
+        ogs_atomic_inc(&cache->ref);
+        return pkbuf;
+    }
+
+    pkbuf = cache->pkbuf[i][--cache->num[i]];
+    cluster = pkbuf->cluster;
+    ogs_atomic_store(&cluster->ref, 1);
+    ogs_atomic_inc(&cache->ref);
+
+    pkbuf->len = 0;
+
+    pkbuf->data = cluster->buffer;
+    pkbuf->head = cluster->buffer;
+    pkbuf->tail = cluster->buffer;
+    pkbuf->end = cluster->buffer + size;
+
+    return pkbuf;
+}
+
+void ogs_pkbuf_cache_destroy(ogs_pkbuf_cache_t *cache)
+{
+    int i;
+
+    ogs_assert(cache);
+
+    /* pkbufs still in flight go back to the pool from now on */
+    ogs_atomic_store(&cache->owned, false);
+
+    for (i = 0; i < OGS_NUM_OF_CLUSTER_CLASS; i++)
+        cache_drain(cache, i, cache->num[i]);
+
+    cache_unref(cache);
+}
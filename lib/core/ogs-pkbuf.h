@@ -36,6 +36,7 @@ typedef struct ogs_cluster_s {
 } ogs_cluster_t;
 
 typedef struct ogs_pkbuf_pool_s ogs_pkbuf_pool_t;
+typedef struct ogs_pkbuf_cache_s ogs_pkbuf_cache_t;
 typedef struct ogs_pkbuf_s {
     ogs_cluster_t *cluster;
 
@@ -47,6 +48,7 @@ typedef struct ogs_pkbuf_s {
     unsigned char *end;
     
     ogs_pkbuf_pool_t *pool;
+    ogs_pkbuf_cache_t *cache;
 } ogs_pkbuf_t;
 
 typedef struct ogs_pkbuf_config_s {
@@ -63,6 +65,7 @@ void ogs_pkbuf_init(void);
 void ogs_pkbuf_final(void);
 
 void ogs_pkbuf_default_init(ogs_pkbuf_config_t *config);
+void ogs_pkbuf_packet_init(ogs_pkbuf_config_t *config, int num_of_packet);
 void ogs_pkbuf_default_create(ogs_pkbuf_config_t *config);
 void ogs_pkbuf_default_destroy(void);
 
@@ -72,6 +75,21 @@ void ogs_pkbuf_pool_destroy(ogs_pkbuf_pool_t *pool);
 ogs_pkbuf_t *ogs_pkbuf_alloc(ogs_pkbuf_pool_t *pool, unsigned int size);
 void ogs_pkbuf_free(ogs_pkbuf_t *pkbuf);
 
+/*
+ * Per-thread pkbuf cache
+ *
+ * Keeps a few free pkbufs of each cluster size taken from 'pool'.
+ * The first thread that allocates from the cache owns it. The owner
+ * allocates and frees without the pool mutex, refilling or draining
+ * half of the cache under one lock when it runs empty or full.
+ * Other threads may free the pkbufs, which then go back to the pool.
+ * pkbufs may also outlive the cache; the last of them frees it.
+ */
+ogs_pkbuf_cache_t *ogs_pkbuf_cache_create(ogs_pkbuf_pool_t *pool);
+void ogs_pkbuf_cache_destroy(ogs_pkbuf_cache_t *cache);
+ogs_pkbuf_t *ogs_pkbuf_cache_alloc(
+        ogs_pkbuf_cache_t *cache, unsigned int size);
+
 void *ogs_pkbuf_put_data(
         ogs_pkbuf_t *pkbuf, const void *data, unsigned int len);
 ogs_pkbuf_t *ogs_pkbuf_copy(ogs_pkbuf_t *pkbuf);
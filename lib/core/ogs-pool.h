@@ -41,15 +41,15 @@ typedef unsigned int ogs_index_t;
 #define ogs_pool_init(pool, _size) do { \
     int i; \
     (pool)->name = #pool; \
-    (pool)->free = malloc(sizeof(*(pool)->free) * _size); \
+    (pool)->free = malloc(sizeof(*(pool)->free) * (_size)); \
     ogs_assert((pool)->free); \
-    (pool)->array = malloc(sizeof(*(pool)->array) * _size); \
+    (pool)->array = malloc(sizeof(*(pool)->array) * (_size)); \
     ogs_assert((pool)->array); \
-    (pool)->index = malloc(sizeof(*(pool)->index) * _size); \
+    (pool)->index = malloc(sizeof(*(pool)->index) * (_size)); \
     ogs_assert((pool)->index); \
-    (pool)->size = (pool)->avail = _size; \
+    (pool)->size = (pool)->avail = (_size); \
     (pool)->head = (pool)->tail = 0; \
-    for (i = 0; i < _size; i++) { \
+    for (i = 0; i < (_size); i++) { \
         (pool)->free[i] = &((pool)->array[i]); \
         (pool)->index[i] = NULL; \
     } \
@@ -18,6 +18,7 @@
  */
 
 #include "core-config-private.h"
+#include "core-config.h" /* _GNU_SOURCE for struct mmsghdr */
 
 #if HAVE_FCNTL_H
 #include <fcntl.h>
@@ -210,7 +211,7 @@ ssize_t ogs_read(ogs_socket_t fd, void *buf, size_t len)
     ogs_assert(fd != INVALID_SOCKET);
 
     size = read(fd, buf, len);
-    if (size < 0) {
+    if (size < 0 && ogs_socket_errno != OGS_EAGAIN) {
         ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
                 "ogs_read(len:%d) failed", (int)size);
     }
@@ -288,6 +289,128 @@ ssize_t ogs_recvfrom(ogs_socket_t fd,
     return size;
 }
 
+/*
+ * Receive up to 'num' datagrams. Each pkbuf must be put to its full
+ * capacity by the caller and is trimmed to the received length.
+ * Returns the number of datagrams received.
+ */
+int ogs_recvmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int num, int flags)
+{
+#if HAVE_RECVMMSG
+    struct mmsghdr msg[OGS_MAX_NUM_OF_MMSG];
+    struct iovec iov[OGS_MAX_NUM_OF_MMSG];
+    int i, n;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(pkbuf);
+    ogs_assert(num > 0 && num <= OGS_MAX_NUM_OF_MMSG);
+
+    memset(msg, 0, sizeof(msg[0]) * num);
+    for (i = 0; i < num; i++) {
+        ogs_assert(pkbuf[i]);
+        iov[i].iov_base = pkbuf[i]->data;
+        iov[i].iov_len = pkbuf[i]->len;
+        msg[i].msg_hdr.msg_iov = &iov[i];
+        msg[i].msg_hdr.msg_iovlen = 1;
+        if (from) {
+            memset(&from[i], 0, sizeof from[i]);
+            msg[i].msg_hdr.msg_name = &from[i].sa;
+            msg[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        }
+    }
+
+    /* Block for the first datagram only */
+    n = recvmmsg(fd, msg, num, flags | MSG_WAITFORONE, NULL);
+    if (n < 0) {
+        if (ogs_socket_errno != OGS_EAGAIN)
+            ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                    "recvmmsg(num:%d) failed", num);
+        return n;
+    }
+
+    for (i = 0; i < n; i++)
+        ogs_pkbuf_trim(pkbuf[i], msg[i].msg_len);
+
+    return n;
+#else
+    ssize_t size;
+    ogs_sockaddr_t addr;
+
+    ogs_assert(pkbuf);
+    ogs_assert(num > 0);
+    ogs_assert(pkbuf[0]);
+
+    size = ogs_recvfrom(fd, pkbuf[0]->data, pkbuf[0]->len, flags,
+            from ? &from[0] : &addr);
+    if (size < 0)
+        return size;
+
+    ogs_pkbuf_trim(pkbuf[0], size);
+
+    return 1;
+#endif
+}
+
+/*
+ * Send 'num' datagrams on the same socket.
+ * Returns the number of datagrams sent.
+ */
+int ogs_sendmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t **to, int num, int flags)
+{
+#if HAVE_SENDMMSG
+    struct mmsghdr msg[OGS_MAX_NUM_OF_MMSG];
+    struct iovec iov[OGS_MAX_NUM_OF_MMSG];
+    int i, n, sent = 0, failed = 0;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(pkbuf);
+    ogs_assert(to);
+    ogs_assert(num > 0 && num <= OGS_MAX_NUM_OF_MMSG);
+
+    memset(msg, 0, sizeof(msg[0]) * num);
+    for (i = 0; i < num; i++) {
+        ogs_assert(pkbuf[i]);
+        ogs_assert(to[i]);
+        iov[i].iov_base = pkbuf[i]->data;
+        iov[i].iov_len = pkbuf[i]->len;
+        msg[i].msg_hdr.msg_iov = &iov[i];
+        msg[i].msg_hdr.msg_iovlen = 1;
+        msg[i].msg_hdr.msg_name = &to[i]->sa;
+        msg[i].msg_hdr.msg_namelen = ogs_sockaddr_len(to[i]);
+        ogs_assert(msg[i].msg_hdr.msg_namelen);
+    }
+
+    while (sent < num) {
+        n = sendmmsg(fd, &msg[sent], num - sent, flags);
+        if (n < 0) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                    "sendmmsg(num:%d) failed", num - sent);
+            /* Skip the datagram that failed and keep going */
+            sent++;
+            failed++;
+            continue;
+        }
+        sent += n;
+    }
+
+    return sent - failed;
+#else
+    int i, sent = 0;
+
+    ogs_assert(pkbuf);
+    ogs_assert(to);
+
+    for (i = 0; i < num; i++) {
+        if (ogs_sendto(fd, pkbuf[i]->data, pkbuf[i]->len, flags, to[i]) >= 0)
+            sent++;
+    }
+
+    return sent;
+#endif
+}
+
 int ogs_closesocket(ogs_socket_t fd)
 {
     int r;
@@ -379,3 +502,24 @@ int ogs_listen_reusable(ogs_socket_t fd)
 
     return OGS_OK;
 }
+
+int ogs_listen_reuseport(ogs_socket_t fd)
+{
+#if defined(SO_REUSEPORT) && !defined(_WIN32)
+    int rc;
+    int on = 1;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    rc = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (void *)&on, sizeof(int));
+    if (rc != OGS_OK) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(SOL_SOCKET, SO_REUSEPORT) failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+#else
+    ogs_error("SO_REUSEPORT is not supported");
+    return OGS_ERROR;
+#endif
+}
@@ -69,11 +69,18 @@ ssize_t ogs_recv(ogs_socket_t fd, void *buf, size_t len, int flags);
 ssize_t ogs_recvfrom(ogs_socket_t fd,
         void *buf, size_t len, int flags, ogs_sockaddr_t *from);
 
+#define OGS_MAX_NUM_OF_MMSG 64
+int ogs_recvmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int num, int flags);
+int ogs_sendmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t **to, int num, int flags);
+
 int ogs_closesocket(ogs_socket_t fd);
 
 int ogs_nonblocking(ogs_socket_t fd);
 int ogs_closeonexec(ogs_socket_t fd);
 int ogs_listen_reusable(ogs_socket_t fd);
+int ogs_listen_reuseport(ogs_socket_t fd);
 
 #ifdef __cplusplus
 }
@@ -69,6 +69,9 @@ static ogs_inline int ogs_thread_cond_timedwait(
 #define ogs_thread_cond_destroy (void)pthread_cond_destroy
 #define ogs_thread_id_t pthread_t
 #define ogs_thread_join(_n) pthread_join((_n), NULL)
+#define ogs_thread_self_t pthread_t
+#define ogs_thread_self() pthread_self()
+#define ogs_thread_equal(_a, _b) pthread_equal((_a), (_b))
 #else
 #define ogs_thread_mutex_t CRITICAL_SECTION
 #define ogs_thread_mutex_init InitializeCriticalSection
@@ -103,8 +106,20 @@ static ogs_inline int ogs_thread_cond_destroy(ogs_thread_cond_t *_ignored)
 {
    return 0;
 }
+#define ogs_thread_self_t DWORD
+#define ogs_thread_self() GetCurrentThreadId()
+#define ogs_thread_equal(_a, _b) ((_a) == (_b))
 #endif
 
+/*
+ * Minimal atomics for lock-free readers (GCC/Clang builtins)
+ */
+#define ogs_atomic_load(_p) __atomic_load_n((_p), __ATOMIC_ACQUIRE)
+#define ogs_atomic_store(_p, _v) __atomic_store_n((_p), (_v), __ATOMIC_RELEASE)
+#define ogs_atomic_inc(_p) __atomic_add_fetch((_p), 1, __ATOMIC_SEQ_CST)
+#define ogs_atomic_dec(_p) __atomic_sub_fetch((_p), 1, __ATOMIC_SEQ_CST)
+#define ogs_atomic_fence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
 typedef struct ogs_thread_s ogs_thread_t;
 
 ogs_thread_t *ogs_thread_create(void (*func)(void *), void *data);
@@ -22,9 +22,40 @@
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __ogs_event_domain
 
+/*
+ * Hierarchical Timing Wheel
+ *
+ * TW_LEVEL levels of TW_SIZE slots with a tick of TW_TICK. A timer sits
+ * at the level of the highest base-TW_SIZE digit in which its expiry
+ * tick differs from the current tick. When the current tick enters a
+ * new block of a level, that slot is cascaded to the levels below.
+ * Start and stop are O(1). Level 0 slots expire as a whole.
+ */
+#define TW_BITS         6
+#define TW_SIZE         (1 << TW_BITS)
+#define TW_MASK         (TW_SIZE - 1)
+#define TW_LEVEL        6
+#define TW_TICK         1000    /* 1 msec */
+
+#define TW_DIGIT(__tICK, __lEVEL) \
+    (int)(((__tICK) >> ((__lEVEL) * TW_BITS)) & TW_MASK)
+
+typedef struct ogs_timer_wheel_s {
+    uint64_t tick;              /* Next tick to be processed */
+    int count;                  /* Num of timers in the slots */
+
+    uint64_t next;              /* Cache of the earliest expiry tick */
+    bool next_valid;
+
+    uint64_t map[TW_LEVEL];     /* Non-empty slots */
+    ogs_list_t slot[TW_LEVEL][TW_SIZE];
+} ogs_timer_wheel_t;
+
 typedef struct ogs_timer_mgr_s {
     OGS_POOL(pool, ogs_timer_t);
     ogs_rbtree_t tree;
+
+    ogs_timer_wheel_t *wheel;   /* NULL if the red-black tree is used */
 } ogs_timer_mgr_t;
 
 typedef struct ogs_timer_s {
@@ -37,6 +68,9 @@ typedef struct ogs_timer_s {
     ogs_timer_mgr_t *manager;
     bool running;
     ogs_time_t timeout;;       
+
+    uint64_t expires;           /* Timing wheel tick */
+    ogs_list_t *list;           /* Timing wheel slot or expired list */
 } ogs_timer_t;
 
 static void add_timer_node(
@@ -64,6 +98,118 @@ static void add_timer_node(
     ogs_rbtree_insert_color(tree, timer);
 }
 
+static void wheel_link(ogs_timer_wheel_t *wheel, ogs_timer_t *timer)
+{
+    uint64_t expires = timer->expires;
+    uint64_t diff;
+    int level, index;
+
+    if (expires < wheel->tick)
+        expires = wheel->tick;
+
+    diff = expires ^ wheel->tick;
+    if (diff >> (TW_LEVEL * TW_BITS)) {
+        /* Beyond the wheel, park it at the end of the top level block */
+        expires = wheel->tick | (((uint64_t)1 << (TW_LEVEL * TW_BITS)) - 1);
+        diff = expires ^ wheel->tick;
+    }
+
+    for (level = 0; level < TW_LEVEL - 1; level++)
+        if ((diff >> ((level + 1) * TW_BITS)) == 0)
+            break;
+
+    index = TW_DIGIT(expires, level);
+    timer->list = &wheel->slot[level][index];
+    ogs_list_add(timer->list, &timer->lnode);
+    wheel->map[level] |= (uint64_t)1 << index;
+    wheel->count++;
+}
+
+static void wheel_unlink(ogs_timer_wheel_t *wheel, ogs_timer_t *timer)
+{
+    ogs_list_t *list = timer->list;
+
+    ogs_list_remove(list, &timer->lnode);
+    timer->list = NULL;
+
+    if (list >= &wheel->slot[0][0] &&
+        list <= &wheel->slot[TW_LEVEL-1][TW_SIZE-1]) {
+        int n = list - &wheel->slot[0][0];
+
+        if (!ogs_list_first(list))
+            wheel->map[n / TW_SIZE] &= ~((uint64_t)1 << (n % TW_SIZE));
+        wheel->count--;
+    }
+}
+
+static void wheel_process(ogs_timer_wheel_t *wheel, ogs_list_t *expired)
+{
+    ogs_timer_t *this = NULL;
+    ogs_lnode_t *lnode = NULL;
+    uint64_t tick = wheel->tick;
+    int level, index;
+
+    /* Cascade from the highest level whose block starts at this tick */
+    for (level = 1; level < TW_LEVEL; level++)
+        if (tick & (((uint64_t)1 << (level * TW_BITS)) - 1))
+            break;
+
+    for (level = level - 1; level >= 1; level--) {
+        index = TW_DIGIT(tick, level);
+        if (!(wheel->map[level] & ((uint64_t)1 << index)))
+            continue;
+
+        while ((lnode = ogs_list_first(&wheel->slot[level][index]))) {
+            this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+            wheel_unlink(wheel, this);
+            wheel_link(wheel, this);
+        }
+    }
+
+    index = TW_DIGIT(tick, 0);
+    if (!(wheel->map[0] & ((uint64_t)1 << index)))
+        return;
+
+    while ((lnode = ogs_list_first(&wheel->slot[0][index]))) {
+        this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+        wheel_unlink(wheel, this);
+        if (this->expires > tick) {
+            /* Parked beyond the wheel */
+            wheel_link(wheel, this);
+            continue;
+        }
+        this->list = expired;
+        ogs_list_add(expired, &this->lnode);
+    }
+}
+
+static uint64_t wheel_next(ogs_timer_wheel_t *wheel)
+{
+    ogs_lnode_t *lnode = NULL;
+    uint64_t next = UINT64_MAX;
+    int level;
+
+    /*
+     * Every timer at a level expires before any timer at a higher level
+     * and slots below the current digit are empty, so the earliest timer
+     * is in the lowest non-empty slot of the lowest non-empty level.
+     */
+    for (level = 0; level < TW_LEVEL; level++) {
+        if (wheel->map[level]) {
+            int index = __builtin_ctzll(wheel->map[level]);
+
+            ogs_list_for_each(&wheel->slot[level][index], lnode) {
+                ogs_timer_t *this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+                if (this->expires < next)
+                    next = this->expires;
+            }
+            break;
+        }
+    }
+
+    return next;
+}
+
 ogs_timer_mgr_t *ogs_timer_mgr_create(void)
 {
     ogs_timer_mgr_t *manager = ogs_calloc(1, sizeof *manager);
@@ -71,6 +217,12 @@ ogs_timer_mgr_t *ogs_timer_mgr_create(void)
 
     ogs_pool_init(&manager->pool, ogs_core()->timer.pool);
 
+    if (ogs_core()->timer.wheel) {
+        manager->wheel = ogs_calloc(1, sizeof(ogs_timer_wheel_t));
+        ogs_assert(manager->wheel);
+        manager->wheel->tick = ogs_get_monotonic_time() / TW_TICK;
+    }
+
     return manager;
 }
 
@@ -78,6 +230,9 @@ void ogs_timer_mgr_destroy(ogs_timer_mgr_t *manager)
 {
     ogs_assert(manager);
 
+    if (manager->wheel)
+        ogs_free(manager->wheel);
+
     ogs_pool_final(&manager->pool);
     ogs_free(manager);
 }
@@ -122,6 +277,21 @@ void ogs_timer_start(ogs_timer_t *timer, ogs_time_t duration)
     manager = timer->manager;
     ogs_assert(manager);
 
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+
+        ogs_timer_stop(timer);
+
+        timer->running = true;
+        timer->timeout = ogs_get_monotonic_time() + duration;
+        timer->expires = (timer->timeout + TW_TICK - 1) / TW_TICK;
+        wheel_link(wheel, timer);
+
+        if (wheel->next_valid && timer->expires < wheel->next)
+            wheel->next = timer->expires;
+        return;
+    }
+
     if (timer->running == true)
         ogs_rbtree_delete(&manager->tree, timer);
 
@@ -140,6 +310,16 @@ void ogs_timer_stop(ogs_timer_t *timer)
         return;
 
     timer->running = false;
+
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+
+        if (wheel->next_valid && timer->expires == wheel->next)
+            wheel->next_valid = false;
+        wheel_unlink(wheel, timer);
+        return;
+    }
+
     ogs_rbtree_delete(&manager->tree, timer);
 }
 
@@ -150,6 +330,27 @@ ogs_time_t ogs_timer_mgr_next(ogs_timer_mgr_t *manager)
     ogs_assert(manager);
 
     current = ogs_get_monotonic_time();
+
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+        ogs_time_t timeout;
+
+        if (!wheel->count)
+            return OGS_INFINITE_TIME;
+
+        if (!wheel->next_valid) {
+            wheel->next = wheel_next(wheel);
+            wheel->next_valid = true;
+        }
+
+        /* Wait up to the tick boundary so that the slot is due */
+        timeout = wheel->next * TW_TICK;
+        if (timeout > current)
+            return (timeout - current);
+        else
+            return OGS_NO_WAIT_TIME;
+    }
+
     rbnode = ogs_rbtree_first(&manager->tree);
     if (rbnode) {
         ogs_timer_t *this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
@@ -176,6 +377,43 @@ void ogs_timer_mgr_expire(ogs_timer_mgr_t *manager)
     current = ogs_get_monotonic_time();
 
     ogs_list_init(&list);
+
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+        uint64_t target = current / TW_TICK;
+
+        while (wheel->tick <= target) {
+            if (!wheel->count) {
+                wheel->tick = target + 1;
+                break;
+            }
+
+            /* Nothing due in level 0, skip to the next cascade */
+            if ((wheel->tick & TW_MASK) && !wheel->map[0]) {
+                wheel->tick = ogs_min((wheel->tick | TW_MASK) + 1, target + 1);
+                continue;
+            }
+
+            wheel_process(wheel, &list);
+            wheel->tick++;
+        }
+        wheel->next_valid = false;
+
+        /*
+         * ogs_timer_stop() in a callback takes a timer
+         * off this list as well, so it will not fire.
+         */
+        while ((lnode = ogs_list_first(&list))) {
+            this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+            ogs_list_remove(&list, lnode);
+            this->list = NULL;
+            this->running = false;
+            if (this->cb)
+                this->cb(this->data);
+        }
+        return;
+    }
+
     ogs_rbtree_for_each(&manager->tree, rbnode) {
         this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
 
@@ -36,34 +36,107 @@ ogs_tlv_desc_t ogs_tlv_desc_more7 = {
 ogs_tlv_desc_t ogs_tlv_desc_more8 = { 
     OGS_TLV_MORE, "More", 0, 8, 0, 0, { NULL } };
 
-static ogs_tlv_t *tlv_add_leaf(
-        ogs_tlv_t *parent_tlv, ogs_tlv_t *tlv, ogs_tlv_desc_t *desc, void *msg)
+static uint32_t tlv_header_len(int mode)
+{
+    switch (mode) {
+    case OGS_TLV_MODE_T1_L1:
+        return 2;
+    case OGS_TLV_MODE_T1_L2:
+        return 3;
+    case OGS_TLV_MODE_T1_L2_I1:
+    case OGS_TLV_MODE_T2_L2:
+        return 4;
+    default:
+        ogs_assert_if_reached();
+        return 0;
+    }
+}
+
+static uint8_t *tlv_put_header(uint8_t *pos,
+        uint32_t type, uint32_t length, uint8_t instance, int mode)
+{
+    switch (mode) {
+    case OGS_TLV_MODE_T1_L1:
+        ogs_assert(length <= 0xff);
+        *(pos++) = type;
+        *(pos++) = length;
+        break;
+    case OGS_TLV_MODE_T1_L2:
+        *(pos++) = type;
+        *(pos++) = length >> 8;
+        *(pos++) = length;
+        break;
+    case OGS_TLV_MODE_T1_L2_I1:
+        *(pos++) = type;
+        *(pos++) = length >> 8;
+        *(pos++) = length;
+        *(pos++) = instance;
+        break;
+    case OGS_TLV_MODE_T2_L2:
+        *(pos++) = type >> 8;
+        *(pos++) = type;
+        *(pos++) = length >> 8;
+        *(pos++) = length;
+        break;
+    default:
+        ogs_assert_if_reached();
+        break;
+    }
+
+    return pos;
+}
+
+static uint32_t tlv_leaf_len(ogs_tlv_desc_t *desc, void *msg)
+{
+    switch (desc->ctype) {
+    case OGS_TLV_UINT8:
+    case OGS_TLV_INT8:
+        return 1;
+    case OGS_TLV_UINT16:
+    case OGS_TLV_INT16:
+        return 2;
+    case OGS_TLV_UINT24:
+    case OGS_TLV_INT24:
+        return 3;
+    case OGS_TLV_UINT32:
+    case OGS_TLV_INT32:
+        return 4;
+    case OGS_TLV_FIXED_STR:
+        return desc->length;
+    case OGS_TLV_VAR_STR:
+    {
+        ogs_tlv_octet_t *v = (ogs_tlv_octet_t *)msg;
+
+        ogs_assert(v->len > 0);
+        return v->len;
+    }
+    case OGS_TLV_NULL:
+        return 0;
+    default:
+        ogs_assert_if_reached();
+        return 0;
+    }
+}
+
+/* Values are written in network order; the message itself is not touched */
+static uint8_t *tlv_put_leaf(uint8_t *pos, ogs_tlv_desc_t *desc, void *msg)
 {
     switch (desc->ctype) {
     case OGS_TLV_UINT8:
     case OGS_TLV_INT8:
     {
         ogs_tlv_uint8_t *v = (ogs_tlv_uint8_t *)msg;
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv, 
-                    desc->type, 1, desc->instance, &v->u8);
-        else
-            tlv = ogs_tlv_add(tlv, desc->type, 1, desc->instance, &v->u8);
-        ogs_assert(tlv);
+
+        *(pos++) = v->u8;
         break;
     }
     case OGS_TLV_UINT16:
+    case OGS_TLV_INT16:
     {
         ogs_tlv_uint16_t *v = (ogs_tlv_uint16_t *)msg;
 
-        v->u16 = htons(v->u16);
-
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv, 
-                    desc->type, 2, desc->instance, &v->u16);
-        else
-            tlv = ogs_tlv_add(tlv, desc->type, 2, desc->instance, &v->u16);
-        ogs_assert(tlv);
+        *(pos++) = v->u16 >> 8;
+        *(pos++) = v->u16;
         break;
     }
     case OGS_TLV_UINT24:
@@ -71,15 +144,9 @@ static ogs_tlv_t *tlv_add_leaf(
     {
         ogs_tlv_uint24_t *v = (ogs_tlv_uint24_t *)msg;
 
-        v->u24 = v->u24 << 8;
-        v->u24 = htonl(v->u24);
-
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv, 
-                    desc->type, 3, desc->instance, &v->u24);
-        else
-            tlv = ogs_tlv_add(tlv, desc->type, 3, desc->instance, &v->u24);
-        ogs_assert(tlv);
+        *(pos++) = v->u24 >> 16;
+        *(pos++) = v->u24 >> 8;
+        *(pos++) = v->u24;
         break;
     }
     case OGS_TLV_UINT32:
@@ -87,28 +154,18 @@ static ogs_tlv_t *tlv_add_leaf(
     {
         ogs_tlv_uint32_t *v = (ogs_tlv_uint32_t *)msg;
 
-        v->u32 = htonl(v->u32);
-
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv,
-                    desc->type, 4, desc->instance, &v->u32);
-        else
-            tlv = ogs_tlv_add(tlv,
-                    desc->type, 4, desc->instance, &v->u32);
-        ogs_assert(tlv);
+        *(pos++) = v->u32 >> 24;
+        *(pos++) = v->u32 >> 16;
+        *(pos++) = v->u32 >> 8;
+        *(pos++) = v->u32;
         break;
     }
     case OGS_TLV_FIXED_STR:
     {
         ogs_tlv_octet_t *v = (ogs_tlv_octet_t *)msg;
 
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv, 
-                    desc->type, desc->length, desc->instance, v->data);
-        else
-            tlv = ogs_tlv_add(tlv, 
-                    desc->type, desc->length, desc->instance, v->data);
-        ogs_assert(tlv);
+        memcpy(pos, v->data, desc->length);
+        pos += desc->length;
         break;
     }
     case OGS_TLV_VAR_STR:
@@ -116,147 +173,125 @@ static ogs_tlv_t *tlv_add_leaf(
         ogs_tlv_octet_t *v = (ogs_tlv_octet_t *)msg;
 
         ogs_assert(v->len > 0);
-
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv, 
-                    desc->type, v->len, desc->instance, v->data);
-        else
-            tlv = ogs_tlv_add(tlv, 
-                    desc->type, v->len, desc->instance, v->data);
-        ogs_assert(tlv);
+        memcpy(pos, v->data, v->len);
+        pos += v->len;
         break;
     }
     case OGS_TLV_NULL:
-    {
-        if (parent_tlv)
-            tlv = ogs_tlv_embed(parent_tlv, 
-                    desc->type, 0, desc->instance, NULL);
-        else
-            tlv = ogs_tlv_add(tlv, 
-                    desc->type, 0, desc->instance, NULL);
-        ogs_assert(tlv);
         break;
-    }
     default:
         ogs_assert_if_reached();
         break;
     }
 
-    return tlv;
+    return pos;
 }
 
-static uint32_t tlv_add_compound(ogs_tlv_t **root, ogs_tlv_t *parent_tlv,
-        ogs_tlv_desc_t *parent_desc, void *msg, int depth)
+static uint32_t tlv_calc_compound(
+        ogs_tlv_desc_t *parent_desc, void *msg, int depth, int mode)
 {
     ogs_tlv_presence_t *presence_p;
     ogs_tlv_desc_t *desc = NULL, *next_desc = NULL;
-    ogs_tlv_t *tlv = NULL, *emb_tlv = NULL;
     uint8_t *p = msg;
-    uint32_t offset = 0, count = 0;
-    int i, j, r;
-    char indent[17] = "                "; /* 16 spaces */
+    uint32_t offset = 0, length = 0;
+    int i, j, count, more;
 
-    ogs_assert(root);
     ogs_assert(parent_desc);
     ogs_assert(msg);
-
     ogs_assert(depth <= 8);
-    indent[depth*2] = 0;
-
-    *root = NULL;
 
     for (i = 0, desc = parent_desc->child_descs[i]; desc != NULL;
             i++, desc = parent_desc->child_descs[i]) {
         next_desc = parent_desc->child_descs[i+1];
-        if (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE) {
-            int offset2 = offset;
-            for (j = 0; j < next_desc->length; j++) {
-                presence_p = (ogs_tlv_presence_t *)(p + offset2);
+        more = (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE);
+        count = more ? next_desc->length : 1;
+
+        for (j = 0; j < count; j++) {
+            presence_p = (ogs_tlv_presence_t *)(p + offset + desc->vsize * j);
+            if (*presence_p == 0)
+                break;
+
+            length += tlv_header_len(mode);
+            if (desc->ctype == OGS_TLV_COMPOUND)
+                length += tlv_calc_compound(desc,
+                        (uint8_t *)presence_p + sizeof(ogs_tlv_presence_t),
+                        depth + 1, mode);
+            else
+                length += tlv_leaf_len(desc, presence_p);
+        }
 
-                if (*presence_p == 0)
-                    break;
+        offset += desc->vsize * count;
+        if (more)
+            i++;
+    }
 
-                if (desc->ctype == OGS_TLV_COMPOUND) {
-                    ogs_trace("BUILD %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->instance, 
-                            desc->vsize, p + offset2);
-
-                    if (parent_tlv)
-                        tlv = ogs_tlv_embed(parent_tlv, 
-                                desc->type, 0, desc->instance, NULL);
-                    else
-                        tlv = ogs_tlv_add(tlv, desc->type, 0, desc->instance, NULL);
-
-                    r = tlv_add_compound(&emb_tlv, tlv, desc,
-                            p + offset2 + sizeof(ogs_tlv_presence_t),
-                            depth + 1);
-                    ogs_assert(r > 0 && emb_tlv);
-                    count += 1 + r;
-                } else {
-                    ogs_trace("BUILD %sL#%d [%s] T:%d L:%d I:%d "
-                            "(cls:%d vsz:%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->length, 
-                            desc->instance, desc->ctype, desc->vsize, 
-                            p + offset2);
-
-                    tlv = tlv_add_leaf(parent_tlv, tlv, desc, p + offset2);
-                    ogs_assert(tlv);
-                    count++;
-                }
+    return length;
+}
+
+static uint8_t *tlv_put_compound(uint8_t *pos,
+        ogs_tlv_desc_t *parent_desc, void *msg, int depth, int mode)
+{
+    ogs_tlv_presence_t *presence_p;
+    ogs_tlv_desc_t *desc = NULL, *next_desc = NULL;
+    uint8_t *p = msg, *hdr = NULL, *value = NULL;
+    uint32_t offset = 0;
+    int i, j, count, more;
+    char indent[17] = "                "; /* 16 spaces */
 
-                if (*root == NULL)
-                    *root = tlv;
+    ogs_assert(parent_desc);
+    ogs_assert(msg);
 
-                offset2 += desc->vsize;
-            }
-            offset += desc->vsize * next_desc->length;
-            i++;
-        } else {
-            presence_p = (ogs_tlv_presence_t *)(p + offset);
-
-            if (*presence_p) {
-                if (desc->ctype == OGS_TLV_COMPOUND) {
-                    ogs_trace("BUILD %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->instance, 
-                            desc->vsize, p + offset);
-
-                    if (parent_tlv)
-                        tlv = ogs_tlv_embed(parent_tlv, 
-                                desc->type, 0, desc->instance, NULL);
-                    else
-                        tlv = ogs_tlv_add(tlv, desc->type, 0, desc->instance, NULL);
-
-                    r = tlv_add_compound(&emb_tlv, tlv, desc,
-                            p + offset + sizeof(ogs_tlv_presence_t),
-                            depth + 1);
-                    ogs_assert(r > 0 && emb_tlv);
-                    count += 1 + r;
-                } else {
-                    ogs_trace("BUILD %sL#%d [%s] T:%d L:%d I:%d "
-                            "(cls:%d vsz:%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->length, 
-                            desc->instance, desc->ctype, desc->vsize, 
-                            p + offset);
-
-                    tlv = tlv_add_leaf(parent_tlv, tlv, desc, p + offset);
-                    ogs_assert(tlv);
-                    count++;
-                }
+    ogs_assert(depth <= 8);
+    indent[depth*2] = 0;
 
-                if (*root == NULL)
-                    *root = tlv;
+    for (i = 0, desc = parent_desc->child_descs[i]; desc != NULL;
+            i++, desc = parent_desc->child_descs[i]) {
+        next_desc = parent_desc->child_descs[i+1];
+        more = (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE);
+        count = more ? next_desc->length : 1;
+
+        for (j = 0; j < count; j++) {
+            presence_p = (ogs_tlv_presence_t *)(p + offset + desc->vsize * j);
+            if (*presence_p == 0)
+                break;
+
+            if (desc->ctype == OGS_TLV_COMPOUND) {
+                ogs_trace("BUILD %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
+                        indent, i, desc->name, desc->type, desc->instance,
+                        desc->vsize, presence_p);
+
+                /* Length is back-patched once the group is written */
+                hdr = pos;
+                value = tlv_put_header(pos, desc->type, 0, desc->instance, mode);
+                pos = tlv_put_compound(value, desc,
+                        (uint8_t *)presence_p + sizeof(ogs_tlv_presence_t),
+                        depth + 1, mode);
+                tlv_put_header(hdr,
+                        desc->type, pos - value, desc->instance, mode);
+            } else {
+                ogs_trace("BUILD %sL#%d [%s] T:%d L:%d I:%d "
+                        "(cls:%d vsz:%d) off:%p ",
+                        indent, i, desc->name, desc->type, desc->length,
+                        desc->instance, desc->ctype, desc->vsize, presence_p);
+
+                pos = tlv_put_header(pos, desc->type,
+                        tlv_leaf_len(desc, presence_p), desc->instance, mode);
+                pos = tlv_put_leaf(pos, desc, presence_p);
             }
-            offset += desc->vsize;
         }
+
+        offset += desc->vsize * count;
+        if (more)
+            i++;
     }
 
-    return count;
+    return pos;
 }
 
 ogs_pkbuf_t *ogs_tlv_build_msg(ogs_tlv_desc_t *desc, void *msg, int mode)
 {
-    ogs_tlv_t *root = NULL;
-    uint32_t r, length, rendlen;
+    uint32_t length;
+    uint8_t *end;
     ogs_pkbuf_t *pkbuf = NULL;
 
     ogs_assert(desc);
@@ -264,51 +299,119 @@ ogs_pkbuf_t *ogs_tlv_build_msg(ogs_tlv_desc_t *desc, void *msg, int mode)
 
     ogs_assert(desc->ctype == OGS_TLV_MESSAGE);
     ogs_assert(desc->child_descs[0]);
-    
-    r = tlv_add_compound(&root, NULL, desc, msg, 0);
-    ogs_assert(r > 0 && root);
 
-    length = ogs_tlv_calc_length(root, mode);
+    length = tlv_calc_compound(desc, msg, 0, mode);
+    ogs_assert(length > 0);
+
     pkbuf = ogs_pkbuf_alloc(NULL, OGS_TLV_MAX_HEADROOM+length);
     ogs_assert(pkbuf);
     ogs_pkbuf_reserve(pkbuf, OGS_TLV_MAX_HEADROOM);
     ogs_pkbuf_put(pkbuf, length);
 
-    rendlen = ogs_tlv_render(root, pkbuf->data, length, mode);
-    ogs_assert(rendlen == length);
-
-    ogs_tlv_free_all(root);
+    end = tlv_put_compound(pkbuf->data, desc, msg, 0, mode);
+    ogs_assert(end == pkbuf->data + length);
 
     return pkbuf;
 }
 
+static uint8_t *tlv_get_element(
+        ogs_tlv_t *tlv, uint8_t *pos, uint8_t *end, uint8_t mode)
+{
+    switch (mode) {
+    case OGS_TLV_MODE_T1_L1:
+        if (end - pos < 2)
+            return NULL;
+        tlv->type = pos[0];
+        tlv->length = pos[1];
+        pos += 2;
+        break;
+    case OGS_TLV_MODE_T1_L2:
+        if (end - pos < 3)
+            return NULL;
+        tlv->type = pos[0];
+        tlv->length = (pos[1] << 8) + pos[2];
+        pos += 3;
+        break;
+    case OGS_TLV_MODE_T1_L2_I1:
+        if (end - pos < 4)
+            return NULL;
+        tlv->type = pos[0];
+        tlv->length = (pos[1] << 8) + pos[2];
+        tlv->instance = pos[3];
+        pos += 4;
+        break;
+    case OGS_TLV_MODE_T2_L2:
+        if (end - pos < 4)
+            return NULL;
+        tlv->type = (pos[0] << 8) + pos[1];
+        tlv->length = (pos[2] << 8) + pos[3];
+        pos += 4;
+        break;
+    default:
+        ogs_assert_if_reached();
+        return NULL;
+    }
+
+    if (end - pos < tlv->length)
+        return NULL;
+
+    tlv->value = pos;
+
+    return pos + tlv->length;
+}
+
+static uint32_t tlv_desc_vsize(ogs_tlv_desc_t *parent_desc, int i)
+{
+    ogs_tlv_desc_t *desc = parent_desc->child_descs[i];
+    ogs_tlv_desc_t *prev_desc = NULL;
+
+    if (desc->ctype != OGS_TLV_MORE)
+        return desc->vsize;
+
+    ogs_assert(i > 0);
+    prev_desc = parent_desc->child_descs[i-1];
+    ogs_assert(prev_desc && prev_desc->ctype != OGS_TLV_MORE);
+
+    return prev_desc->vsize * (desc->length - 1);
+}
+
+/*
+ * IEs are normally encoded in the order of the descriptor, so the search
+ * resumes from the previous match in desc_index/tlv_offset and wraps
+ * around only when an IE arrives out of order.
+ */
 static ogs_tlv_desc_t* tlv_find_desc(uint8_t *desc_index,
         uint32_t *tlv_offset, ogs_tlv_desc_t *parent_desc, ogs_tlv_t *tlv)
 {
-    ogs_tlv_desc_t *prev_desc = NULL, *desc = NULL;
-    int i, offset = 0;
+    ogs_tlv_desc_t *desc = NULL;
+    uint32_t offset;
+    int i;
 
     ogs_assert(parent_desc);
     ogs_assert(tlv);
 
-    for (i = 0, desc = parent_desc->child_descs[i]; desc != NULL;
-            i++, desc = parent_desc->child_descs[i]) {
-        if (desc->type == tlv->type && desc->instance == tlv->instance) {
-            *desc_index = i;
-            *tlv_offset = offset;
-            break;
-        }
-
-        if (desc->ctype == OGS_TLV_MORE) {
-            ogs_assert(prev_desc && prev_desc->ctype != OGS_TLV_MORE);
-            offset += prev_desc->vsize * (desc->length - 1);
-        } else {
-            offset += desc->vsize;
-        }
+    for (i = *desc_index, offset = *tlv_offset;
+            (desc = parent_desc->child_descs[i]) != NULL;
+            offset += tlv_desc_vsize(parent_desc, i), i++) {
+        if (desc->ctype != OGS_TLV_MORE &&
+            desc->type == tlv->type && desc->instance == tlv->instance)
+            goto found;
+    }
 
-        prev_desc = desc;
+    for (i = 0, offset = 0; i < *desc_index;
+            offset += tlv_desc_vsize(parent_desc, i), i++) {
+        desc = parent_desc->child_descs[i];
+        if (desc->ctype != OGS_TLV_MORE &&
+            desc->type == tlv->type && desc->instance == tlv->instance)
+            goto found;
     }
 
+    return NULL;
+
+found:
+    *desc_index = i;
+    *tlv_offset = offset;
+
     return desc;
 }
 
@@ -416,70 +519,70 @@ static int tlv_parse_leaf(void *msg, ogs_tlv_desc_t *desc, ogs_tlv_t *tlv)
     return OGS_OK;
 }
 
-static int tlv_parse_compound(void *msg, ogs_tlv_desc_t *parent_desc, 
-        ogs_tlv_t *parent_tlv, int depth, int mode)
+static int tlv_parse_compound(void *msg, ogs_tlv_desc_t *parent_desc,
+        uint8_t *blk, uint32_t length, int depth, int mode)
 {
     int rv;
-    ogs_tlv_presence_t *presence_p = (ogs_tlv_presence_t *)msg;
+    ogs_tlv_presence_t *presence_p = NULL;
     ogs_tlv_desc_t *desc = NULL, *next_desc = NULL;
-    ogs_tlv_t *tlv = NULL, *emb_tlv = NULL;
+    ogs_tlv_t tlv;
     uint8_t *p = msg;
-    uint32_t offset = 0;
+    uint8_t *pos = blk, *end = blk + length;
+    uint32_t offset = 0, slot = 0;
     uint8_t index = 0;
     int i = 0, j;
     char indent[17] = "                "; /* 16 spaces */
 
     ogs_assert(msg);
     ogs_assert(parent_desc);
-    ogs_assert(parent_tlv);
 
     ogs_assert(depth <= 8);
     indent[depth*2] = 0;
 
-    tlv = parent_tlv;
-    while (tlv) {
-        desc = tlv_find_desc(&index, &offset, parent_desc, tlv);
+    memset(&tlv, 0, sizeof(tlv));
+
+    while (pos < end) {
+        pos = tlv_get_element(&tlv, pos, end, mode);
+        if (pos == NULL) {
+            ogs_error("Truncated TLV");
+            return OGS_ERROR;
+        }
+
+        desc = tlv_find_desc(&index, &offset, parent_desc, &tlv);
         if (desc == NULL) {
-            ogs_error("Unexpected TLV type:%d", tlv->type);
+            ogs_error("Unexpected TLV type:%d", tlv.type);
             return OGS_ERROR;
         }
 
-        presence_p = (ogs_tlv_presence_t *)(p + offset);
+        slot = offset;
+        presence_p = (ogs_tlv_presence_t *)(p + slot);
 
         /* Multiple of the same type TLV may be included */
         next_desc = parent_desc->child_descs[index+1];
         if (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE) {
             for (j = 0; j < next_desc->length; j++) {
-                presence_p = 
+                presence_p =
                     (ogs_tlv_presence_t *)(p + offset + desc->vsize * j);
                 if (*presence_p == 0) {
-                    offset += desc->vsize * j;
+                    slot += desc->vsize * j;
                     break;
                 }
             }
             if (j == next_desc->length) {
                 ogs_fatal("Multiple of the same type TLV need more room");
                 ogs_assert_if_reached();
-                tlv = tlv->next;
                 continue;
             }
         }
 
         if (desc->ctype == OGS_TLV_COMPOUND) {
-            emb_tlv = ogs_tlv_parse_embedded_block(tlv, mode);
-            if (emb_tlv == NULL) {
-                ogs_error("Error while parse TLV");
-                return OGS_ERROR;
-            }
-
             ogs_trace("PARSE %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
-                    indent, i++, desc->name, desc->type, desc->instance, 
-                    desc->vsize, p + offset);
-
-            offset += sizeof(ogs_tlv_presence_t);
+                    indent, i++, desc->name, desc->type, desc->instance,
+                    desc->vsize, p + slot);
 
             rv = tlv_parse_compound(
-                    p + offset, desc, emb_tlv, depth + 1, mode);
+                    p + slot + sizeof(ogs_tlv_presence_t), desc,
+                    tlv.value, tlv.length, depth + 1, mode);
             if (rv != OGS_OK) {
                 ogs_error("Can't parse compound TLV");
                 return OGS_ERROR;
@@ -489,10 +592,10 @@ static int tlv_parse_compound(void *msg, ogs_tlv_desc_t *parent_desc,
         } else {
             ogs_trace("PARSE %sL#%d [%s] T:%d L:%d I:%d "
                     "(cls:%d vsz:%d) off:%p ",
-                    indent, i++, desc->name, desc->type, desc->length, 
-                    desc->instance, desc->ctype, desc->vsize, p + offset);
+                    indent, i++, desc->name, desc->type, desc->length,
+                    desc->instance, desc->ctype, desc->vsize, p + slot);
 
-            rv = tlv_parse_leaf(p + offset, desc, tlv);
+            rv = tlv_parse_leaf(p + slot, desc, &tlv);
             if (rv != OGS_OK) {
                 ogs_error("Can't parse leaf TLV");
                 return OGS_ERROR;
@@ -500,8 +603,6 @@ static int tlv_parse_compound(void *msg, ogs_tlv_desc_t *parent_desc,
 
             *presence_p = 1;
         }
-
-        tlv = tlv->next;
     }
 
     return OGS_OK;
@@ -510,9 +611,6 @@ static int tlv_parse_compound(void *msg, ogs_tlv_desc_t *parent_desc,
 int ogs_tlv_parse_msg(void *msg, ogs_tlv_desc_t *desc, ogs_pkbuf_t *pkbuf,
         int mode)
 {
-    int rv;
-    ogs_tlv_t *root;
-
     ogs_assert(msg);
     ogs_assert(desc);
     ogs_assert(pkbuf);
@@ -520,15 +618,6 @@ int ogs_tlv_parse_msg(void *msg, ogs_tlv_desc_t *desc, ogs_pkbuf_t *pkbuf,
     ogs_assert(desc->ctype == OGS_TLV_MESSAGE);
     ogs_assert(desc->child_descs[0]);
 
-    root = ogs_tlv_parse_block(pkbuf->len, pkbuf->data, mode);
-    if (root == NULL) {
-        ogs_error("Can't parse TLV message");
-        return OGS_ERROR;
-    }
-
-    rv = tlv_parse_compound(msg, desc, root, 0, mode);
-
-    ogs_tlv_free_all(root);
-
-    return rv;
+    /* Decode straight from the buffer without building an ogs_tlv_t list */
+    return tlv_parse_compound(msg, desc, pkbuf->data, pkbuf->len, 0, mode);
 }
@@ -50,6 +50,11 @@ ogs_sock_t *ogs_udp_server(ogs_socknode_t *node)
             rv = ogs_listen_reusable(new->fd);
             ogs_assert(rv == OGS_OK);
 
+            if (node->option.reuseport) {
+                rv = ogs_listen_reuseport(new->fd);
+                ogs_assert(rv == OGS_OK);
+            }
+
             if (ogs_sock_bind(new, addr) == OGS_OK) {
                 ogs_debug("udp_server() [%s]:%d",
                         OGS_ADDR(addr, buf), OGS_PORT(addr));
@@ -22,22 +22,22 @@
 #define os_memcmp memcmp
 #define os_memcmp_const memcmp
 
-int aes_128_encrypt_block(const uint8_t *key, 
-    const uint8_t *in, uint8_t *out);
-
-int aes_128_encrypt_block(const uint8_t *key, 
+/* K is expanded once per operation, not once per block */
+static int aes_128_encrypt_block(const ogs_aes_key_t *key,
     const uint8_t *in, uint8_t *out)
 {
-    const int key_bits = 128;
-    unsigned int rk[OGS_AES_RKLENGTH(128)];
-    int nrounds;
-
-    nrounds = ogs_aes_setup_enc(rk, key, key_bits);
-    ogs_aes_encrypt(rk, nrounds, in, out);
+    ogs_aes_key_encrypt(key, in, out);
 
     return 0;
 }
 
+static int f1(const uint8_t *opc, const ogs_aes_key_t *k,
+    const uint8_t *_rand, const uint8_t *sqn,
+    const uint8_t *amf, uint8_t *mac_a, uint8_t *mac_s);
+static int f2345(const uint8_t *opc, const ogs_aes_key_t *k,
+    const uint8_t *_rand, uint8_t *res, uint8_t *ck,
+    uint8_t *ik, uint8_t *ak, uint8_t *akstar);
+
 /**
  * milenage_f1 - Milenage f1 and f1* algorithms
  * @opc: OPc = 128-bit value derived from OP and K
@@ -52,6 +52,16 @@ int aes_128_encrypt_block(const uint8_t *key,
 int milenage_f1(const uint8_t *opc, const uint8_t *k, 
     const uint8_t *_rand, const uint8_t *sqn, 
     const uint8_t *amf, uint8_t *mac_a, uint8_t *mac_s)
+{
+    ogs_aes_key_t key;
+
+    ogs_aes_key_setup(&key, k, 128);
+    return f1(opc, &key, _rand, sqn, amf, mac_a, mac_s);
+}
+
+static int f1(const uint8_t *opc, const ogs_aes_key_t *k,
+    const uint8_t *_rand, const uint8_t *sqn,
+    const uint8_t *amf, uint8_t *mac_a, uint8_t *mac_s)
 {
 	uint8_t tmp1[16], tmp2[16], tmp3[16];
 	int i;
@@ -105,6 +115,16 @@ int milenage_f1(const uint8_t *opc, const uint8_t *k,
 int milenage_f2345(const uint8_t *opc, const uint8_t *k, 
     const uint8_t *_rand, uint8_t *res, uint8_t *ck, 
     uint8_t *ik, uint8_t *ak, uint8_t *akstar)
+{
+    ogs_aes_key_t key;
+
+    ogs_aes_key_setup(&key, k, 128);
+    return f2345(opc, &key, _rand, res, ck, ik, ak, akstar);
+}
+
+static int f2345(const uint8_t *opc, const ogs_aes_key_t *k,
+    const uint8_t *_rand, uint8_t *res, uint8_t *ck,
+    uint8_t *ik, uint8_t *ak, uint8_t *akstar)
 {
 	uint8_t tmp1[16], tmp2[16], tmp3[16];
 	int i;
@@ -195,13 +215,15 @@ void milenage_generate(const uint8_t *opc, const uint8_t *amf,
 {
 	int i;
 	uint8_t mac_a[8];
+	ogs_aes_key_t key;
 
 	if (*res_len < 8) {
 		*res_len = 0;
 		return;
 	}
-	if (milenage_f1(opc, k, _rand, sqn, amf, mac_a, NULL) ||
-	    milenage_f2345(opc, k, _rand, res, ck, ik, ak, NULL)) {
+	ogs_aes_key_setup(&key, k, 128);
+	if (f1(opc, &key, _rand, sqn, amf, mac_a, NULL) ||
+	    f2345(opc, &key, _rand, res, ck, ik, ak, NULL)) {
 		*res_len = 0;
 		return;
 	}
@@ -229,12 +251,14 @@ int milenage_auts(const uint8_t *opc, const uint8_t *k,
 	uint8_t amf[2] = { 0x00, 0x00 }; /* TS 33.102 v7.0.0, 6.3.3 */
 	uint8_t ak[6], mac_s[8];
 	int i;
+	ogs_aes_key_t key;
 
-	if (milenage_f2345(opc, k, _rand, NULL, NULL, NULL, NULL, ak))
+	ogs_aes_key_setup(&key, k, 128);
+	if (f2345(opc, &key, _rand, NULL, NULL, NULL, NULL, ak))
 		return -1;
 	for (i = 0; i < 6; i++)
 		sqn[i] = auts[i] ^ ak[i];
-	if (milenage_f1(opc, k, _rand, sqn, amf, NULL, mac_s) ||
+	if (f1(opc, &key, _rand, sqn, amf, NULL, mac_s) ||
 	    os_memcmp_const(mac_s, auts + 6, 8) != 0)
 		return -1;
 	return 0;
@@ -294,13 +318,15 @@ int milenage_check(const uint8_t *opc, const uint8_t *k,
 	int i;
 	uint8_t mac_a[8], ak[6], rx_sqn[6];
 	const uint8_t *amf;
+	ogs_aes_key_t key;
 
     ogs_log_print(OGS_LOG_INFO, "Milenage: AUTN\n");
     ogs_log_hexdump(OGS_LOG_INFO, autn, 16);
     ogs_log_print(OGS_LOG_INFO, "Milenage: RAND\n");
     ogs_log_hexdump(OGS_LOG_INFO, _rand, 16);
 
-	if (milenage_f2345(opc, k, _rand, res, ck, ik, ak, NULL))
+	ogs_aes_key_setup(&key, k, 128);
+	if (f2345(opc, &key, _rand, res, ck, ik, ak, NULL))
 		return -1;
 
 	*res_len = 8;
@@ -321,13 +347,13 @@ int milenage_check(const uint8_t *opc, const uint8_t *k,
 
 	if (os_memcmp(rx_sqn, sqn, 6) <= 0) {
 		uint8_t auts_amf[2] = { 0x00, 0x00 }; /* TS 33.102 v7.0.0, 6.3.3 */
-		if (milenage_f2345(opc, k, _rand, NULL, NULL, NULL, NULL, ak))
+		if (f2345(opc, &key, _rand, NULL, NULL, NULL, NULL, ak))
 			return -1;
         ogs_log_print(OGS_LOG_INFO, "Milenage: AK*\n");
         ogs_log_hexdump(OGS_LOG_INFO, ak, 6);
 		for (i = 0; i < 6; i++)
 			auts[i] = sqn[i] ^ ak[i];
-		if (milenage_f1(opc, k, _rand, sqn, auts_amf, NULL, auts + 6))
+		if (f1(opc, &key, _rand, sqn, auts_amf, NULL, auts + 6))
 			return -1;
         ogs_log_print(OGS_LOG_INFO, "Milenage: AUTS*\n");
         ogs_log_hexdump(OGS_LOG_INFO, auts, 14);
@@ -337,7 +363,7 @@ int milenage_check(const uint8_t *opc, const uint8_t *k,
 	amf = autn + 6;
     ogs_log_print(OGS_LOG_INFO, "Milenage: AMF\n");
     ogs_log_hexdump(OGS_LOG_INFO, amf, 2);
-	if (milenage_f1(opc, k, _rand, rx_sqn, amf, mac_a, NULL))
+	if (f1(opc, &key, _rand, rx_sqn, amf, mac_a, NULL))
 		return -1;
 
     ogs_log_print(OGS_LOG_INFO, "Milenage: MAC_A\n");
@@ -355,9 +381,11 @@ int milenage_check(const uint8_t *opc, const uint8_t *k,
 
 void milenage_opc(const uint8_t *k, const uint8_t *op,  uint8_t *opc)
 {
+    ogs_aes_key_t key;
     int i;
 
-    aes_128_encrypt_block(k,  op, opc);
+    ogs_aes_key_setup(&key, k, 128);
+    aes_128_encrypt_block(&key, op, opc);
 
     for (i = 0; i < 16; i++)
     {
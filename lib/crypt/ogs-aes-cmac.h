@@ -28,6 +28,15 @@
 extern "C" {
 #endif
 
+/* AES-128 key and CMAC subkeys, expanded once per key */
+typedef struct ogs_aes_cmac_key_s {
+    ogs_aes_key_t aes;
+    uint8_t k1[16];
+    uint8_t k2[16];
+} ogs_aes_cmac_key_t;
+
+int ogs_aes_cmac_setup(ogs_aes_cmac_key_t *key, const uint8_t *k);
+
 /**
  * Caculate CMAC value
  *
@@ -41,6 +50,8 @@ extern "C" {
  */
 int ogs_aes_cmac_calculate(uint8_t *cmac, const uint8_t *key,
         const uint8_t *msg, const uint32_t len);
+int ogs_aes_cmac_calculate_key(uint8_t *cmac, const ogs_aes_cmac_key_t *key,
+        const uint8_t *msg, const uint32_t len);
 
 /**
  * Verify CMAC value
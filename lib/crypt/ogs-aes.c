@@ -19,6 +19,13 @@
 
 #include "ogs-crypt.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define OGS_USE_AESNI 1
+#include <cpuid.h>
+#include <wmmintrin.h>
+#endif
+
 #define FULL_UNROLL
 
 static const uint32_t Te0[256] =
@@ -1221,6 +1228,79 @@ void ogs_aes_decrypt(const uint32_t *rk, int nrounds, const uint8_t ciphertext[1
   PUTU32(plaintext + 12, s3);
 }
 
+#if OGS_USE_AESNI
+/*
+ * AES-NI takes the same round keys as the table-based code,
+ * only stored in byte order.
+ */
+__attribute__((target("aes,sse2")))
+static void aesni_encrypt(const uint32_t *rk, int nrounds,
+        const uint8_t in[16], uint8_t out[16])
+{
+    const __m128i *k = (const __m128i *)rk;
+    __m128i s;
+    int i;
+
+    s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)in),
+            _mm_loadu_si128(k));
+    for (i = 1; i < nrounds; i++)
+        s = _mm_aesenc_si128(s, _mm_loadu_si128(k + i));
+    s = _mm_aesenclast_si128(s, _mm_loadu_si128(k + nrounds));
+
+    _mm_storeu_si128((__m128i *)out, s);
+}
+
+static int aesni_supported(void)
+{
+    static int supported = -1;
+    unsigned int eax, ebx, ecx, edx;
+
+    if (supported < 0)
+        supported = __get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+                    (ecx & bit_AES) && (edx & bit_SSE2);
+
+    return supported;
+}
+#endif
+
+/**
+ * Expand the cipher key once so that it can be used for many blocks.
+ * AES-NI is used if the CPU supports it.
+ */
+int ogs_aes_key_setup(ogs_aes_key_t *key, const uint8_t *k, int keybits)
+{
+    ogs_assert(key);
+    ogs_assert(k);
+
+    key->nrounds = ogs_aes_setup_enc(key->rk, k, keybits);
+    key->aesni = 0;
+
+#if OGS_USE_AESNI
+    if (aesni_supported()) {
+        int i;
+        for (i = 0; i < 4 * (key->nrounds + 1); i++) {
+            uint32_t w = key->rk[i];
+            PUTU32((uint8_t *)&key->rk[i], w);
+        }
+        key->aesni = 1;
+    }
+#endif
+
+    return key->nrounds;
+}
+
+void ogs_aes_key_encrypt(const ogs_aes_key_t *key,
+        const uint8_t plaintext[16], uint8_t ciphertext[16])
+{
+#if OGS_USE_AESNI
+    if (key->aesni) {
+        aesni_encrypt(key->rk, key->nrounds, plaintext, ciphertext);
+        return;
+    }
+#endif
+    ogs_aes_encrypt(key->rk, key->nrounds, plaintext, ciphertext);
+}
+
 int ogs_aes_cbc_encrypt(const uint8_t *key, const uint32_t keybits,
         uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
         uint8_t *out, uint32_t *outlen)
@@ -1229,8 +1309,7 @@ int ogs_aes_cbc_encrypt(const uint8_t *key, const uint32_t keybits,
     uint32_t len = inlen;
     const uint8_t *iv = ivec;
 
-    uint32_t rk[OGS_AES_RKLENGTH(OGS_AES_MAX_KEY_BITS)];
-    int nrounds;
+    ogs_aes_key_t aes;
 
     ogs_assert(key);
     ogs_assert(keybits >= 128);
@@ -1247,13 +1326,13 @@ int ogs_aes_cbc_encrypt(const uint8_t *key, const uint32_t keybits,
 
     *outlen = ((inlen - 1) / OGS_AES_BLOCK_SIZE + 1) * OGS_AES_BLOCK_SIZE;
 
-    nrounds = ogs_aes_setup_enc(rk, key, keybits);
+    ogs_aes_key_setup(&aes, key, keybits);
 
     while (len >= OGS_AES_BLOCK_SIZE)
     {
         for(n=0; n < OGS_AES_BLOCK_SIZE; ++n)
             out[n] = in[n] ^ iv[n];
-        ogs_aes_encrypt(rk, nrounds, out, out);
+        ogs_aes_key_encrypt(&aes, out, out);
         iv = out;
         len -= OGS_AES_BLOCK_SIZE;
         in += OGS_AES_BLOCK_SIZE;
@@ -1266,7 +1345,7 @@ int ogs_aes_cbc_encrypt(const uint8_t *key, const uint32_t keybits,
             out[n] = in[n] ^ iv[n];
         for(n=len; n < OGS_AES_BLOCK_SIZE; ++n)
             out[n] = iv[n];
-        ogs_aes_encrypt(rk, nrounds, out, out);
+        ogs_aes_key_encrypt(&aes, out, out);
         iv = out;
     }
 
@@ -1399,13 +1478,22 @@ static void ctr128_inc_aligned(uint8_t *counter)
 int ogs_aes_ctr128_encrypt(const uint8_t *key,
         uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
         uint8_t *out)
+{
+    ogs_aes_key_t aes;
+
+    ogs_assert(key);
+
+    ogs_aes_key_setup(&aes, key, 128);
+    return ogs_aes_ctr128_encrypt_key(&aes, ivec, in, inlen, out);
+}
+
+int ogs_aes_ctr128_encrypt_key(const ogs_aes_key_t *key,
+        uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
+        uint8_t *out)
 {
     uint8_t ecount_buf[16];
     uint32_t len = inlen;
 
-    uint32_t rk[OGS_AES_RKLENGTH(OGS_AES_MAX_KEY_BITS)];
-    int nrounds;
-
     uint32_t n = 0;
     size_t l = 0;
 
@@ -1416,7 +1504,6 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
     ogs_assert(out);
 
     memset(ecount_buf, 0, 16);
-    nrounds = ogs_aes_setup_enc(rk, key, 128);
 
     while (n && len) 
     {
@@ -1427,7 +1514,7 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
 
     while (len >= 16) 
     {
-        ogs_aes_encrypt(rk, nrounds, ivec, ecount_buf);
+        ogs_aes_key_encrypt(key, ivec, ecount_buf);
         ctr128_inc_aligned(ivec);
         for (n = 0; n < 16; n += sizeof(size_t))
             *(size_t *)(out + n) =
@@ -1439,7 +1526,7 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
     }
     if (len) 
     {
-        ogs_aes_encrypt(rk, nrounds, ivec, ecount_buf);
+        ogs_aes_key_encrypt(key, ivec, ecount_buf);
         ctr128_inc_aligned(ivec);
         while (len--) 
         {
@@ -1454,7 +1541,7 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
     {
         if (n == 0) 
         {
-            ogs_aes_encrypt(rk, nrounds, ivec, ecount_buf);
+            ogs_aes_key_encrypt(key, ivec, ecount_buf);
             ctr128_inc(ivec);
         }
         out[l] = in[l] ^ ecount_buf[n];
@@ -35,6 +35,13 @@ extern "C" {
 #define OGS_AES_RKLENGTH(keybits)  ((keybits)/8+28)
 #define OGS_AES_NROUNDS(keybits)   ((keybits)/32+6)
 
+/* Expanded encryption key, reusable for any number of blocks */
+typedef struct ogs_aes_key_s {
+    uint32_t rk[OGS_AES_RKLENGTH(OGS_AES_MAX_KEY_BITS)];
+    int nrounds;
+    int aesni;          /* rk is laid out for AES-NI */
+} ogs_aes_key_t;
+
 int ogs_aes_setup_enc(uint32_t *rk, const uint8_t *key, int keybits);
 int ogs_aes_setup_dec(uint32_t *rk, const uint8_t *key, int keybits);
 
@@ -43,6 +50,10 @@ void ogs_aes_encrypt(const uint32_t *rk, int nrounds,
 void ogs_aes_decrypt(const uint32_t *rk, int nrounds,
         const uint8_t ciphertext[16], uint8_t plaintext[16]);
 
+int ogs_aes_key_setup(ogs_aes_key_t *key, const uint8_t *k, int keybits);
+void ogs_aes_key_encrypt(const ogs_aes_key_t *key,
+        const uint8_t plaintext[16], uint8_t ciphertext[16]);
+
 int ogs_aes_cbc_encrypt(const uint8_t *key,
         const uint32_t keybits, uint8_t *ivec,
         const uint8_t *in, const uint32_t inlen,
@@ -55,6 +66,9 @@ int ogs_aes_cbc_decrypt(const uint8_t *key,
 int ogs_aes_ctr128_encrypt(const uint8_t *key,
         uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
         uint8_t *out);
+int ogs_aes_ctr128_encrypt_key(const ogs_aes_key_t *key,
+        uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
+        uint8_t *out);
 
 #ifdef __cplusplus
 }
@@ -15,6 +15,13 @@ typedef uint8_t u8;
 typedef uint32_t u32;
 typedef uint64_t u64;
 
+/* SNOW 3G state, so that several threads can run f8/f9 at once */
+typedef struct snow_3g_ctx_s {
+    u32 s[16];          /* LFSR, S0 is s[i] */
+    u32 i;
+    u32 r1, r2, r3;     /* FSM */
+} snow_3g_ctx_t;
+
 /* Initialization.
 * Input k[4]: Four 32-bit words making up 128-bit key.
 * Input IV[4]: Four 32-bit words making 128-bit initialization variable.
@@ -22,7 +29,7 @@ typedef uint64_t u64;
 * See Section 4.1.
 */
 
-void snow_3g_initialize(u32 k[4], u32 IV[4]);
+void snow_3g_initialize(snow_3g_ctx_t *ctx, u32 k[4], u32 IV[4]);
 
 /* Generation of Keystream.
 * input n: number of 32-bit words of keystream.
@@ -32,7 +39,7 @@ void snow_3g_initialize(u32 k[4], u32 IV[4]);
 * See section 4.2.
 */
 
-void snow_3g_generate_key_stream(u32 n, u32 *z);
+void snow_3g_generate_key_stream(snow_3g_ctx_t *ctx, u32 n, u32 *z);
 
 /* f8.
 * Input key: 128 bit Confidentiality Key.
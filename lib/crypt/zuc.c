@@ -1,53 +1,18 @@
 /*---------------------------------------------
  * ZUC / EEA3 / EIA3 : LTE security algorithm
+ *
+ * Reentrant version of the reference code: the state lives in zuc_ctx_t,
+ * keystream is consumed a word at a time and EIA3 slides a 64-bit window
+ * of keystream over each message word instead of going bit by bit.
  *--------------------------------------------*/
 #include "zuc.h"
 
-u32 AddM(u32 a, u32 b);
-void LFSRWithInitialisationMode(u32 u);
-void LFSRWithWorkMode(void);
-void BitReorganization(void);
-u32 L1(u32 X);
-u32 L2(u32 X);
-u32 F(void);
-void ZUC(u8* k, u8* iv, u32* ks, u32 len);
-u32 GET_WORD(u32 * DATA, u32 i);
-u8 GET_BIT(u8 * DATA, u32 i);
-
 /*--------------------------------------------
  * ZUC keystream generator algorithm
  *------------------------------------------*/
 
-/* the state registers of LFSR */ 
-static u32 LFSR_S0;
-static u32 LFSR_S1;
-static u32 LFSR_S2;
-static u32 LFSR_S3;
-static u32 LFSR_S4;
-static u32 LFSR_S5;
-static u32 LFSR_S6;
-static u32 LFSR_S7;
-static u32 LFSR_S8;
-static u32 LFSR_S9;
-static u32 LFSR_S10;
-static u32 LFSR_S11;
-static u32 LFSR_S12;
-static u32 LFSR_S13;
-static u32 LFSR_S14;
-static u32 LFSR_S15;
-
-/* the registers of F */
-static u32 F_R1;
-static u32 F_R2;
-
-/* the outputs of BitReorganization */
-static u32 BRC_X0;
-static u32 BRC_X1;
-static u32 BRC_X2;
-static u32 BRC_X3;
-
 /* the s-boxes */ 
-static u8 S0[256] = {
+static const u8 S0[256] = {
 0x3e,0x72,0x5b,0x47,0xca,0xe0,0x00,0x33,0x04,0xd1,0x54,0x98,0x09,0xb9,0x6d,0xcb,
 0x7b,0x1b,0xf9,0x32,0xaf,0x9d,0x6a,0xa5,0xb8,0x2d,0xfc,0x1d,0x08,0x53,0x03,0x90,
 0x4d,0x4e,0x84,0x99,0xe4,0xce,0xd9,0x91,0xdd,0xb6,0x85,0x48,0x8b,0x29,0x6e,0xac,
@@ -66,7 +31,7 @@ static u8 S0[256] = {
 0x8d,0x27,0x1a,0xdb,0x81,0xb3,0xa0,0xf4,0x45,0x7a,0x19,0xdf,0xee,0x78,0x34,0x60
 }; 
 
-static u8 S1[256] =  {
+static const u8 S1[256] =  {
 0x55,0xc2,0x63,0x71,0x3b,0xc8,0x47,0x86,0x9f,0x3c,0xda,0x5b,0x29,0xaa,0xfd,0x77,
 0x8c,0xc5,0x94,0x0c,0xa6,0x1a,0x13,0x00,0xe3,0xa8,0x16,0x72,0x40,0xf9,0xf8,0x42,
 0x44,0x26,0x68,0x96,0x81,0xd9,0x45,0x3e,0x10,0x76,0xc6,0xa7,0x8b,0x39,0x43,0xe1,
@@ -86,197 +51,131 @@ static u8 S1[256] =  {
 };
  
 /* the constants D */
-static u32 EK_d[16] = {
+static const u32 EK_d[16] = {
 0x44D7, 0x26BC, 0x626B, 0x135E, 0x5789, 0x35E2, 0x7135, 0x09AF,
 0x4D78, 0x2F13, 0x6BC4, 0x1AF1, 0x5E26, 0x3C4D, 0x789A, 0x47AC
 };
 
-/* - */ 
-/* c = a + b mod (2^31  1) */
-u32 AddM(u32 a, u32 b)
+/* c = a + b mod (2^31 - 1) */
+static u32 AddM(u32 a, u32 b)
 {
 	u32 c = a + b;
 	return (c & 0x7FFFFFFF) + (c >> 31);
 }
 
-/* LFSR with initialization mode */
+/* LFSR with initialization mode (u = W >> 1) or work mode (u = 0) */
 #define MulByPow2(x, k) ((((x) << k) | ((x) >> (31 - k))) & 0x7FFFFFFF)
-void LFSRWithInitialisationMode(u32 u)
+static void LFSRClock(zuc_ctx_t *ctx, u32 u)
 {
 	u32 f, v;
-	f = LFSR_S0;
-	
-	v = MulByPow2(LFSR_S0, 8);
-	f = AddM(f, v);
-	v = MulByPow2(LFSR_S4, 20);
-	f = AddM(f, v);
-	v = MulByPow2(LFSR_S10, 21);
-	f = AddM(f, v);
-	v = MulByPow2(LFSR_S13, 17);
-	f = AddM(f, v);
-	v = MulByPow2(LFSR_S15, 15);
-	f = AddM(f, v);
-	
-	f = AddM(f, u);
-	
-	/* update the state */
-	LFSR_S0 = LFSR_S1;
-	LFSR_S1 = LFSR_S2;
-	LFSR_S2 = LFSR_S3;
-	LFSR_S3 = LFSR_S4;
-	LFSR_S4 = LFSR_S5;
-	LFSR_S5 = LFSR_S6;
-	LFSR_S6 = LFSR_S7;
-	LFSR_S7 = LFSR_S8;
-	LFSR_S8 = LFSR_S9;
-	LFSR_S9 = LFSR_S10;
-	LFSR_S10 = LFSR_S11;
-	LFSR_S11 = LFSR_S12;
-	LFSR_S12 = LFSR_S13;
-	LFSR_S13 = LFSR_S14;
-	LFSR_S14 = LFSR_S15;
-	LFSR_S15 = f;
-}
+	f = ctx->s[0];
 
-/* LFSR with work mode */
-void LFSRWithWorkMode(void)
-{
-	u32 f, v;
-	f = LFSR_S0;
-	
-	v = MulByPow2(LFSR_S0, 8);
+	v = MulByPow2(ctx->s[0], 8);
 	f = AddM(f, v);
-	v = MulByPow2(LFSR_S4, 20);
+	v = MulByPow2(ctx->s[4], 20);
 	f = AddM(f, v);
-	v = MulByPow2(LFSR_S10, 21);
+	v = MulByPow2(ctx->s[10], 21);
 	f = AddM(f, v);
-	v = MulByPow2(LFSR_S13, 17);
+	v = MulByPow2(ctx->s[13], 17);
 	f = AddM(f, v);
-	v = MulByPow2(LFSR_S15, 15);
+	v = MulByPow2(ctx->s[15], 15);
 	f = AddM(f, v);
-	
+
+	if (u)
+		f = AddM(f, u);
+
 	/* update the state */
-	LFSR_S0 = LFSR_S1;
-	LFSR_S1 = LFSR_S2;
-	LFSR_S2 = LFSR_S3;
-	LFSR_S3 = LFSR_S4;
-	LFSR_S4 = LFSR_S5;
-	LFSR_S5 = LFSR_S6;
-	LFSR_S6 = LFSR_S7;
-	LFSR_S7 = LFSR_S8;
-	LFSR_S8 = LFSR_S9;
-	LFSR_S9 = LFSR_S10;
-	LFSR_S10 = LFSR_S11;
-	LFSR_S11 = LFSR_S12;
-	LFSR_S12 = LFSR_S13;
-	LFSR_S13 = LFSR_S14;
-	LFSR_S14 = LFSR_S15;
-	LFSR_S15 = f;
+	memmove(ctx->s, ctx->s + 1, 15 * sizeof(u32));
+	ctx->s[15] = f;
 }
 
 /* BitReorganization */
-void BitReorganization(void)
+static void BitReorganization(zuc_ctx_t *ctx)
 {
-	BRC_X0 = ((LFSR_S15 & 0x7FFF8000) << 1) | (LFSR_S14 & 0xFFFF);
-	BRC_X1 = ((LFSR_S11 & 0xFFFF) << 16) | (LFSR_S9 >> 15);
-	BRC_X2 = ((LFSR_S7 & 0xFFFF) << 16) | (LFSR_S5 >> 15);
-	BRC_X3 = ((LFSR_S2 & 0xFFFF) << 16) | (LFSR_S0 >> 15);
+	ctx->x0 = ((ctx->s[15] & 0x7FFF8000) << 1) | (ctx->s[14] & 0xFFFF);
+	ctx->x1 = ((ctx->s[11] & 0xFFFF) << 16) | (ctx->s[9] >> 15);
+	ctx->x2 = ((ctx->s[7] & 0xFFFF) << 16) | (ctx->s[5] >> 15);
+	ctx->x3 = ((ctx->s[2] & 0xFFFF) << 16) | (ctx->s[0] >> 15);
 }
 
 #define ROT(a, k) (((a) << k) | ((a) >> (32 - k)))
 
 /* L1 */
-u32 L1(u32 X)
+static u32 L1(u32 X)
 {
 	return (X ^ ROT(X, 2) ^ ROT(X, 10) ^ ROT(X, 18) ^ ROT(X, 24));
 }
 
 /* L2 */
-u32 L2(u32 X)
+static u32 L2(u32 X)
 {
 	return (X ^ ROT(X, 8) ^ ROT(X, 14) ^ ROT(X, 22) ^ ROT(X, 30));
 }
 
 #define MAKEU32(a, b, c, d) (((u32)(a) << 24) | ((u32)(b) << 16) | ((u32)(c) << 8) | ((u32)(d)))
 /* F */
-u32 F(void)
+static u32 F(zuc_ctx_t *ctx)
 {
 	u32 W, W1, W2, u, v;
-	
-	W  = (BRC_X0 ^ F_R1) + F_R2;
-	W1 = F_R1 + BRC_X1;
-	W2 = F_R2 ^ BRC_X2;
-	
+
+	W  = (ctx->x0 ^ ctx->r1) + ctx->r2;
+	W1 = ctx->r1 + ctx->x1;
+	W2 = ctx->r2 ^ ctx->x2;
+
 	u = L1((W1 << 16) | (W2 >> 16));
 	v = L2((W2 << 16) | (W1 >> 16));
-	
-	F_R1 = MAKEU32(S0[u >> 24], S1[(u >> 16) & 0xFF],
+
+	ctx->r1 = MAKEU32(S0[u >> 24], S1[(u >> 16) & 0xFF],
 	S0[(u >> 8) & 0xFF], S1[u & 0xFF]);
-	F_R2 = MAKEU32(S0[v >> 24], S1[(v >> 16) & 0xFF],
+	ctx->r2 = MAKEU32(S0[v >> 24], S1[(v >> 16) & 0xFF],
 	S0[(v >> 8) & 0xFF], S1[v & 0xFF]);
-	
+
 	return W;
 }
 
 #define MAKEU31(a, b, c) (((u32)(a) << 23) | ((u32)(b) << 8) | (u32)(c))
-/* initialize */
-void zuc_initialize(u8* k, u8* iv)
+/* initialize, including the first, discarded output of F */
+void zuc_initialize(zuc_ctx_t *ctx, u8* k, u8* iv)
 {
 	u32 w, nCount;
 
 	/* expand key */
-	LFSR_S0 = MAKEU31(k[0], EK_d[0], iv[0]);
-	LFSR_S1 = MAKEU31(k[1], EK_d[1], iv[1]);
-	LFSR_S2 = MAKEU31(k[2], EK_d[2], iv[2]);
-	LFSR_S3 = MAKEU31(k[3], EK_d[3], iv[3]);
-	LFSR_S4 = MAKEU31(k[4], EK_d[4], iv[4]);
-	LFSR_S5 = MAKEU31(k[5], EK_d[5], iv[5]);
-	LFSR_S6 = MAKEU31(k[6], EK_d[6], iv[6]);
-	LFSR_S7 = MAKEU31(k[7], EK_d[7], iv[7]);
-	LFSR_S8 = MAKEU31(k[8], EK_d[8], iv[8]);
-	LFSR_S9 = MAKEU31(k[9], EK_d[9], iv[9]);
-	LFSR_S10 = MAKEU31(k[10], EK_d[10], iv[10]);
-	LFSR_S11 = MAKEU31(k[11], EK_d[11], iv[11]);
-	LFSR_S12 = MAKEU31(k[12], EK_d[12], iv[12]);
-	LFSR_S13 = MAKEU31(k[13], EK_d[13], iv[13]);
-	LFSR_S14 = MAKEU31(k[14], EK_d[14], iv[14]);
-	LFSR_S15 = MAKEU31(k[15], EK_d[15], iv[15]);
+	for (nCount = 0; nCount < 16; nCount++)
+		ctx->s[nCount] = MAKEU31(k[nCount], EK_d[nCount], iv[nCount]);
 
 	/* set F_R1 and F_R2 to zero */
-	F_R1 = 0;
-	F_R2 = 0;
+	ctx->r1 = 0;
+	ctx->r2 = 0;
 	nCount = 32;
 	while (nCount > 0)
 	{
-		BitReorganization();
-		w = F();
-		LFSRWithInitialisationMode(w >> 1);
+		BitReorganization(ctx);
+		w = F(ctx);
+		LFSRClock(ctx, w >> 1);
 		nCount --;
 	}
+
+	BitReorganization(ctx);
+	F(ctx); 			/* discard the output of F */
+	LFSRClock(ctx, 0);
 }
 
-void zuc_generate_key_stream(u32* pKeystream, u32 KeystreamLen)
+static u32 zuc_next(zuc_ctx_t *ctx)
 {
-	int i;
-	BitReorganization();
-	F(); 			/* discard the output of F */
-	LFSRWithWorkMode();
-	
-	for (i = 0; i < KeystreamLen; i ++)
-	{
-		BitReorganization();
-		pKeystream[i] = F() ^ BRC_X3;
-		LFSRWithWorkMode();
-	}
+	u32 z;
+
+	BitReorganization(ctx);
+	z = F(ctx) ^ ctx->x3;
+	LFSRClock(ctx, 0);
+	return z;
 }
 
-/* The ZUC algorithm, see ref. [3]*/
-void ZUC(u8* k, u8* iv, u32* ks, u32 len)
+void zuc_generate_key_stream(zuc_ctx_t *ctx, u32* pKeystream, u32 KeystreamLen)
 {
-	/* The initialization of ZUC, see page 17 of ref. [3]*/
-	zuc_initialize(k, iv);
-	/*  The procedure of generating keystream of ZUC, see page 18 of ref. [3]*/
-	zuc_generate_key_stream(ks, len);
+	u32 i;
+
+	for (i = 0; i < KeystreamLen; i ++)
+		pKeystream[i] = zuc_next(ctx);
 }
 /* end of ZUC.c */
 
@@ -291,49 +190,54 @@ void ZUC(u8* k, u8* iv, u32* ks, u32 len)
 void zuc_eea3(u8* CK, u32 COUNT, u32 BEARER, u32 DIRECTION, 
 				   u32 LENGTH, u8* M, u8* C)
 {
-	u32 *z, L, L8, i;
+	zuc_ctx_t ctx;
+	u32 z, L8, i;
 	u8 	IV[16];
 	u32 lastbits = (8-(LENGTH%8))%8;
-    
-	L 	= (LENGTH+31)/32;
-	z 	= (u32 *) ogs_malloc(L*sizeof(u32));
-    
+
 	L8 	= (LENGTH+7)/8;
-	
+
 	IV[0]	= (COUNT>>24) & 0xFF;
 	IV[1]	= (COUNT>>16) & 0xFF;
 	IV[2]	= (COUNT>>8)  & 0xFF;
 	IV[3]	=  COUNT      & 0xFF;
-	
+
 	IV[4]	= ((BEARER << 3) | ((DIRECTION&1)<<2)) & 0xFC;
 	IV[5]	= 0;
 	IV[6]	= 0;
 	IV[7]	= 0;
-	
+
 	IV[8]	= IV[0];
 	IV[9]	= IV[1];
 	IV[10]	= IV[2];
 	IV[11]	= IV[3];
-	
+
 	IV[12]	= IV[4];
 	IV[13]	= IV[5];
 	IV[14]	= IV[6];
 	IV[15]	= IV[7];
-	
-	ZUC(CK, IV, z, L);
-	
-	for (i=0; i<L8; i++)
-    {
-		C[i] = M[i] ^ ((z[i/4] >> (3-i%4)*8) & 0xff);
-    }
+
+	zuc_initialize(&ctx, CK, IV);
+
+	for (i = 0; i + 4 <= L8; i += 4)
+	{
+		z = zuc_next(&ctx);
+		C[i+0] = M[i+0] ^ (u8)(z >> 24);
+		C[i+1] = M[i+1] ^ (u8)(z >> 16);
+		C[i+2] = M[i+2] ^ (u8)(z >> 8);
+		C[i+3] = M[i+3] ^ (u8)z;
+	}
+	if (i < L8)
+	{
+		z = zuc_next(&ctx);
+		for (; i < L8; i++, z <<= 8)
+			C[i] = M[i] ^ (u8)(z >> 24);
+	}
 
 	/* zero last bits of data in case its length is not  word-aligned (32 bits)
 	   this is an addition to the C reference code, which did not handle it */
 	if (lastbits)
-        i--;
-		C[i] &= 0x100 - (1<<lastbits);
-	
-	ogs_free(z);
+		C[L8-1] &= 0x100 - (1<<lastbits);
 }
 /* end of EEA3.c */
 
@@ -345,60 +249,73 @@ void zuc_eea3(u8* CK, u32 COUNT, u32 BEARER, u32 DIRECTION,
  * EIA3: LTE Integrity computation algorithm
  * EIA3.c
 */
-u32 GET_WORD(u32 * DATA, u32 i)
-{
-	u32 WORD, ti;
-	ti	= i % 32;
-	if (ti == 0)
-		WORD = DATA[i/32];
-	else
-		WORD = (DATA[i/32]<<ti) | (DATA[i/32+1]>>(32-ti));
-	return WORD;
-}
 
-u8 GET_BIT(u8 * DATA, u32 i)
+/* XOR of GET_WORD(z, 32k + j) for every bit j set in message word m,
+ * where window holds keystream words z[k] and z[k+1] */
+static u32 eia3_word(u32 m, uint64_t window)
 {
-	return (DATA[i/8] & (1<<(7-(i%8)))) ? 1 : 0;
+	u32 T = 0;
+	int j;
+
+	for (j = 0; j < 32; j++)
+		T ^= (u32)(window >> (32 - j)) & (0 - ((m >> (31 - j)) & 1));
+	return T;
 }
 
 void zuc_eia3(u8* IK, u32 COUNT, u32 BEARER, u32 DIRECTION,
 				   u32 LENGTH, u8* M, u32* MAC)
 {
-	u32	*z, N, L, T, i;
+	zuc_ctx_t ctx;
+	u32 T, i, m, rem;
+	uint64_t window;
 	u8 IV[16];
 
 	IV[0]	= (COUNT>>24) & 0xFF;
 	IV[1]	= (COUNT>>16) & 0xFF;
 	IV[2]	= (COUNT>>8) & 0xFF;
 	IV[3]	= COUNT & 0xFF;
-	
+
 	IV[4]	= (BEARER << 3) & 0xF8;
 	IV[5]	= IV[6] = IV[7] = 0;
-	
+
 	IV[8]	= ((COUNT>>24) & 0xFF) ^ ((DIRECTION&1)<<7);
 	IV[9]	= (COUNT>>16) & 0xFF;
 	IV[10]	= (COUNT>>8) & 0xFF;
 	IV[11]	= COUNT & 0xFF;
-	
+
 	IV[12]	= IV[4];
 	IV[13]	= IV[5];
 	IV[14]	= IV[6] ^ ((DIRECTION&1)<<7);
 	IV[15]	= IV[7];
-	
-	N	= LENGTH + 64;
-	L	= (N + 31) / 32;
-	z	= (u32 *) ogs_malloc(L*sizeof(u32));
-	ZUC(IK, IV, z, L);
-	
+
+	zuc_initialize(&ctx, IK, IV);
+
+	window = (uint64_t)zuc_next(&ctx) << 32;
+	window |= zuc_next(&ctx);
+
 	T = 0;
-	for (i=0; i<LENGTH; i++) {
-		if (GET_BIT(M,i)) {
-			T ^= GET_WORD(z,i);
-		}
+	for (i = 0; i < LENGTH / 32; i++, M += 4) {
+		m = MAKEU32(M[0], M[1], M[2], M[3]);
+		T ^= eia3_word(m, window);
+		window = (window << 32) | zuc_next(&ctx);
+	}
+
+	rem = LENGTH % 32;
+	if (rem) {
+		m = 0;
+		for (i = 0; i < (rem + 7) / 8; i++)
+			m |= (u32)M[i] << (24 - 8 * i);
+		m &= 0xFFFFFFFF << (32 - rem);
+		T ^= eia3_word(m, window);
 	}
-	T ^= GET_WORD(z,LENGTH);
-	
-	*MAC = T ^ z[L-1];
-	ogs_free(z);
+
+	/* GET_WORD(z, LENGTH) */
+	T ^= (u32)(window >> (32 - rem));
+
+	/* z[L-1], L = (LENGTH + 64 + 31) / 32 */
+	if (rem)
+		*MAC = T ^ zuc_next(&ctx);
+	else
+		*MAC = T ^ (u32)window;
 }
 /* end of EIA3.c */
@@ -21,15 +21,22 @@ extern "C" {
 typedef uint8_t u8;
 typedef uint32_t u32;
 
+/* ZUC state, so that several threads can run EEA3/EIA3 at once */
+typedef struct zuc_ctx_s {
+    u32 s[16];          /* LFSR */
+    u32 r1, r2;         /* F */
+    u32 x0, x1, x2, x3; /* BitReorganization */
+} zuc_ctx_t;
+
 /*
  * ZUC keystream generator
  * k: secret key (input, 16 bytes)
  * iv: initialization vector (input, 16 bytes)
  * Keystream: produced keystream (output, variable length)
- * KeystreamLen: length in bits requested for the keystream (input)
+ * KeystreamLen: length in words requested for the keystream (input)
 */
-void zuc_initialize(u8* k, u8* iv);
-void zuc_generate_key_stream(u32* pKeystream, u32 KeystreamLen);
+void zuc_initialize(zuc_ctx_t *ctx, u8* k, u8* iv);
+void zuc_generate_key_stream(zuc_ctx_t *ctx, u32* pKeystream, u32 KeystreamLen);
 
 /*
  * CK: ciphering key
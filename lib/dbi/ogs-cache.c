@@ -0,0 +1,618 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <mongoc.h>
+
+#include "ogs-dbi.h"
+
+typedef struct ogs_cache_entry_s {
+    ogs_lnode_t lnode;                  /* LRU List */
+    struct ogs_cache_entry_s *next;     /* Hash Chain by Key */
+    struct ogs_cache_entry_s *oid_next; /* Hash Chain by _id */
+
+    uint32_t hash;
+    uint32_t oid_hash;
+    char *key;
+    uint8_t oid[12];
+    ogs_time_t time;                    /* Stored, monotonic */
+
+    void *data;
+    size_t size;
+} ogs_cache_entry_t;
+
+struct ogs_cache_s {
+    ogs_thread_mutex_t mutex;
+
+    ogs_cache_entry_t **bucket;
+    ogs_cache_entry_t **oid_bucket;
+    uint32_t num_of_bucket;             /* Power of 2, for both */
+    uint32_t count;
+
+    ogs_list_t lru;                     /* Head is the least recently used */
+    size_t bytes;
+    size_t max_bytes;
+    ogs_time_t ttl;                     /* Without change stream */
+
+    ogs_cache_copy_f copy_cb;
+    ogs_cache_free_f free_cb;
+
+    /* Bumped on every invalidation */
+    uint64_t version;
+
+    char *db_uri;
+    char *collection;
+    ogs_thread_t *thread;
+    bool watching;
+    int terminate;
+
+    struct {
+        uint64_t hit, miss, evicted, invalidated, expired;
+    } counter;
+};
+
+#define OGS_CACHE_MIN_BUCKET 1024
+
+static uint32_t cache_hash(const char *key)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*key) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static uint32_t oid_hash(const uint8_t *oid)
+{
+    uint32_t hash = 2166136261U;
+    int i;
+
+    for (i = 0; i < 12; i++) {
+        hash ^= oid[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static ogs_cache_entry_t **cache_slot(ogs_cache_t *cache, uint32_t hash)
+{
+    return &cache->bucket[hash & (cache->num_of_bucket - 1)];
+}
+
+static ogs_cache_entry_t **oid_slot(ogs_cache_t *cache, uint32_t hash)
+{
+    return &cache->oid_bucket[hash & (cache->num_of_bucket - 1)];
+}
+
+static void cache_grow(ogs_cache_t *cache)
+{
+    ogs_cache_entry_t **bucket = NULL, **oid_bucket = NULL;
+    ogs_cache_entry_t *entry = NULL;
+    uint32_t num_of_bucket;
+
+    num_of_bucket = cache->num_of_bucket * 2;
+    bucket = calloc(num_of_bucket, sizeof(*bucket));
+    oid_bucket = calloc(num_of_bucket, sizeof(*oid_bucket));
+    if (!bucket || !oid_bucket) {
+        free(bucket);
+        free(oid_bucket);
+        return;
+    }
+
+    ogs_list_for_each(&cache->lru, entry) {
+        ogs_cache_entry_t **slot =
+            &bucket[entry->hash & (num_of_bucket - 1)];
+
+        entry->next = *slot;
+        *slot = entry;
+
+        slot = &oid_bucket[entry->oid_hash & (num_of_bucket - 1)];
+        entry->oid_next = *slot;
+        *slot = entry;
+    }
+
+    free(cache->bucket);
+    free(cache->oid_bucket);
+    cache->bucket = bucket;
+    cache->oid_bucket = oid_bucket;
+    cache->num_of_bucket = num_of_bucket;
+}
+
+static void cache_remove(ogs_cache_t *cache, ogs_cache_entry_t *entry)
+{
+    ogs_cache_entry_t **slot = cache_slot(cache, entry->hash);
+
+    while (*slot != entry)
+        slot = &(*slot)->next;
+    *slot = entry->next;
+
+    slot = oid_slot(cache, entry->oid_hash);
+    while (*slot != entry)
+        slot = &(*slot)->oid_next;
+    *slot = entry->oid_next;
+
+    ogs_list_remove(&cache->lru, entry);
+    cache->bytes -= entry->size;
+    cache->count--;
+
+    if (cache->free_cb)
+        cache->free_cb(entry->data);
+    else
+        free(entry->data);
+    free(entry->key);
+    free(entry);
+}
+
+static ogs_cache_entry_t *cache_find(ogs_cache_t *cache, const char *key)
+{
+    uint32_t hash = cache_hash(key);
+    ogs_cache_entry_t *entry = *cache_slot(cache, hash);
+
+    while (entry) {
+        if (entry->hash == hash && strcmp(entry->key, key) == 0)
+            return entry;
+        entry = entry->next;
+    }
+
+    return NULL;
+}
+
+static void cache_remove_all(ogs_cache_t *cache)
+{
+    ogs_cache_entry_t *entry = NULL, *next_entry = NULL;
+
+    ogs_list_for_each_safe(&cache->lru, next_entry, entry)
+        cache_remove(cache, entry);
+    cache->version++;
+}
+
+/*
+ * Without the change stream nothing tells us about updates, so an entry
+ * is trusted only for 'ttl' after it was read.
+ */
+static bool cache_expired(ogs_cache_t *cache, ogs_cache_entry_t *entry)
+{
+    if (ogs_atomic_load(&cache->watching))
+        return false;
+
+    return ogs_get_monotonic_time() - entry->time >= cache->ttl;
+}
+
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+static void cache_invalidate(ogs_cache_t *cache, const bson_oid_t *oid)
+{
+    ogs_cache_entry_t *entry = NULL, **slot = NULL;
+
+    ogs_thread_mutex_lock(&cache->mutex);
+
+    /* All entries of one document are on the same chain */
+    slot = oid_slot(cache, oid_hash(oid->bytes));
+    while ((entry = *slot)) {
+        if (memcmp(entry->oid, oid->bytes, sizeof(entry->oid)) == 0) {
+            cache_remove(cache, entry);
+            cache->counter.invalidated++;
+        } else
+            slot = &entry->oid_next;
+    }
+
+    cache->version++;
+    ogs_thread_mutex_unlock(&cache->mutex);
+}
+
+/*
+ * Only 'security.*' changes in an update, i.e. the SQN/RAND written
+ * by every Authentication-Information-Request, keep the entry valid.
+ */
+static bool update_is_relevant(const bson_t *doc)
+{
+    bson_iter_t iter, child;
+
+    if (bson_iter_init(&iter, doc) &&
+        bson_iter_find_descendant(
+            &iter, "updateDescription.updatedFields", &child) &&
+        BSON_ITER_HOLDS_DOCUMENT(&child) &&
+        bson_iter_recurse(&child, &iter)) {
+        while (bson_iter_next(&iter))
+            if (strncmp(bson_iter_key(&iter), "security.", 9) &&
+                strcmp(bson_iter_key(&iter), "security"))
+                return true;
+    } else
+        return true;
+
+    if (bson_iter_init(&iter, doc) &&
+        bson_iter_find_descendant(
+            &iter, "updateDescription.removedFields", &child) &&
+        BSON_ITER_HOLDS_ARRAY(&child) &&
+        bson_iter_recurse(&child, &iter)) {
+        while (bson_iter_next(&iter))
+            if (!BSON_ITER_HOLDS_UTF8(&iter) ||
+                strncmp(bson_iter_utf8(&iter, NULL), "security.", 9))
+                return true;
+    }
+
+    return false;
+}
+
+static void cache_event(ogs_cache_t *cache, const bson_t *doc)
+{
+    bson_iter_t iter, child;
+    const char *type = NULL;
+
+    if (bson_iter_init_find(&iter, doc, "operationType") &&
+        BSON_ITER_HOLDS_UTF8(&iter))
+        type = bson_iter_utf8(&iter, NULL);
+
+    if (!type) {
+        ogs_error("No operationType in change event");
+        ogs_cache_remove_all(cache);
+        return;
+    }
+
+    if (!strcmp(type, "insert"))
+        return;
+
+    if (!strcmp(type, "update") && !update_is_relevant(doc))
+        return;
+
+    if (!strcmp(type, "update") || !strcmp(type, "replace") ||
+        !strcmp(type, "delete")) {
+        if (bson_iter_init(&iter, doc) &&
+            bson_iter_find_descendant(&iter, "documentKey._id", &child) &&
+            BSON_ITER_HOLDS_OID(&child)) {
+            cache_invalidate(cache, bson_iter_oid(&child));
+            return;
+        }
+    }
+
+    /* drop, rename, dropDatabase, invalidate, or unknown key */
+    ogs_cache_remove_all(cache);
+}
+
+static void cache_watch(ogs_cache_t *cache,
+        mongoc_collection_t *collection, bool verbose)
+{
+    mongoc_change_stream_t *stream = NULL;
+    const bson_t *doc = NULL, *error_doc = NULL;
+    bson_t *pipeline = NULL, *opts = NULL;
+    bson_error_t error;
+
+    pipeline = BCON_NEW("pipeline", "[", "]");
+    ogs_assert(pipeline);
+    opts = BCON_NEW("maxAwaitTimeMS", BCON_INT64(1000));
+    ogs_assert(opts);
+
+    stream = mongoc_collection_watch(collection, pipeline, opts);
+    ogs_assert(stream);
+
+    while (!ogs_atomic_load(&cache->terminate)) {
+        if (mongoc_change_stream_next(stream, &doc)) {
+            cache_event(cache, doc);
+            continue;
+        }
+
+        if (mongoc_change_stream_error_document(stream, &error, &error_doc))
+            break;
+
+        if (!ogs_atomic_load(&cache->watching)) {
+            /*
+             * The first empty batch means the stream is open. Changes
+             * made before that were not seen, so start from scratch.
+             */
+            ogs_atomic_store(&cache->watching, true);
+            ogs_cache_remove_all(cache);
+            ogs_info("[%s] cache invalidated by change stream",
+                    cache->collection);
+        }
+    }
+
+    if (!ogs_atomic_load(&cache->terminate)) {
+        if (ogs_atomic_load(&cache->watching))
+            ogs_warn("[%s] change stream closed: %s",
+                    cache->collection, error.message);
+        else if (verbose && cache->ttl)
+            ogs_warn("[%s] change stream not available (%s), "
+                    "entries expire after %llds", cache->collection,
+                    error.message, (long long)ogs_time_sec(cache->ttl));
+        else if (verbose)
+            ogs_warn("[%s] change stream not available (%s), "
+                    "cache disabled", cache->collection, error.message);
+    }
+
+    /* Events may have been missed, so nothing in the cache can be trusted */
+    if (ogs_atomic_load(&cache->watching)) {
+        ogs_atomic_store(&cache->watching, false);
+        ogs_cache_remove_all(cache);
+    }
+
+    mongoc_change_stream_destroy(stream);
+    bson_destroy(opts);
+    bson_destroy(pipeline);
+}
+
+static void cache_main(void *data)
+{
+    ogs_cache_t *cache = data;
+    mongoc_uri_t *uri = NULL;
+    mongoc_client_t *client = NULL;
+    mongoc_collection_t *collection = NULL;
+    bson_error_t error;
+    int attempt = 0;
+
+    ogs_assert(cache);
+
+    uri = mongoc_uri_new_with_error(cache->db_uri, &error);
+    if (!uri) {
+        ogs_error("Failed to parse DB URI [%s]", error.message);
+        return;
+    }
+    /* Let ogs_cache_destroy() stop this thread in time */
+    mongoc_uri_set_option_as_int32(
+            uri, MONGOC_URI_SERVERSELECTIONTIMEOUTMS, 1000);
+
+    client = mongoc_client_new_from_uri(uri);
+    ogs_assert(client);
+    mongoc_client_set_error_api(client, 2);
+
+    collection = mongoc_client_get_collection(
+            client, mongoc_uri_get_database(uri), cache->collection);
+    ogs_assert(collection);
+
+    /*
+     * Reopen the stream in the background. A standalone mongod never
+     * supports it, so keep quiet after the first failure.
+     */
+    while (!ogs_atomic_load(&cache->terminate)) {
+        int i;
+
+        cache_watch(cache, collection, attempt++ == 0);
+
+        for (i = 0; i < 50 && !ogs_atomic_load(&cache->terminate); i++)
+            ogs_msleep(100);
+    }
+
+    mongoc_collection_destroy(collection);
+    mongoc_client_destroy(client);
+    mongoc_uri_destroy(uri);
+}
+#endif
+
+ogs_cache_t *ogs_cache_create(const char *db_uri, const char *collection,
+        size_t max_bytes, ogs_time_t ttl,
+        ogs_cache_copy_f copy_cb, ogs_cache_free_f free_cb)
+{
+    ogs_cache_t *cache = NULL;
+
+    ogs_assert(db_uri);
+    ogs_assert(collection);
+
+    if (!max_bytes)
+        return NULL;
+
+#if !MONGOC_CHECK_VERSION(1, 9, 0)
+    if (!ttl) {
+        ogs_warn("[%s] change stream needs mongo-c-driver 1.9, "
+                "cache disabled", collection);
+        return NULL;
+    }
+    ogs_warn("[%s] change stream needs mongo-c-driver 1.9, "
+            "entries expire after %llds",
+            collection, (long long)ogs_time_sec(ttl));
+#endif
+
+    cache = calloc(1, sizeof(*cache));
+    ogs_assert(cache);
+
+    cache->num_of_bucket = OGS_CACHE_MIN_BUCKET;
+    cache->bucket = calloc(cache->num_of_bucket, sizeof(*cache->bucket));
+    ogs_assert(cache->bucket);
+    cache->oid_bucket =
+        calloc(cache->num_of_bucket, sizeof(*cache->oid_bucket));
+    ogs_assert(cache->oid_bucket);
+
+    ogs_thread_mutex_init(&cache->mutex);
+    ogs_list_init(&cache->lru);
+
+    cache->max_bytes = max_bytes;
+    cache->ttl = ttl;
+    cache->copy_cb = copy_cb;
+    cache->free_cb = free_cb;
+
+    cache->db_uri = strdup(db_uri);
+    ogs_assert(cache->db_uri);
+    cache->collection = strdup(collection);
+    ogs_assert(cache->collection);
+
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+    cache->thread = ogs_thread_create(cache_main, cache);
+    ogs_assert(cache->thread);
+#endif
+
+    return cache;
+}
+
+void ogs_cache_destroy(ogs_cache_t *cache)
+{
+    if (!cache)
+        return;
+
+    if (cache->thread) {
+        ogs_atomic_store(&cache->terminate, 1);
+        ogs_thread_destroy(cache->thread);
+    }
+
+    ogs_info("[%s] cache hit:%llu miss:%llu evicted:%llu invalidated:%llu "
+            "expired:%llu", cache->collection,
+            (unsigned long long)cache->counter.hit,
+            (unsigned long long)cache->counter.miss,
+            (unsigned long long)cache->counter.evicted,
+            (unsigned long long)cache->counter.invalidated,
+            (unsigned long long)cache->counter.expired);
+
+    ogs_cache_remove_all(cache);
+    ogs_thread_mutex_destroy(&cache->mutex);
+
+    free(cache->collection);
+    free(cache->db_uri);
+    free(cache->bucket);
+    free(cache->oid_bucket);
+    free(cache);
+}
+
+bool ogs_cache_get(ogs_cache_t *cache, const char *key, void *dst)
+{
+    ogs_cache_entry_t *entry = NULL;
+
+    ogs_assert(key);
+    ogs_assert(dst);
+
+    if (!cache)
+        return false;
+
+    ogs_thread_mutex_lock(&cache->mutex);
+
+    entry = cache_find(cache, key);
+    if (entry && cache_expired(cache, entry)) {
+        cache_remove(cache, entry);
+        cache->counter.expired++;
+        entry = NULL;
+    }
+
+    if (!entry) {
+        cache->counter.miss++;
+        ogs_thread_mutex_unlock(&cache->mutex);
+        return false;
+    }
+
+    ogs_list_remove(&cache->lru, entry);
+    ogs_list_add(&cache->lru, entry);
+    cache->counter.hit++;
+
+    if (cache->copy_cb)
+        cache->copy_cb(dst, entry->data);
+    else
+        memcpy(dst, entry->data, entry->size);
+
+    ogs_thread_mutex_unlock(&cache->mutex);
+
+    return true;
+}
+
+uint64_t ogs_cache_version(ogs_cache_t *cache)
+{
+    uint64_t version;
+
+    if (!cache)
+        return 0;
+
+    ogs_thread_mutex_lock(&cache->mutex);
+    version = cache->version;
+    ogs_thread_mutex_unlock(&cache->mutex);
+
+    return version;
+}
+
+void ogs_cache_set(ogs_cache_t *cache, uint64_t version,
+        const char *key, const uint8_t *oid, void *data, size_t size)
+{
+    ogs_cache_entry_t *entry = NULL, **slot = NULL;
+
+    ogs_assert(key);
+    ogs_assert(oid);
+    ogs_assert(data);
+
+    if (!cache) {
+        free(data);
+        return;
+    }
+
+    ogs_thread_mutex_lock(&cache->mutex);
+
+    /*
+     * The document may have changed after it was read.
+     * Do not cache what we cannot tell is still valid.
+     */
+    if (version != cache->version || size > cache->max_bytes ||
+        (!ogs_atomic_load(&cache->watching) && !cache->ttl))
+        goto out;
+
+    entry = cache_find(cache, key);
+    if (entry)
+        cache_remove(cache, entry);
+
+    while (cache->bytes + size > cache->max_bytes) {
+        entry = ogs_list_first(&cache->lru);
+        ogs_assert(entry);
+        cache_remove(cache, entry);
+        cache->counter.evicted++;
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (!entry)
+        goto out;
+    entry->key = strdup(key);
+    if (!entry->key) {
+        free(entry);
+        goto out;
+    }
+
+    entry->hash = cache_hash(key);
+    entry->oid_hash = oid_hash(oid);
+    memcpy(entry->oid, oid, sizeof(entry->oid));
+    entry->time = ogs_get_monotonic_time();
+    entry->data = data;
+    entry->size = size;
+
+    if (cache->count >= cache->num_of_bucket)
+        cache_grow(cache);
+
+    slot = cache_slot(cache, entry->hash);
+    entry->next = *slot;
+    *slot = entry;
+
+    slot = oid_slot(cache, entry->oid_hash);
+    entry->oid_next = *slot;
+    *slot = entry;
+
+    ogs_list_add(&cache->lru, entry);
+    cache->bytes += size;
+    cache->count++;
+
+    ogs_thread_mutex_unlock(&cache->mutex);
+    return;
+
+out:
+    ogs_thread_mutex_unlock(&cache->mutex);
+    if (cache->free_cb)
+        cache->free_cb(data);
+    else
+        free(data);
+}
+
+void ogs_cache_remove_all(ogs_cache_t *cache)
+{
+    if (!cache)
+        return;
+
+    ogs_thread_mutex_lock(&cache->mutex);
+    cache_remove_all(cache);
+    ogs_thread_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_DBI_INSIDE) && !defined(OGS_DBI_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_CACHE_H
+#define OGS_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Subscriber Profile Cache
+ *
+ * Parsed query results keyed by a string such as IMSI or IMSI/APN.
+ * Each entry remembers the _id of its document. A change stream on the
+ * collection drops the entry when the document changes. Without change
+ * streams (e.g. standalone mongod, or mongo-c-driver < 1.9), entries
+ * expire 'ttl' after they were stored, and nothing is cached if 'ttl'
+ * is 0. The least recently used entries are evicted when the total
+ * size is over 'max_bytes'.
+ *
+ * Entries are allocated outside of the pkbuf pools.
+ */
+typedef struct ogs_cache_s ogs_cache_t;
+
+typedef void (*ogs_cache_copy_f)(void *dst, const void *data);
+typedef void (*ogs_cache_free_f)(void *data);
+
+ogs_cache_t *ogs_cache_create(const char *db_uri, const char *collection,
+        size_t max_bytes, ogs_time_t ttl,
+        ogs_cache_copy_f copy_cb, ogs_cache_free_f free_cb);
+void ogs_cache_destroy(ogs_cache_t *cache);
+
+/* Copy out with copy_cb, or memcpy if NULL */
+bool ogs_cache_get(ogs_cache_t *cache, const char *key, void *dst);
+
+/*
+ * Take the version before reading the document. If anything was
+ * invalidated in the meantime, 'data' is not cached.
+ * 'data' is malloc()ed by the caller and owned by the cache afterwards.
+ */
+uint64_t ogs_cache_version(ogs_cache_t *cache);
+void ogs_cache_set(ogs_cache_t *cache, uint64_t version,
+        const char *key, const uint8_t *oid, void *data, size_t size);
+
+void ogs_cache_remove_all(ogs_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_CACHE_H */
@@ -25,6 +25,7 @@
 #define OGS_DBI_INSIDE
 
 #include "dbi/ogs-mongoc.h"
+#include "dbi/ogs-cache.h"
 
 #undef OGS_DBI_INSIDE
 
@@ -49,6 +49,8 @@ typedef struct ogs_gtp_node_s {
 
     ogs_list_t      local_list;    
     ogs_list_t      remote_list;   
+    ogs_hash_t      *local_hash;    /* hash table (XID : local xact) */
+    ogs_hash_t      *remote_hash;   /* hash table (XID : remote xact) */
 } ogs_gtp_node_t;
 
 int ogs_gtp_node_init(int size);
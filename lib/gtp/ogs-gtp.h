@@ -35,6 +35,7 @@
 #include "gtp/conv.h"
 #include "gtp/node.h"
 #include "gtp/path.h"
+#include "gtp/worker.h"
 #include "gtp/xact.h"
 
 #ifdef __cplusplus
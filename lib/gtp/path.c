@@ -117,6 +117,180 @@ int ogs_gtp_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf)
     return OGS_OK;
 }
 
+static void slab_reset(ogs_pkbuf_t *slab)
+{
+    slab->data = slab->head;
+    slab->tail = slab->head + OGS_MAX_SDU_LEN;
+    slab->len = OGS_MAX_SDU_LEN;
+}
+
+static ogs_pkbuf_t *batch_copy(ogs_gtp_batch_t *batch,
+        ogs_pkbuf_t *slab, unsigned int headroom)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    unsigned int size = headroom + slab->len;
+
+    if (batch->cache)
+        pkbuf = ogs_pkbuf_cache_alloc(batch->cache, size);
+    else
+        pkbuf = ogs_pkbuf_alloc(batch->pool, size);
+    ogs_assert(pkbuf);
+
+    ogs_pkbuf_reserve(pkbuf, headroom);
+    ogs_pkbuf_put_data(pkbuf, slab->data, slab->len);
+
+    return pkbuf;
+}
+
+void ogs_gtp_batch_init(ogs_gtp_batch_t *batch,
+        ogs_pkbuf_pool_t *pool, int size)
+{
+    int i;
+
+    ogs_assert(batch);
+    ogs_assert(size > 0 && size <= OGS_MAX_NUM_OF_MMSG);
+
+    memset(batch, 0, sizeof *batch);
+    batch->size = size;
+    batch->pool = pool;
+
+    for (i = 0; i < batch->size; i++) {
+        batch->slab[i] = ogs_pkbuf_alloc(batch->pool, OGS_MAX_SDU_LEN);
+        ogs_assert(batch->slab[i]);
+        ogs_pkbuf_put(batch->slab[i], OGS_MAX_SDU_LEN);
+    }
+}
+
+void ogs_gtp_batch_final(ogs_gtp_batch_t *batch)
+{
+    int i;
+
+    ogs_assert(batch);
+
+    ogs_gtp_batch_flush(batch);
+
+    for (i = 0; i < batch->size; i++)
+        ogs_pkbuf_free(batch->slab[i]);
+
+    memset(batch, 0, sizeof *batch);
+}
+
+int ogs_gtp_batch_recv(ogs_gtp_batch_t *batch, ogs_socket_t fd)
+{
+    int i, n;
+
+    ogs_assert(batch);
+    ogs_assert(fd != INVALID_SOCKET);
+
+    batch->num_of_recvbuf = 0;
+
+    n = ogs_recvmmsg(fd, batch->slab, batch->from, batch->size, 0);
+    if (n <= 0)
+        return 0;
+
+    for (i = 0; i < n; i++) {
+        batch->recvbuf[i] = batch_copy(batch, batch->slab[i], 0);
+        slab_reset(batch->slab[i]);
+    }
+
+    batch->num_of_recvbuf = n;
+
+    return n;
+}
+
+ogs_pkbuf_t *ogs_gtp_batch_read(ogs_gtp_batch_t *batch,
+        ogs_socket_t fd, unsigned int headroom)
+{
+    ogs_pkbuf_t *slab = NULL, *pkbuf = NULL;
+    ssize_t n;
+
+    ogs_assert(batch);
+    ogs_assert(fd != INVALID_SOCKET);
+
+    slab = batch->slab[0];
+
+    n = ogs_read(fd, slab->data, slab->len);
+    if (n <= 0) {
+        if (n == 0 || ogs_socket_errno != OGS_EAGAIN)
+            ogs_log_message(OGS_LOG_WARN, ogs_socket_errno,
+                    "ogs_read() failed");
+        return NULL;
+    }
+
+    ogs_pkbuf_trim(slab, n);
+    pkbuf = batch_copy(batch, slab, headroom);
+    slab_reset(slab);
+
+    return pkbuf;
+}
+
+void ogs_gtp_batch_add(ogs_gtp_batch_t *batch,
+        ogs_socket_t fd, ogs_sockaddr_t *to, ogs_pkbuf_t *pkbuf)
+{
+    ogs_assert(batch);
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(to);
+    ogs_assert(pkbuf);
+
+    if (batch->num_of_sendbuf >= batch->size)
+        ogs_gtp_batch_flush(batch);
+
+    batch->sendbuf[batch->num_of_sendbuf] = pkbuf;
+    batch->fd[batch->num_of_sendbuf] = fd;
+    batch->to[batch->num_of_sendbuf] = to;
+    batch->num_of_sendbuf++;
+}
+
+void ogs_gtp_batch_sendto(ogs_gtp_batch_t *batch,
+        ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf)
+{
+    ogs_assert(gnode);
+    ogs_assert(gnode->sock);
+
+    ogs_gtp_batch_add(batch, gnode->sock->fd, &gnode->remote_addr, pkbuf);
+}
+
+void ogs_gtp_batch_flush(ogs_gtp_batch_t *batch)
+{
+    ogs_pkbuf_t *pkbuf[OGS_MAX_NUM_OF_MMSG];
+    ogs_sockaddr_t *to[OGS_MAX_NUM_OF_MMSG];
+    int i, n, sent, done;
+    ogs_socket_t fd;
+
+    ogs_assert(batch);
+
+    /* Datagrams are grouped per socket, one sendmmsg() per socket */
+    for (done = 0; done < batch->num_of_sendbuf; /* nothing */) {
+        fd = INVALID_SOCKET;
+        n = 0;
+        for (i = 0; i < batch->num_of_sendbuf; i++) {
+            if (!batch->sendbuf[i])
+                continue;
+            if (fd == INVALID_SOCKET)
+                fd = batch->fd[i];
+            if (batch->fd[i] != fd)
+                continue;
+
+            pkbuf[n] = batch->sendbuf[i];
+            to[n] = batch->to[i];
+            n++;
+
+            batch->sendbuf[i] = NULL;
+        }
+
+        sent = ogs_sendmmsg(fd, pkbuf, to, n, 0);
+        if (sent != n)
+            ogs_error("ogs_sendmmsg() failed [%d/%d]", sent, n);
+
+        for (i = 0; i < n; i++)
+            ogs_pkbuf_free(pkbuf[i]);
+
+        done += n;
+    }
+
+    batch->num_of_sendbuf = 0;
+}
+
 ogs_pkbuf_t *ogs_gtp_handle_echo_req(ogs_pkbuf_t *pkb)
 {
     ogs_gtp_header_t *gtph = NULL;
@@ -36,6 +36,51 @@ int ogs_gtp_connect(ogs_sock_t *ipv4, ogs_sock_t *ipv6, ogs_gtp_node_t *gnode);
 int ogs_gtp_send(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf);
 int ogs_gtp_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf);
 
+/*
+ * Batched GTP-U I/O
+ *
+ * ogs_gtp_batch_recv() drains up to 'size' datagrams with one syscall.
+ * The caller owns recvbuf[0..n-1] after the call returns n.
+ *
+ * Datagrams land in fixed MTU-sized slabs owned by the batch and are
+ * copied into buffers sized to the packet, taken from 'cache' if set.
+ * ogs_gtp_batch_read() does the same for a single read() with
+ * 'headroom' reserved in front, e.g. for the TUN device.
+ *
+ * ogs_gtp_batch_add()/sendto() queue a datagram and take ownership of
+ * pkbuf. 'to' must stay valid until the queue is written out by
+ * ogs_gtp_batch_flush() or when it is full.
+ */
+typedef struct ogs_gtp_batch_s {
+    int size;
+    ogs_pkbuf_pool_t *pool;
+    ogs_pkbuf_cache_t *cache;
+
+    ogs_pkbuf_t *slab[OGS_MAX_NUM_OF_MMSG];
+
+    int num_of_recvbuf;
+    ogs_pkbuf_t *recvbuf[OGS_MAX_NUM_OF_MMSG];
+    ogs_sockaddr_t from[OGS_MAX_NUM_OF_MMSG];
+
+    int num_of_sendbuf;
+    ogs_pkbuf_t *sendbuf[OGS_MAX_NUM_OF_MMSG];
+    ogs_socket_t fd[OGS_MAX_NUM_OF_MMSG];
+    ogs_sockaddr_t *to[OGS_MAX_NUM_OF_MMSG];
+} ogs_gtp_batch_t;
+
+void ogs_gtp_batch_init(ogs_gtp_batch_t *batch,
+        ogs_pkbuf_pool_t *pool, int size);
+void ogs_gtp_batch_final(ogs_gtp_batch_t *batch);
+
+int ogs_gtp_batch_recv(ogs_gtp_batch_t *batch, ogs_socket_t fd);
+ogs_pkbuf_t *ogs_gtp_batch_read(ogs_gtp_batch_t *batch,
+        ogs_socket_t fd, unsigned int headroom);
+void ogs_gtp_batch_add(ogs_gtp_batch_t *batch,
+        ogs_socket_t fd, ogs_sockaddr_t *to, ogs_pkbuf_t *pkbuf);
+void ogs_gtp_batch_sendto(ogs_gtp_batch_t *batch,
+        ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf);
+void ogs_gtp_batch_flush(ogs_gtp_batch_t *batch);
+
 ogs_pkbuf_t *ogs_gtp_handle_echo_req(ogs_pkbuf_t *pkt);
 void ogs_gtp_send_error_message(
         ogs_gtp_xact_t *xact, uint32_t teid, uint8_t type, uint8_t cause_value);
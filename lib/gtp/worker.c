@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-gtp.h"
+
+ogs_gtp_fwd_table_t *ogs_gtp_fwd_table_create(uint32_t size)
+{
+    ogs_gtp_fwd_table_t *table = NULL;
+
+    ogs_assert(size);
+
+    table = ogs_calloc(1, sizeof *table);
+    ogs_assert(table);
+
+    table->size = size;
+    table->slot = calloc(size, sizeof(ogs_gtp_fwd_t *));
+    ogs_assert(table->slot);
+
+    /* One live entry per TEID and some room for the retired ones */
+    ogs_pool_init(&table->pool, size + ogs_max(size >> 3, 1024));
+    table->punt.action = OGS_GTP_FWD_PUNT;
+
+    ogs_list_init(&table->retired);
+    ogs_list_init(&table->grace);
+
+    return table;
+}
+
+static void retired_free(
+        ogs_gtp_fwd_table_t *table, ogs_gtp_retired_t *retired)
+{
+    if (retired->free)
+        retired->free(retired);
+    else
+        ogs_pool_free(&table->pool, (ogs_gtp_fwd_t *)retired);
+}
+
+void ogs_gtp_fwd_table_destroy(ogs_gtp_fwd_table_t *table)
+{
+    ogs_gtp_retired_t *retired = NULL, *next_retired = NULL;
+    uint32_t i;
+
+    ogs_assert(table);
+
+    /* All workers must be stopped at this point */
+    for (i = 0; i < table->size; i++) {
+        if (table->slot[i] && table->slot[i] != &table->punt)
+            ogs_pool_free(&table->pool, table->slot[i]);
+    }
+    ogs_list_for_each_safe(&table->grace, next_retired, retired)
+        retired_free(table, retired);
+    ogs_list_for_each_safe(&table->retired, next_retired, retired)
+        retired_free(table, retired);
+
+    ogs_pool_final(&table->pool);
+    free(table->slot);
+
+    ogs_free(table);
+}
+
+static bool grace_period_elapsed(ogs_gtp_fwd_table_t *table)
+{
+    unsigned long epoch;
+    int i;
+
+    for (i = 0; i < table->num_of_worker; i++) {
+        epoch = ogs_atomic_load(&table->worker[i].epoch);
+        /* Still inside the same handler call that was running before */
+        if ((epoch & 1) && epoch == table->snapshot[i])
+            return false;
+    }
+
+    return true;
+}
+
+static void fwd_reclaim(ogs_gtp_fwd_table_t *table)
+{
+    ogs_gtp_retired_t *retired = NULL, *next_retired = NULL;
+    int i;
+
+    if (!ogs_list_empty(&table->grace)) {
+        if (!grace_period_elapsed(table))
+            return;
+
+        ogs_list_for_each_safe(&table->grace, next_retired, retired)
+            retired_free(table, retired);
+        ogs_list_init(&table->grace);
+    }
+
+    if (!ogs_list_empty(&table->retired)) {
+        table->grace = table->retired;
+        ogs_list_init(&table->retired);
+
+        /* Entries were unpublished before the snapshot is taken */
+        ogs_atomic_fence();
+        for (i = 0; i < table->num_of_worker; i++)
+            table->snapshot[i] = ogs_atomic_load(&table->worker[i].epoch);
+    }
+}
+
+/* NULL if the retired entries are still in their grace period */
+static ogs_gtp_fwd_t *fwd_alloc(ogs_gtp_fwd_table_t *table)
+{
+    ogs_gtp_fwd_t *fwd = NULL;
+
+    ogs_pool_alloc(&table->pool, &fwd);
+    if (!fwd) {
+        fwd_reclaim(table);
+        ogs_pool_alloc(&table->pool, &fwd);
+    }
+
+    return fwd;
+}
+
+static void fwd_publish(ogs_gtp_fwd_table_t *table,
+        uint32_t teid, ogs_gtp_fwd_t *fwd)
+{
+    ogs_gtp_fwd_t *old = NULL;
+
+    ogs_assert(teid > 0 && teid <= table->size);
+
+    old = table->slot[teid-1];
+    ogs_atomic_store(&table->slot[teid-1], fwd);
+
+    if (old && old != &table->punt)
+        ogs_gtp_fwd_retire(table, &old->retired, NULL);
+    else
+        fwd_reclaim(table);
+}
+
+void ogs_gtp_fwd_update(ogs_gtp_fwd_table_t *table,
+        uint32_t teid, ogs_gtp_fwd_t *fwd)
+{
+    ogs_gtp_fwd_t *new = NULL;
+
+    ogs_assert(table);
+    ogs_assert(fwd);
+
+    new = fwd_alloc(table);
+    if (!new) {
+        /*
+         * Never wait for the workers here. Until the next update, the
+         * control thread handles this TEID, which is slower but correct.
+         */
+        ogs_warn_ratelimited("GTP-U forwarding pool exhausted, "
+                "TEID[0x%x] is handled by the control thread", teid);
+        fwd_publish(table, teid, &table->punt);
+        return;
+    }
+    memcpy(new, fwd, sizeof *new);
+
+    fwd_publish(table, teid, new);
+}
+
+void ogs_gtp_fwd_remove(ogs_gtp_fwd_table_t *table, uint32_t teid)
+{
+    ogs_assert(table);
+
+    fwd_publish(table, teid, NULL);
+}
+
+/* Free an unpublished object once no worker can still be reading it */
+void ogs_gtp_fwd_retire(ogs_gtp_fwd_table_t *table,
+        ogs_gtp_retired_t *retired, void (*free_cb)(void *))
+{
+    ogs_assert(table);
+    ogs_assert(retired);
+
+    retired->free = free_cb;
+    if (table->num_of_worker)
+        ogs_list_add(&table->retired, retired);
+    else
+        retired_free(table, retired);
+
+    fwd_reclaim(table);
+}
+
+static void worker_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    ogs_gtp_worker_t *worker = data;
+
+    ogs_assert(worker);
+
+    ogs_atomic_inc(&worker->epoch);
+    worker->handler(worker, fd);
+    ogs_atomic_inc(&worker->epoch);
+}
+
+static void worker_fd_cb(short when, ogs_socket_t fd, void *data)
+{
+    ogs_gtp_worker_fd_t *wfd = data;
+
+    ogs_assert(wfd);
+    ogs_assert(wfd->worker);
+
+    ogs_atomic_inc(&wfd->worker->epoch);
+    wfd->handler(wfd->worker, fd);
+    ogs_atomic_inc(&wfd->worker->epoch);
+}
+
+static void worker_main(void *data)
+{
+    ogs_gtp_worker_t *worker = data;
+
+    ogs_assert(worker);
+
+    while (!ogs_atomic_load(&worker->terminate))
+        ogs_pollset_poll(worker->pollset, OGS_INFINITE_TIME);
+}
+
+static int worker_server(ogs_gtp_worker_t *worker,
+        ogs_list_t *dst, ogs_list_t *src)
+{
+    int rv;
+    ogs_socknode_t *node = NULL, *new = NULL;
+    ogs_sockaddr_t *addr = NULL;
+    ogs_sock_t *sock = NULL;
+
+    ogs_list_for_each(src, node) {
+        rv = ogs_copyaddrinfo(&addr, node->addr);
+        ogs_assert(rv == OGS_OK);
+
+        new = ogs_socknode_add(dst, AF_UNSPEC, addr);
+        ogs_assert(new);
+        ogs_socknode_reuseport(new, true);
+
+        sock = ogs_gtp_server(new);
+        if (!sock)
+            return OGS_ERROR;
+
+        new->poll = ogs_pollset_add(worker->pollset,
+                OGS_POLLIN, sock->fd, worker_recv_cb, worker);
+        ogs_assert(new->poll);
+    }
+
+    return OGS_OK;
+}
+
+int ogs_gtp_worker_init(ogs_gtp_worker_t *worker, int num_of_worker,
+        ogs_list_t *list, ogs_list_t *list6,
+        ogs_gtp_worker_handler_f handler, ogs_gtp_fwd_table_t *table,
+        int batch_size, int num_of_packet, void *data)
+{
+    ogs_pkbuf_config_t config;
+    int i, rv;
+
+    ogs_assert(worker);
+    ogs_assert(num_of_worker > 0 &&
+            num_of_worker <= OGS_MAX_NUM_OF_GTPU_WORKER);
+    ogs_assert(list);
+    ogs_assert(list6);
+    ogs_assert(handler);
+    ogs_assert(table);
+
+    ogs_pkbuf_packet_init(&config, ogs_max(num_of_packet / num_of_worker, 1));
+    config.cluster_8192_pool += batch_size;
+
+    table->worker = worker;
+    table->num_of_worker = num_of_worker;
+
+    for (i = 0; i < num_of_worker; i++) {
+        memset(&worker[i], 0, sizeof worker[i]);
+
+        worker[i].index = i;
+        worker[i].handler = handler;
+        worker[i].table = table;
+        worker[i].data = data;
+
+        worker[i].pollset = ogs_pollset_create();
+        ogs_assert(worker[i].pollset);
+        worker[i].pool = ogs_pkbuf_pool_create(&config);
+        ogs_assert(worker[i].pool);
+        ogs_gtp_batch_init(&worker[i].batch, worker[i].pool, batch_size);
+        worker[i].cache = ogs_pkbuf_cache_create(worker[i].pool);
+        ogs_assert(worker[i].cache);
+        worker[i].batch.cache = worker[i].cache;
+
+        ogs_list_init(&worker[i].gtpu_list);
+        ogs_list_init(&worker[i].gtpu_list6);
+        ogs_list_init(&worker[i].fd_list);
+
+        rv = worker_server(&worker[i], &worker[i].gtpu_list, list);
+        if (rv != OGS_OK) return rv;
+        rv = worker_server(&worker[i], &worker[i].gtpu_list6, list6);
+        if (rv != OGS_OK) return rv;
+
+        worker[i].gtpu_sock = ogs_socknode_sock_first(&worker[i].gtpu_list);
+        worker[i].gtpu_sock6 = ogs_socknode_sock_first(&worker[i].gtpu_list6);
+    }
+
+    return OGS_OK;
+}
+
+int ogs_gtp_worker_add_fd(ogs_gtp_worker_t *worker,
+        ogs_socket_t fd, ogs_gtp_worker_handler_f handler)
+{
+    ogs_gtp_worker_fd_t *wfd = NULL;
+
+    ogs_assert(worker);
+    ogs_assert(worker->pollset);
+    ogs_assert(!worker->thread);
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(handler);
+
+    wfd = ogs_calloc(1, sizeof *wfd);
+    ogs_assert(wfd);
+
+    wfd->worker = worker;
+    wfd->handler = handler;
+    wfd->poll = ogs_pollset_add(worker->pollset,
+            OGS_POLLIN, fd, worker_fd_cb, wfd);
+    if (!wfd->poll) {
+        ogs_free(wfd);
+        return OGS_ERROR;
+    }
+
+    ogs_list_add(&worker->fd_list, wfd);
+
+    return OGS_OK;
+}
+
+int ogs_gtp_worker_run(ogs_gtp_worker_t *worker, int num_of_worker)
+{
+    int i;
+
+    ogs_assert(worker);
+
+    for (i = 0; i < num_of_worker; i++) {
+        worker[i].thread = ogs_thread_create(worker_main, &worker[i]);
+        if (!worker[i].thread) return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+void ogs_gtp_worker_stop(ogs_gtp_worker_t *worker, int num_of_worker)
+{
+    int i;
+
+    ogs_assert(worker);
+
+    for (i = 0; i < num_of_worker; i++) {
+        if (!worker[i].thread)
+            continue;
+
+        ogs_atomic_store(&worker[i].terminate, 1);
+        ogs_pollset_notify(worker[i].pollset);
+        ogs_thread_destroy(worker[i].thread);
+        worker[i].thread = NULL;
+    }
+
+    for (i = 0; i < num_of_worker; i++) {
+        ogs_gtp_worker_fd_t *wfd = NULL, *next_wfd = NULL;
+
+        if (!worker[i].pollset)
+            continue;
+
+        ogs_list_for_each_safe(&worker[i].fd_list, next_wfd, wfd) {
+            ogs_list_remove(&worker[i].fd_list, wfd);
+            ogs_pollset_remove(wfd->poll);
+            ogs_free(wfd);
+        }
+
+        ogs_socknode_remove_all(&worker[i].gtpu_list);
+        ogs_socknode_remove_all(&worker[i].gtpu_list6);
+
+        ogs_gtp_batch_final(&worker[i].batch);
+        ogs_pkbuf_cache_destroy(worker[i].cache);
+        ogs_pkbuf_pool_destroy(worker[i].pool);
+        ogs_pollset_destroy(worker[i].pollset);
+        worker[i].pollset = NULL;
+
+        if (worker[i].table) {
+            worker[i].table->num_of_worker = 0;
+            worker[i].table->worker = NULL;
+        }
+    }
+}
+
+ogs_sock_t *ogs_gtp_worker_sock(ogs_gtp_worker_t *worker, int family)
+{
+    ogs_assert(worker);
+
+    if (family == AF_INET)
+        return worker->gtpu_sock;
+    else if (family == AF_INET6)
+        return worker->gtpu_sock6;
+
+    return NULL;
+}
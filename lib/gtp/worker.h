@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_GTP_INSIDE) && !defined(OGS_GTP_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_GTP_WORKER_H
+#define OGS_GTP_WORKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OGS_MAX_NUM_OF_GTPU_WORKER      32
+
+/*
+ * Retired Object
+ *
+ * Whatever the workers may still be reading is put on the retired list
+ * of the forwarding table once unpublished, and freed after every worker
+ * has passed a quiescent state.
+ */
+typedef struct ogs_gtp_retired_s {
+    ogs_lnode_t     lnode;      /* Retired List */
+    void            (*free)(void *);    /* NULL : Forwarding Entry */
+} ogs_gtp_retired_t;
+
+/*
+ * GTP-U Forwarding Entry
+ *
+ * Built by the control thread and never modified once published.
+ * A replaced entry is freed after every worker has passed
+ * a quiescent state, so workers read it without any lock.
+ */
+typedef struct ogs_gtp_fwd_s {
+    ogs_gtp_retired_t retired;  /* Must be first */
+
+#define OGS_GTP_FWD_PUNT    0   /* Hand over to the control thread */
+#define OGS_GTP_FWD_GTPU    1   /* Rewrite TEID and send to remote_addr */
+#define OGS_GTP_FWD_TUN     2   /* Remove GTP-U header and write to TUN */
+    uint8_t         action;
+
+    uint32_t        remote_teid;
+    ogs_sockaddr_t  remote_addr;
+    ogs_socket_t    fd;         /* GTPU socket of the control thread */
+
+    ogs_socket_t    tun_fd;     /* TUN for IPv4 */
+    ogs_socket_t    tun_fd6;    /* TUN for IPv6 */
+} ogs_gtp_fwd_t;
+
+typedef struct ogs_gtp_worker_s ogs_gtp_worker_t;
+typedef void (*ogs_gtp_worker_handler_f)(
+        ogs_gtp_worker_t *worker, ogs_socket_t fd);
+
+typedef struct ogs_gtp_fwd_table_s {
+    uint32_t        size;       /* Num of Local TEID */
+    ogs_gtp_fwd_t   **slot;     /* Indexed by Local TEID */
+
+    OGS_POOL(pool, ogs_gtp_fwd_t);
+    ogs_gtp_fwd_t   punt;       /* Shared when the pool is exhausted */
+
+    int             num_of_worker;
+    ogs_gtp_worker_t *worker;
+
+    ogs_list_t      retired;    /* Replaced, grace period not started */
+    ogs_list_t      grace;      /* Replaced, waiting for grace period */
+    unsigned long   snapshot[OGS_MAX_NUM_OF_GTPU_WORKER];
+} ogs_gtp_fwd_table_t;
+
+typedef struct ogs_gtp_worker_fd_s {
+    ogs_lnode_t     lnode;
+
+    ogs_gtp_worker_t *worker;
+    ogs_gtp_worker_handler_f handler;
+    ogs_poll_t      *poll;
+} ogs_gtp_worker_fd_t;
+
+struct ogs_gtp_worker_s {
+    int             index;
+
+    ogs_thread_t    *thread;
+    ogs_pollset_t   *pollset;
+    ogs_pkbuf_pool_t *pool;
+    ogs_pkbuf_cache_t *cache;   /* Owned by the worker thread */
+    ogs_gtp_batch_t batch;
+
+    ogs_list_t      gtpu_list;  /* SO_REUSEPORT GTP-U IPv4 Server List */
+    ogs_list_t      gtpu_list6; /* SO_REUSEPORT GTP-U IPv6 Server List */
+    ogs_sock_t      *gtpu_sock; /* GTP-U IPv4 Socket */
+    ogs_sock_t      *gtpu_sock6;/* GTP-U IPv6 Socket */
+
+    ogs_list_t      fd_list;    /* Other descriptors such as TUN queue */
+
+    ogs_gtp_worker_handler_f handler;
+    ogs_gtp_fwd_table_t *table;
+    void            *data;
+
+    /* Odd while handling packets, even while waiting in poll */
+    unsigned long   epoch;
+    int             terminate;
+};
+
+ogs_gtp_fwd_table_t *ogs_gtp_fwd_table_create(uint32_t size);
+void ogs_gtp_fwd_table_destroy(ogs_gtp_fwd_table_t *table);
+
+void ogs_gtp_fwd_update(ogs_gtp_fwd_table_t *table,
+        uint32_t teid, ogs_gtp_fwd_t *fwd);
+void ogs_gtp_fwd_remove(ogs_gtp_fwd_table_t *table, uint32_t teid);
+
+static ogs_inline ogs_gtp_fwd_t *ogs_gtp_fwd_find(
+        ogs_gtp_fwd_table_t *table, uint32_t teid)
+{
+    if (teid == 0 || teid > table->size)
+        return NULL;
+
+    return ogs_atomic_load(&table->slot[teid-1]);
+}
+
+void ogs_gtp_fwd_retire(ogs_gtp_fwd_table_t *table,
+        ogs_gtp_retired_t *retired, void (*free_cb)(void *));
+
+int ogs_gtp_worker_init(ogs_gtp_worker_t *worker, int num_of_worker,
+        ogs_list_t *list, ogs_list_t *list6,
+        ogs_gtp_worker_handler_f handler, ogs_gtp_fwd_table_t *table,
+        int batch_size, int num_of_packet, void *data);
+int ogs_gtp_worker_add_fd(ogs_gtp_worker_t *worker,
+        ogs_socket_t fd, ogs_gtp_worker_handler_f handler);
+int ogs_gtp_worker_run(ogs_gtp_worker_t *worker, int num_of_worker);
+void ogs_gtp_worker_stop(ogs_gtp_worker_t *worker, int num_of_worker);
+
+ogs_sock_t *ogs_gtp_worker_sock(ogs_gtp_worker_t *worker, int family);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_GTP_WORKER_H */
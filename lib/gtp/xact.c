@@ -38,6 +38,13 @@ static uint32_t g_xact_id = 0;
 
 static OGS_POOL(pool, ogs_gtp_xact_t);
 
+/*
+ * The last 1/16 of the pool is kept for answering requests with
+ * "No resources available" once the configured size is in use.
+ */
+#define GTP_XACT_RESERVE(__sIZE)        ((__sIZE)/16 + 1)
+static ogs_gtp_xact_stats_t g_stats;
+
 static ogs_gtp_xact_stage_t ogs_gtp_xact_get_stage(uint8_t type, uint32_t sqn);
 static int ogs_gtp_xact_delete(ogs_gtp_xact_t *xact);
 
@@ -47,8 +54,12 @@ static void holding_timeout(void *data);
 int ogs_gtp_xact_init(ogs_timer_mgr_t *timer_mgr, int size)
 {
     ogs_assert(ogs_gtp_xact_initialized == 0);
+    ogs_assert(size > 0);
 
-    ogs_pool_init(&pool, size);
+    ogs_pool_init(&pool, size + GTP_XACT_RESERVE(size));
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.size = size;
 
     g_xact_id = 0;
     g_timer_mgr = timer_mgr;
@@ -62,6 +73,10 @@ int ogs_gtp_xact_final(void)
 {
     ogs_assert(ogs_gtp_xact_initialized == 1);
 
+    ogs_info("GTP transactions size:%d peak:%d rejected:%llu",
+            g_stats.size, g_stats.peak,
+            (unsigned long long)g_stats.rejected);
+
     ogs_pool_final(&pool);
 
     ogs_gtp_xact_initialized = 0;
@@ -69,6 +84,37 @@ int ogs_gtp_xact_final(void)
     return OGS_OK;
 }
 
+static ogs_gtp_xact_t *xact_alloc(int limit)
+{
+    ogs_gtp_xact_t *xact = NULL;
+
+    if (pool.size - pool.avail >= limit)
+        return NULL;
+
+    ogs_pool_alloc(&pool, &xact);
+    ogs_assert(xact);
+    memset(xact, 0, sizeof *xact);
+    xact->index = ogs_pool_index(&pool, xact);
+
+    g_stats.used = pool.size - pool.avail;
+    if (g_stats.used > g_stats.peak)
+        g_stats.peak = g_stats.used;
+
+    return xact;
+}
+
+static void xact_reject(void)
+{
+    /* Log the first one and then every 1024th */
+    if ((g_stats.rejected++ & 1023) == 0)
+        ogs_error("No GTP transaction resources [%d in use, %llu rejected]",
+                g_stats.used, (unsigned long long)g_stats.rejected);
+}
+
+/*
+ * NULL once the configured size is in use. A relay such as the SGW
+ * answers the request it was relaying on that request's own xact.
+ */
 ogs_gtp_xact_t *ogs_gtp_xact_local_create(ogs_gtp_node_t *gnode,
         ogs_gtp_header_t *hdesc, ogs_pkbuf_t *pkbuf,
         void (*cb)(ogs_gtp_xact_t *xact, void *data), void *data)
@@ -80,10 +126,12 @@ ogs_gtp_xact_t *ogs_gtp_xact_local_create(ogs_gtp_node_t *gnode,
     ogs_assert(gnode);
     ogs_assert(hdesc);
 
-    ogs_pool_alloc(&pool, &xact);
-    ogs_assert(xact);
-    memset(xact, 0, sizeof *xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact = xact_alloc(g_stats.size);
+    if (!xact) {
+        xact_reject();
+        ogs_pkbuf_free(pkbuf);
+        return NULL;
+    }
 
     xact->org = OGS_GTP_LOCAL_ORIGINATOR;
     xact->xid = OGS_NEXT_ID(g_xact_id,
@@ -107,6 +155,9 @@ ogs_gtp_xact_t *ogs_gtp_xact_local_create(ogs_gtp_node_t *gnode,
 
     ogs_list_add(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?  
             &xact->gnode->local_list : &xact->gnode->remote_list, xact);
+    ogs_hash_set(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?
+            xact->gnode->local_hash : xact->gnode->remote_hash,
+            &xact->xid, sizeof(xact->xid), xact);
 
     rv = ogs_gtp_xact_update_tx(xact, hdesc, pkbuf);
     if (rv != OGS_OK) {
@@ -131,10 +182,9 @@ ogs_gtp_xact_t *ogs_gtp_xact_remote_create(ogs_gtp_node_t *gnode, uint32_t sqn)
 
     ogs_assert(gnode);
 
-    ogs_pool_alloc(&pool, &xact);
-    ogs_assert(xact);
-    memset(xact, 0, sizeof *xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact = xact_alloc(pool.size);
+    if (!xact)
+        return NULL;
 
     xact->org = OGS_GTP_REMOTE_ORIGINATOR;
     xact->xid = OGS_GTP_SQN_TO_XID(sqn);
@@ -150,6 +200,9 @@ ogs_gtp_xact_t *ogs_gtp_xact_remote_create(ogs_gtp_node_t *gnode, uint32_t sqn)
 
     ogs_list_add(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?  
             &xact->gnode->local_list : &xact->gnode->remote_list, xact);
+    ogs_hash_set(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?
+            xact->gnode->local_hash : xact->gnode->remote_hash,
+            &xact->xid, sizeof(xact->xid), xact);
 
     ogs_debug("[%d] %s Create  peer [%s]:%d",
             xact->xid,
@@ -630,6 +683,57 @@ static void holding_timeout(void *data)
 }
 
 
+/*
+ * A new request arrived while the configured transactions are all
+ * in use. Answer it from the reserve with "No resources available".
+ * The reserve xact absorbs retransmissions until its holding timer
+ * expires. If even the reserve is used up, the request is dropped and
+ * the peer backs off on its T3-RESPONSE timer.
+ */
+static int xact_overload(ogs_gtp_node_t *gnode, ogs_gtp_header_t *h)
+{
+    ogs_gtp_xact_t *xact = NULL;
+    uint8_t type = 0;
+
+    xact_reject();
+
+    switch (h->type) {
+    case OGS_GTP_CREATE_SESSION_REQUEST_TYPE:
+    case OGS_GTP_MODIFY_BEARER_REQUEST_TYPE:
+    case OGS_GTP_DELETE_SESSION_REQUEST_TYPE:
+    case OGS_GTP_RELEASE_ACCESS_BEARERS_REQUEST_TYPE:
+    case OGS_GTP_DOWNLINK_DATA_NOTIFICATION_TYPE:
+    case OGS_GTP_CREATE_BEARER_REQUEST_TYPE:
+    case OGS_GTP_UPDATE_BEARER_REQUEST_TYPE:
+    case OGS_GTP_DELETE_BEARER_REQUEST_TYPE:
+    case OGS_GTP_CREATE_INDIRECT_DATA_FORWARDING_TUNNEL_REQUEST_TYPE:
+    case OGS_GTP_DELETE_INDIRECT_DATA_FORWARDING_TUNNEL_REQUEST_TYPE:
+    case OGS_GTP_MODIFY_BEARER_COMMAND_TYPE:
+    case OGS_GTP_DELETE_BEARER_COMMAND_TYPE:
+    case OGS_GTP_BEARER_RESOURCE_COMMAND_TYPE:
+        /* The response or failure indication is the next message type */
+        type = h->type + 1;
+        break;
+    default:
+        return OGS_ERROR;
+    }
+
+    xact = ogs_gtp_xact_remote_create(gnode, h->sqn);
+    if (!xact)
+        return OGS_ERROR;
+
+    if (ogs_gtp_xact_update_rx(xact, h->type) != OGS_OK) {
+        ogs_gtp_xact_delete(xact);
+        return OGS_ERROR;
+    }
+
+    /* The peer's TEID is not known without decoding the request */
+    ogs_gtp_send_error_message(
+            xact, 0, type, OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+
+    return OGS_ERROR;
+}
+
 int ogs_gtp_xact_receive(
         ogs_gtp_node_t *gnode, ogs_gtp_header_t *h, ogs_gtp_xact_t **xact)
 {
@@ -641,9 +745,13 @@ int ogs_gtp_xact_receive(
     ogs_assert(h);
 
     new = ogs_gtp_xact_find_by_xid(gnode, h->type, OGS_GTP_SQN_TO_XID(h->sqn));
-    if (!new)
+    if (!new) {
+        if (pool.size - pool.avail >= g_stats.size)
+            return xact_overload(gnode, h);
+
         new = ogs_gtp_xact_remote_create(gnode, h->sqn);
-    ogs_assert(new);
+        ogs_assert(new);
+    }
 
     ogs_debug("[%d] %s Receive peer [%s]:%d",
             new->xid,
@@ -662,6 +770,14 @@ int ogs_gtp_xact_receive(
     return rv;
 }
 
+void ogs_gtp_xact_stats(ogs_gtp_xact_stats_t *stats)
+{
+    ogs_assert(stats);
+
+    g_stats.used = pool.size - pool.avail;
+    memcpy(stats, &g_stats, sizeof(*stats));
+}
+
 ogs_gtp_xact_t *ogs_gtp_xact_find(ogs_index_t index)
 {
     ogs_assert(index);
@@ -722,29 +838,29 @@ ogs_gtp_xact_t *ogs_gtp_xact_find_by_xid(
 {
     char buf[OGS_ADDRSTRLEN];
 
-    ogs_list_t *list = NULL;
+    ogs_hash_t *hash = NULL;
     ogs_gtp_xact_t *xact = NULL;
 
     ogs_assert(gnode);
 
     switch (ogs_gtp_xact_get_stage(type, xid)) {
     case GTP_XACT_INITIAL_STAGE:
-        list = &gnode->remote_list;
+        hash = gnode->remote_hash;
         break;
     case GTP_XACT_INTERMEDIATE_STAGE:
-        list = &gnode->local_list;
+        hash = gnode->local_hash;
         break;
     case GTP_XACT_FINAL_STAGE:
         if (xid & OGS_GTP_CMD_XACT_ID) {
             if (type == OGS_GTP_MODIFY_BEARER_FAILURE_INDICATION_TYPE ||
                 type == OGS_GTP_DELETE_BEARER_FAILURE_INDICATION_TYPE ||
                 type == OGS_GTP_BEARER_RESOURCE_FAILURE_INDICATION_TYPE) {
-                list = &gnode->local_list;
+                hash = gnode->local_hash;
             } else {
-                list = &gnode->remote_list;
+                hash = gnode->remote_hash;
             }
         } else {
-            list = &gnode->local_list;
+            hash = gnode->local_hash;
         }
         break;
     default:
@@ -752,16 +868,14 @@ ogs_gtp_xact_t *ogs_gtp_xact_find_by_xid(
         break;
     }
 
-    ogs_assert(list);
-    ogs_list_for_each(list, xact) {
-        if (xact->xid == xid) {
-            ogs_debug("[%d] %s Find    peer [%s]:%d",
-                    xact->xid,
-                    xact->org == OGS_GTP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
-                    OGS_ADDR(&gnode->remote_addr, buf),
-                    OGS_PORT(&gnode->remote_addr));
-            break;
-        }
+    ogs_assert(hash);
+    xact = ogs_hash_get(hash, &xid, sizeof(xid));
+    if (xact) {
+        ogs_debug("[%d] %s Find    peer [%s]:%d",
+                xact->xid,
+                xact->org == OGS_GTP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
+                OGS_ADDR(&gnode->remote_addr, buf),
+                OGS_PORT(&gnode->remote_addr));
     }
 
     return xact;
@@ -819,6 +933,9 @@ static int ogs_gtp_xact_delete(ogs_gtp_xact_t *xact)
     if (xact->assoc_xact)
         ogs_gtp_xact_deassociate(xact, xact->assoc_xact);
 
+    ogs_hash_set(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?
+            xact->gnode->local_hash : xact->gnode->remote_hash,
+            &xact->xid, sizeof(xact->xid), NULL);
     ogs_list_remove(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?
             &xact->gnode->local_list : &xact->gnode->remote_list, xact);
     ogs_pool_free(&pool, xact);
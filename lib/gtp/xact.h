@@ -83,8 +83,19 @@ typedef struct ogs_gtp_xact_s {
     struct ogs_gtp_xact_s *assoc_xact; /**< Associated transaction */
 } ogs_gtp_xact_t;
 
+/**
+ * Transaction occupancy
+ */
+typedef struct ogs_gtp_xact_stats_s {
+    int             size;           /**< Configured, excluding reserve */
+    int             used;           /**< Currently in use */
+    int             peak;           /**< High watermark of 'used' */
+    uint64_t        rejected;       /**< Requests refused for lack of xact */
+} ogs_gtp_xact_stats_t;
+
 int ogs_gtp_xact_init(ogs_timer_mgr_t *timer_mgr, int size);
 int ogs_gtp_xact_final(void);
+void ogs_gtp_xact_stats(ogs_gtp_xact_stats_t *stats);
 
 ogs_gtp_xact_t *ogs_gtp_xact_local_create(ogs_gtp_node_t *gnode,
         ogs_gtp_header_t *hdesc, ogs_pkbuf_t *pkbuf,
@@ -48,6 +48,10 @@ ogs_pfcp_node_t *ogs_pfcp_node_new(ogs_sockaddr_t *sa_list)
 
     ogs_list_init(&node->local_list);
     ogs_list_init(&node->remote_list);
+    node->local_hash = ogs_hash_make();
+    ogs_assert(node->local_hash);
+    node->remote_hash = ogs_hash_make();
+    ogs_assert(node->remote_hash);
 
     return node;
 }
@@ -60,6 +64,8 @@ void ogs_pfcp_node_free(ogs_pfcp_node_t *node)
         ogs_sock_destroy(node->sock);
 
     ogs_pfcp_xact_delete_all(node);
+    ogs_hash_destroy(node->local_hash);
+    ogs_hash_destroy(node->remote_hash);
 
     ogs_freeaddrinfo(node->sa_list);
     ogs_pool_free(&pool, node);
@@ -49,6 +49,8 @@ typedef struct ogs_pfcp_node_s {
 
     ogs_list_t      local_list;    
     ogs_list_t      remote_list;   
+    ogs_hash_t      *local_hash;    /* hash table (XID : local xact) */
+    ogs_hash_t      *remote_hash;   /* hash table (XID : remote xact) */
 
     ogs_pfcp_node_id_t  node_id;    /* Target Node ID */
     union {
@@ -103,6 +103,9 @@ ogs_pfcp_xact_t *ogs_pfcp_xact_local_create(ogs_pfcp_node_t *pnode,
 
     ogs_list_add(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?  
             &xact->pnode->local_list : &xact->pnode->remote_list, xact);
+    ogs_hash_set(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
+            xact->pnode->local_hash : xact->pnode->remote_hash,
+            &xact->xid, sizeof(xact->xid), xact);
 
     rv = ogs_pfcp_xact_update_tx(xact, hdesc, pkbuf);
     if (rv != OGS_OK) {
@@ -147,6 +150,9 @@ ogs_pfcp_xact_t *ogs_pfcp_xact_remote_create(
 
     ogs_list_add(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?  
             &xact->pnode->local_list : &xact->pnode->remote_list, xact);
+    ogs_hash_set(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
+            xact->pnode->local_hash : xact->pnode->remote_hash,
+            &xact->xid, sizeof(xact->xid), xact);
 
     ogs_debug("[%d] %s Create  peer [%s]:%d",
             xact->xid,
@@ -241,7 +247,7 @@ int ogs_pfcp_xact_update_tx(ogs_pfcp_xact_t *xact,
         return OGS_ERROR;
     }
 
-    if (h->type >= OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE)
+    if (hdesc->type >= OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE)
         ogs_pkbuf_push(pkbuf, OGS_PFCP_HEADER_LEN);
     else
         ogs_pkbuf_push(pkbuf, OGS_PFCP_HEADER_LEN - OGS_PFCP_SEID_LEN);
@@ -714,39 +720,37 @@ ogs_pfcp_xact_t *ogs_pfcp_xact_find_by_xid(
 {
     char buf[OGS_ADDRSTRLEN];
 
-    ogs_list_t *list = NULL;
+    ogs_hash_t *hash = NULL;
     ogs_pfcp_xact_t *xact = NULL;
 
     ogs_assert(pnode);
 
     switch (ogs_pfcp_xact_get_stage(type, xid)) {
     case PFCP_XACT_INITIAL_STAGE:
-        list = &pnode->remote_list;
+        hash = pnode->remote_hash;
         break;
     case PFCP_XACT_INTERMEDIATE_STAGE:
-        list = &pnode->local_list;
+        hash = pnode->local_hash;
         break;
     case PFCP_XACT_FINAL_STAGE:
         if (xid & PFCP_MAX_XACT_ID)
-            list = &pnode->remote_list;
+            hash = pnode->remote_hash;
         else
-            list = &pnode->local_list;
+            hash = pnode->local_hash;
         break;
     default:
         ogs_assert_if_reached();
         break;
     }
 
-    ogs_assert(list);
-    ogs_list_for_each(list, xact) {
-        if (xact->xid == xid) {
-            ogs_debug("[%d] %s Find    peer [%s]:%d",
-                    xact->xid,
-                    xact->org == OGS_PFCP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
-                    OGS_ADDR(&pnode->remote_addr, buf),
-                    OGS_PORT(&pnode->remote_addr));
-            break;
-        }
+    ogs_assert(hash);
+    xact = ogs_hash_get(hash, &xid, sizeof(xid));
+    if (xact) {
+        ogs_debug("[%d] %s Find    peer [%s]:%d",
+                xact->xid,
+                xact->org == OGS_PFCP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
+                OGS_ADDR(&pnode->remote_addr, buf),
+                OGS_PORT(&pnode->remote_addr));
     }
 
     return xact;
@@ -777,6 +781,9 @@ static int ogs_pfcp_xact_delete(ogs_pfcp_xact_t *xact)
     if (xact->tm_holding)
         ogs_timer_delete(xact->tm_holding);
 
+    ogs_hash_set(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
+            xact->pnode->local_hash : xact->pnode->remote_hash,
+            &xact->xid, sizeof(xact->xid), NULL);
     ogs_list_remove(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
             &xact->pnode->local_list : &xact->pnode->remote_list, xact);
     ogs_pool_free(&pool, xact);
@@ -21,13 +21,31 @@
 
 int __ogs_s1ap_domain;
 
+void ogs_s1ap_init_message(ogs_s1ap_message_t *message)
+{
+    ogs_asn_arena_t *arena = NULL;
+
+    ogs_assert(message);
+
+    memset(message, 0, sizeof(ogs_s1ap_message_t));
+
+    arena = ogs_asn_arena_create();
+    ogs_asn_arena_enter(arena);
+}
+
 ogs_pkbuf_t *ogs_s1ap_encode(ogs_s1ap_message_t *message)
 {
     asn_enc_rval_t enc_ret = {0};
     ogs_pkbuf_t *pkbuf = NULL;
+    ogs_asn_arena_t *arena = NULL;
 
     ogs_assert(message);
 
+    /* Close the arena opened by ogs_s1ap_init_message() */
+    arena = ogs_asn_arena_find(message->choice.initiatingMessage);
+    if (arena && arena == ogs_asn_arena_current())
+        ogs_asn_arena_leave(arena);
+
     if (ogs_log_get_domain_level(OGS_LOG_DOMAIN) >= OGS_LOG_TRACE)
         asn_fprint(stdout, &asn_DEF_S1AP_S1AP_PDU, message);
 
@@ -36,7 +54,11 @@ ogs_pkbuf_t *ogs_s1ap_encode(ogs_s1ap_message_t *message)
 
     enc_ret = aper_encode_to_buffer(&asn_DEF_S1AP_S1AP_PDU, NULL,
                     message, pkbuf->data, OGS_MAX_SDU_LEN);
-    ogs_s1ap_free(message);
+
+    /* IEs built before the arena was opened are still freed one by one */
+    ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1AP_S1AP_PDU, message);
+    if (arena)
+        ogs_asn_arena_destroy(arena);
 
     if (enc_ret.encoded < 0) {
         ogs_error("Failed to encode S1AP-PDU[%d]", (int)enc_ret.encoded);
@@ -52,6 +74,7 @@ ogs_pkbuf_t *ogs_s1ap_encode(ogs_s1ap_message_t *message)
 int ogs_s1ap_decode(ogs_s1ap_message_t *message, ogs_pkbuf_t *pkbuf)
 {
     asn_dec_rval_t dec_ret = {0};
+    ogs_asn_arena_t *arena = NULL;
 
     ogs_assert(message);
     ogs_assert(pkbuf);
@@ -59,12 +82,20 @@ int ogs_s1ap_decode(ogs_s1ap_message_t *message, ogs_pkbuf_t *pkbuf)
     ogs_assert(pkbuf->len);
 
     memset((void *)message, 0, sizeof(ogs_s1ap_message_t));
+
+    /* The whole PDU lives in one arena, released by ogs_s1ap_free() */
+    arena = ogs_asn_arena_create();
+    ogs_asn_arena_enter(arena);
     dec_ret = aper_decode(NULL, &asn_DEF_S1AP_S1AP_PDU, (void **)&message, 
             pkbuf->data, pkbuf->len, 0, 0);
+    ogs_asn_arena_leave(arena);
 
-    if (dec_ret.code != RC_OK) {
+    if (dec_ret.code != RC_OK ||
+        ogs_asn_arena_find(message->choice.initiatingMessage) != arena) {
         ogs_warn("Failed to decode S1AP-PDU[code:%d,consumed:%d]",
                 dec_ret.code, (int)dec_ret.consumed);
+        ogs_asn_arena_destroy(arena);
+        memset((void *)message, 0, sizeof(ogs_s1ap_message_t));
         return OGS_ERROR;
     }
 
@@ -76,8 +107,17 @@ int ogs_s1ap_decode(ogs_s1ap_message_t *message, ogs_pkbuf_t *pkbuf)
 
 int ogs_s1ap_free(ogs_s1ap_message_t *message)
 {
+    ogs_asn_arena_t *arena = NULL;
+
     ogs_assert(message);
 
+    arena = ogs_asn_arena_find(message->choice.initiatingMessage);
+    if (arena) {
+        ogs_asn_arena_destroy(arena);
+        memset((void *)message, 0, sizeof(ogs_s1ap_message_t));
+        return OGS_OK;
+    }
+
     ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1AP_S1AP_PDU, message);
 
     return OGS_OK;
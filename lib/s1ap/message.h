@@ -52,6 +52,12 @@ extern "C" {
 
 typedef struct S1AP_S1AP_PDU ogs_s1ap_message_t;
 
+/*
+ * Clears a PDU about to be built. Until ogs_s1ap_encode(), CALLOC() on
+ * this thread allocates from an arena that the encoder releases at once.
+ */
+void ogs_s1ap_init_message(ogs_s1ap_message_t *message);
+
 int ogs_s1ap_decode(ogs_s1ap_message_t *message, ogs_pkbuf_t *pkbuf);
 ogs_pkbuf_t *ogs_s1ap_encode(ogs_s1ap_message_t *message);
 int ogs_s1ap_free(ogs_s1ap_message_t *message);
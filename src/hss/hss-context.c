@@ -262,6 +262,12 @@ int hss_db_init()
         self.subscriberCollection = mongoc_client_get_collection(
             ogs_mongoc()->client, ogs_mongoc()->name, "subscribers");
         ogs_assert(self.subscriberCollection);
+
+        self.subscription_cache = ogs_cache_create(
+                ogs_config()->db_uri, "subscribers",
+                (size_t)ogs_config()->parameter.db_cache * 1024,
+                ogs_time_from_sec(ogs_config()->parameter.db_cache_ttl),
+                NULL, NULL);
     }
 
     return OGS_OK;
@@ -269,6 +275,9 @@ int hss_db_init()
 
 int hss_db_final()
 {
+    ogs_cache_destroy(self.subscription_cache);
+    self.subscription_cache = NULL;
+
     if (self.subscriberCollection) {
         mongoc_collection_destroy(self.subscriberCollection);
     }
@@ -278,6 +287,49 @@ int hss_db_final()
     return OGS_OK;
 }
 
+static int auth_info_parse(const bson_t *document,
+        hss_db_auth_info_t *auth_info)
+{
+    bson_iter_t iter;
+    bson_iter_t inner_iter;
+    char buf[HSS_KEY_LEN];
+    char *utf8 = NULL;
+    uint32_t length = 0;
+
+    if (!bson_iter_init_find(&iter, document, "security")) {
+        ogs_error("No 'security' field in this document");
+        return OGS_ERROR;
+    }
+
+    memset(auth_info, 0, sizeof(hss_db_auth_info_t));
+    bson_iter_recurse(&iter, &inner_iter);
+    while (bson_iter_next(&inner_iter)) {
+        const char *key = bson_iter_key(&inner_iter);
+
+        if (!strcmp(key, "k") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            memcpy(auth_info->k, OGS_HEX(utf8, length, buf), HSS_KEY_LEN);
+        } else if (!strcmp(key, "opc") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            auth_info->use_opc = 1;
+            memcpy(auth_info->opc, OGS_HEX(utf8, length, buf), HSS_KEY_LEN);
+        } else if (!strcmp(key, "op") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            memcpy(auth_info->op, OGS_HEX(utf8, length, buf), HSS_KEY_LEN);
+        } else if (!strcmp(key, "amf") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            memcpy(auth_info->amf, OGS_HEX(utf8, length, buf), HSS_AMF_LEN);
+        } else if (!strcmp(key, "rand") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            memcpy(auth_info->rand, OGS_HEX(utf8, length, buf), OGS_RAND_LEN);
+        } else if (!strcmp(key, "sqn") && BSON_ITER_HOLDS_INT64(&inner_iter)) {
+            auth_info->sqn = bson_iter_int64(&inner_iter);
+        }
+    }
+
+    return OGS_OK;
+}
+
 int hss_db_auth_info(
     char *imsi_bcd, hss_db_auth_info_t *auth_info)
 {
@@ -286,11 +338,6 @@ int hss_db_auth_info(
     bson_t *query = NULL;
     bson_error_t error;
     const bson_t *document;
-    bson_iter_t iter;
-    bson_iter_t inner_iter;
-    char buf[HSS_KEY_LEN];
-    char *utf8 = NULL;
-    uint32_t length = 0;
 
     ogs_assert(imsi_bcd);
     ogs_assert(auth_info);
@@ -320,38 +367,7 @@ int hss_db_auth_info(
         goto out;
     }
 
-    if (!bson_iter_init_find(&iter, document, "security")) {
-        ogs_error("No 'security' field in this document");
-
-        rv = OGS_ERROR;
-        goto out;
-    }
-
-    memset(auth_info, 0, sizeof(hss_db_auth_info_t));
-    bson_iter_recurse(&iter, &inner_iter);
-    while (bson_iter_next(&inner_iter)) {
-        const char *key = bson_iter_key(&inner_iter);
-
-        if (!strcmp(key, "k") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            memcpy(auth_info->k, OGS_HEX(utf8, length, buf), HSS_KEY_LEN);
-        } else if (!strcmp(key, "opc") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            auth_info->use_opc = 1;
-            memcpy(auth_info->opc, OGS_HEX(utf8, length, buf), HSS_KEY_LEN);
-        } else if (!strcmp(key, "op") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            memcpy(auth_info->op, OGS_HEX(utf8, length, buf), HSS_KEY_LEN);
-        } else if (!strcmp(key, "amf") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            memcpy(auth_info->amf, OGS_HEX(utf8, length, buf), HSS_AMF_LEN);
-        } else if (!strcmp(key, "rand") && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            memcpy(auth_info->rand, OGS_HEX(utf8, length, buf), OGS_RAND_LEN);
-        } else if (!strcmp(key, "sqn") && BSON_ITER_HOLDS_INT64(&inner_iter)) {
-            auth_info->sqn = bson_iter_int64(&inner_iter);
-        }
-    }
+    rv = auth_info_parse(document, auth_info);
 
 out:
     if (query) bson_destroy(query);
@@ -362,34 +378,110 @@ out:
     return rv;
 }
 
-int hss_db_update_rand_and_sqn(
-    char *imsi_bcd, uint8_t *rand, uint64_t sqn)
+/*
+ * Read the subscriber's keys and reserve 'num_of_sqn' SQNs with one
+ * findAndModify. auth_info->sqn is the first reserved SQN and
+ * auth_info->rand is the stored RAND, which is generated and saved
+ * here if the subscriber has none yet.
+ */
+int hss_db_auth_info_reserve_sqn(char *imsi_bcd,
+        int num_of_sqn, hss_db_auth_info_t *auth_info)
 {
     int rv = OGS_OK;
     bson_t *query = NULL;
     bson_t *update = NULL;
+    bson_t reply;
     bson_error_t error;
+    bson_iter_t iter;
+    bson_t document;
+    const uint8_t *data = NULL;
+    uint32_t length = 0;
+    uint64_t max_sqn = HSS_MAX_SQN;
+    uint8_t zero[OGS_RAND_LEN];
     char printable_rand[128];
 
-    ogs_assert(rand);
-    ogs_hex_to_ascii(rand, OGS_RAND_LEN, printable_rand, sizeof(printable_rand));
+    ogs_assert(imsi_bcd);
+    ogs_assert(num_of_sqn > 0);
+    ogs_assert(auth_info);
 
     ogs_thread_mutex_lock(&self.db_lock);
 
     query = BCON_NEW("imsi", BCON_UTF8(imsi_bcd));
-    update = BCON_NEW("$set",
-            "{",
-                "security.rand", printable_rand,
-                "security.sqn", BCON_INT64(sqn),
-            "}");
+    update = BCON_NEW(
+            "$inc", "{", "security.sqn", BCON_INT64(32 * num_of_sqn), "}");
 
-    if (!mongoc_collection_update(self.subscriberCollection,
-            MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
-        ogs_error("mongoc_collection_update() failure: %s", error.message);
+    /* Returns the document before the update */
+    if (!mongoc_collection_find_and_modify(self.subscriberCollection,
+            query, NULL, update, NULL, false, false, false, &reply, &error)) {
+        ogs_error("mongoc_collection_find_and_modify() failure: %s",
+                error.message);
+
+        rv = OGS_ERROR;
+        goto out;
+    }
+
+    if (!bson_iter_init_find(&iter, &reply, "value") ||
+        !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+        ogs_warn("Cannot find IMSI in DB : %s", imsi_bcd);
+
+        rv = OGS_ERROR;
+        goto reply;
+    }
+
+    bson_iter_document(&iter, &length, &data);
+    if (!bson_init_static(&document, data, length)) {
+        ogs_error("Invalid document for IMSI : %s", imsi_bcd);
 
         rv = OGS_ERROR;
+        goto reply;
+    }
+
+    rv = auth_info_parse(&document, auth_info);
+    if (rv != OGS_OK)
+        goto reply;
+
+    auth_info->sqn &= max_sqn;
+
+    /* SQN is wrapped around in the DB only when it overflows */
+    if (auth_info->sqn + 32 * num_of_sqn > max_sqn) {
+        bson_destroy(update);
+        update = BCON_NEW("$bit",
+                "{",
+                    "security.sqn",
+                    "{", "and", BCON_INT64(max_sqn), "}",
+                "}");
+        if (!mongoc_collection_update(self.subscriberCollection,
+                MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
+            ogs_error("mongoc_collection_update() failure: %s",
+                    error.message);
+
+            rv = OGS_ERROR;
+            goto reply;
+        }
+    }
+
+    /* The stored RAND is kept; one is saved only if it was never set */
+    memset(zero, 0, sizeof(zero));
+    if (memcmp(auth_info->rand, zero, OGS_RAND_LEN) == 0) {
+        ogs_random(auth_info->rand, OGS_RAND_LEN);
+        ogs_hex_to_ascii(auth_info->rand, OGS_RAND_LEN,
+                printable_rand, sizeof(printable_rand));
+
+        bson_destroy(update);
+        update = BCON_NEW("$set",
+                "{", "security.rand", printable_rand, "}");
+        if (!mongoc_collection_update(self.subscriberCollection,
+                MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
+            ogs_error("mongoc_collection_update() failure: %s",
+                    error.message);
+
+            rv = OGS_ERROR;
+        }
     }
 
+reply:
+    bson_destroy(&reply);
+out:
     if (query) bson_destroy(query);
     if (update) bson_destroy(update);
 
@@ -398,35 +490,27 @@ int hss_db_update_rand_and_sqn(
     return rv;
 }
 
-int hss_db_increment_sqn(char *imsi_bcd)
+int hss_db_update_rand_and_sqn(
+    char *imsi_bcd, uint8_t *rand, uint64_t sqn)
 {
     int rv = OGS_OK;
     bson_t *query = NULL;
     bson_t *update = NULL;
     bson_error_t error;
-    uint64_t max_sqn = HSS_MAX_SQN;
+    char printable_rand[128];
+
+    ogs_assert(rand);
+    ogs_hex_to_ascii(rand, OGS_RAND_LEN, printable_rand, sizeof(printable_rand));
 
     ogs_thread_mutex_lock(&self.db_lock);
 
     query = BCON_NEW("imsi", BCON_UTF8(imsi_bcd));
-    update = BCON_NEW("$inc",
+    update = BCON_NEW("$set",
             "{",
-                "security.sqn", BCON_INT64(32),
+                "security.rand", printable_rand,
+                "security.sqn", BCON_INT64(sqn),
             "}");
-    if (!mongoc_collection_update(self.subscriberCollection,
-            MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
-        ogs_error("mongoc_collection_update() failure: %s", error.message);
-
-        rv = OGS_ERROR;
-        goto out;
-    }
-    bson_destroy(update);
 
-    update = BCON_NEW("$bit",
-            "{",
-                "security.sqn", 
-                "{", "and", BCON_INT64(max_sqn), "}",
-            "}");
     if (!mongoc_collection_update(self.subscriberCollection,
             MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
         ogs_error("mongoc_collection_update() failure: %s", error.message);
@@ -434,7 +518,6 @@ int hss_db_increment_sqn(char *imsi_bcd)
         rv = OGS_ERROR;
     }
 
-out:
     if (query) bson_destroy(query);
     if (update) bson_destroy(update);
 
@@ -455,10 +538,16 @@ int hss_db_subscription_data(
     bson_iter_t child1_iter, child2_iter, child3_iter, child4_iter;
     const char *utf8 = NULL;
     uint32_t length = 0;
+    uint64_t version;
 
     ogs_assert(imsi_bcd);
     ogs_assert(subscription_data);
 
+    if (ogs_cache_get(self.subscription_cache, imsi_bcd, subscription_data))
+        return OGS_OK;
+
+    version = ogs_cache_version(self.subscription_cache);
+
     ogs_thread_mutex_lock(&self.db_lock);
 
     query = BCON_NEW("imsi", BCON_UTF8(imsi_bcd));
@@ -682,6 +771,17 @@ int hss_db_subscription_data(
         }
     }
 
+    if (self.subscription_cache &&
+        bson_iter_init_find(&iter, document, "_id") &&
+        BSON_ITER_HOLDS_OID(&iter)) {
+        ogs_diam_s6a_subscription_data_t *data = malloc(sizeof(*data));
+        if (data) {
+            memcpy(data, subscription_data, sizeof(*data));
+            ogs_cache_set(self.subscription_cache, version, imsi_bcd,
+                    bson_iter_oid(&iter)->bytes, data, sizeof(*data));
+        }
+    }
+
 out:
     if (query) bson_destroy(query);
     if (cursor) mongoc_cursor_destroy(cursor);
@@ -32,6 +32,8 @@ extern "C" {
 
 #define HSS_MAX_SQN                 0x7ffffffffff
 
+#define HSS_MAX_NUM_OF_VECTOR       5
+
 extern int __hss_log_domain;
 
 #undef OGS_LOG_DOMAIN
@@ -53,6 +55,8 @@ typedef struct _hss_context_t {
 
     void                *subscriberCollection;
     ogs_thread_mutex_t  db_lock;
+
+    struct ogs_cache_s  *subscription_cache;  /* Keyed by IMSI */
 } hss_context_t;
 
 void hss_context_init(void);
@@ -65,8 +69,9 @@ int hss_db_init(void);
 int hss_db_final(void);
 
 int hss_db_auth_info(char *imsi_bcd, hss_db_auth_info_t *auth_info);
+int hss_db_auth_info_reserve_sqn(char *imsi_bcd,
+        int num_of_sqn, hss_db_auth_info_t *auth_info);
 int hss_db_update_rand_and_sqn(char *imsi_bcd, uint8_t *rand, uint64_t sqn);
-int hss_db_increment_sqn(char *imsi_bcd);
 
 int hss_db_subscription_data(
     char *imsi_bcd, ogs_diam_s6a_subscription_data_t *subscription_data);
@@ -67,7 +67,11 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     uint8_t mac_s[MAC_S_LEN];
 
     hss_db_auth_info_t auth_info;
-    uint8_t zero[OGS_RAND_LEN];
+    uint8_t rand[HSS_MAX_NUM_OF_VECTOR][OGS_RAND_LEN];
+    uint8_t *auts = NULL;
+    uint8_t *visited_plmn_id = NULL;
+    uint32_t num_of_vector = 1;
+    uint32_t i;
     int rv;
     uint32_t result_code = 0;
 	
@@ -88,124 +92,148 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     ogs_cpystrn(imsi_bcd, (char*)hdr->avp_value->os.data, 
         ogs_min(hdr->avp_value->os.len, OGS_MAX_IMSI_BCD_LEN)+1);
 
-    rv = hss_db_auth_info(imsi_bcd, &auth_info);
-    if (rv != OGS_OK) {
-        result_code = OGS_DIAM_S6A_ERROR_USER_UNKNOWN;
-        goto out;
-    }
-
-    memset(zero, 0, sizeof(zero));
-    if (memcmp(auth_info.rand, zero, OGS_RAND_LEN) == 0) {
-        ogs_random(auth_info.rand, OGS_RAND_LEN);
-    }
-
-    if (auth_info.use_opc)
-        memcpy(opc, auth_info.opc, sizeof(opc));
-    else
-        milenage_opc(auth_info.k, auth_info.op, opc);
-
     ret = fd_msg_search_avp(qry, ogs_diam_s6a_req_eutran_auth_info, &avp);
     ogs_assert(ret == 0);
     if (avp) {
-        ret = fd_avp_search_avp(avp, ogs_diam_s6a_re_synchronization_info, &avpch);
+        ret = fd_avp_search_avp(avp,
+                ogs_diam_s6a_number_of_requested_vectors, &avpch);
         ogs_assert(ret == 0);
         if (avpch) {
             ret = fd_msg_avp_hdr(avpch, &hdr);
             ogs_assert(ret == 0);
-            hss_auc_sqn(opc, auth_info.k, hdr->avp_value->os.data, sqn, mac_s);
-            if (memcmp(mac_s, hdr->avp_value->os.data +
-                        OGS_RAND_LEN + HSS_SQN_LEN, MAC_S_LEN) == 0) {
-                ogs_random(auth_info.rand, OGS_RAND_LEN);
-                auth_info.sqn = ogs_buffer_to_uint64(sqn, HSS_SQN_LEN);
-                /* 33.102 C.3.4 Guide : IND + 1 */
-                auth_info.sqn = (auth_info.sqn + 32 + 1) & HSS_MAX_SQN;
-            } else {
-                ogs_error("Re-synch MAC failed for IMSI:`%s`", imsi_bcd);
-                ogs_log_print(OGS_LOG_ERROR, "MAC_S: ");
-                ogs_log_hexdump(OGS_LOG_ERROR, mac_s, MAC_S_LEN);
-                ogs_log_hexdump(OGS_LOG_ERROR,
-                    (void*)(hdr->avp_value->os.data + 
-                        OGS_RAND_LEN + HSS_SQN_LEN),
-                    MAC_S_LEN);
-                ogs_log_print(OGS_LOG_ERROR, "SQN: ");
-                ogs_log_hexdump(OGS_LOG_ERROR, sqn, HSS_SQN_LEN);
-                result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
-                goto out;
-            }
+            num_of_vector = ogs_max(1, ogs_min(
+                    hdr->avp_value->u32, HSS_MAX_NUM_OF_VECTOR));
         }
-    }
-
-    rv = hss_db_update_rand_and_sqn(imsi_bcd, auth_info.rand, auth_info.sqn);
-    if (rv != OGS_OK) {
-        ogs_error("Cannot update rand and sqn for IMSI:'%s'", imsi_bcd);
-        result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
-        goto out;
-    }
 
-    rv = hss_db_increment_sqn(imsi_bcd);
-    if (rv != OGS_OK) {
-        ogs_error("Cannot increment sqn for IMSI:'%s'", imsi_bcd);
-        result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
-        goto out;
+        ret = fd_avp_search_avp(avp, ogs_diam_s6a_re_synchronization_info, &avpch);
+        ogs_assert(ret == 0);
+        if (avpch) {
+            ret = fd_msg_avp_hdr(avpch, &hdr);
+            ogs_assert(ret == 0);
+            auts = hdr->avp_value->os.data;
+        }
     }
 
     ret = fd_msg_search_avp(qry, ogs_diam_s6a_visited_plmn_id, &avp);
     ogs_assert(ret == 0);
     ret = fd_msg_avp_hdr(avp, &hdr);
     ogs_assert(ret == 0);
+    visited_plmn_id = hdr->avp_value->os.data;
 #if 0  // TODO : check visited_plmn_id
     memcpy(visited_plmn_id, hdr->avp_value->os.data, hdr->avp_value->os.len);
 #endif
 
-    milenage_generate(opc, auth_info.amf, auth_info.k,
-        ogs_uint64_to_buffer(auth_info.sqn, HSS_SQN_LEN, sqn), auth_info.rand,
-        autn, ik, ck, ak, xres, &xres_len);
-    hss_auc_kasme(ck, ik, hdr->avp_value->os.data, sqn, ak, kasme);
+    if (auts) {
+        rv = hss_db_auth_info(imsi_bcd, &auth_info);
+        if (rv != OGS_OK) {
+            result_code = OGS_DIAM_S6A_ERROR_USER_UNKNOWN;
+            goto out;
+        }
+
+        if (auth_info.use_opc)
+            memcpy(opc, auth_info.opc, sizeof(opc));
+        else
+            milenage_opc(auth_info.k, auth_info.op, opc);
+
+        hss_auc_sqn(opc, auth_info.k, auts, sqn, mac_s);
+        if (memcmp(mac_s, auts + OGS_RAND_LEN + HSS_SQN_LEN, MAC_S_LEN) != 0) {
+            ogs_error("Re-synch MAC failed for IMSI:`%s`", imsi_bcd);
+            ogs_log_print(OGS_LOG_ERROR, "MAC_S: ");
+            ogs_log_hexdump(OGS_LOG_ERROR, mac_s, MAC_S_LEN);
+            ogs_log_hexdump(OGS_LOG_ERROR,
+                (void*)(auts + OGS_RAND_LEN + HSS_SQN_LEN), MAC_S_LEN);
+            ogs_log_print(OGS_LOG_ERROR, "SQN: ");
+            ogs_log_hexdump(OGS_LOG_ERROR, sqn, HSS_SQN_LEN);
+            result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
+            goto out;
+        }
+
+        auth_info.sqn = ogs_buffer_to_uint64(sqn, HSS_SQN_LEN);
+        /* 33.102 C.3.4 Guide : IND + 1 */
+        auth_info.sqn = (auth_info.sqn + 32 + 1) & HSS_MAX_SQN;
+
+        ogs_random(auth_info.rand, OGS_RAND_LEN);
+        rv = hss_db_update_rand_and_sqn(imsi_bcd, auth_info.rand,
+                (auth_info.sqn + 32 * num_of_vector) & HSS_MAX_SQN);
+        if (rv != OGS_OK) {
+            ogs_error("Cannot update rand and sqn for IMSI:'%s'", imsi_bcd);
+            result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
+            goto out;
+        }
+    } else {
+        rv = hss_db_auth_info_reserve_sqn(
+                imsi_bcd, num_of_vector, &auth_info);
+        if (rv != OGS_OK) {
+            result_code = OGS_DIAM_S6A_ERROR_USER_UNKNOWN;
+            goto out;
+        }
+
+        if (auth_info.use_opc)
+            memcpy(opc, auth_info.opc, sizeof(opc));
+        else
+            milenage_opc(auth_info.k, auth_info.op, opc);
+    }
+
+    /* The first vector uses the stored RAND, the others a fresh one */
+    memcpy(rand[0], auth_info.rand, OGS_RAND_LEN);
+    for (i = 1; i < num_of_vector; i++)
+        ogs_random(rand[i], OGS_RAND_LEN);
 
     /* Set the Authentication-Info */
     ret = fd_msg_avp_new(ogs_diam_s6a_authentication_info, 0, &avp);
     ogs_assert(ret == 0);
-    ret = fd_msg_avp_new(ogs_diam_s6a_e_utran_vector, 0, &avp_e_utran_vector);
-    ogs_assert(ret == 0);
 
-    ret = fd_msg_avp_new(ogs_diam_s6a_rand, 0, &avp_rand);
-    ogs_assert(ret == 0);
-    val.os.data = auth_info.rand;
-    val.os.len = HSS_KEY_LEN;
-    ret = fd_msg_avp_setvalue(avp_rand, &val);
-    ogs_assert(ret == 0);
-    ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_rand);
-    ogs_assert(ret == 0);
+    for (i = 0; i < num_of_vector; i++) {
+        milenage_generate(opc, auth_info.amf, auth_info.k,
+            ogs_uint64_to_buffer((auth_info.sqn + 32 * i) & HSS_MAX_SQN,
+                HSS_SQN_LEN, sqn), rand[i],
+            autn, ik, ck, ak, xres, &xres_len);
+        hss_auc_kasme(ck, ik, visited_plmn_id, sqn, ak, kasme);
 
-    ret = fd_msg_avp_new(ogs_diam_s6a_xres, 0, &avp_xres);
-    ogs_assert(ret == 0);
-    val.os.data = xres;
-    val.os.len = xres_len;
-    ret = fd_msg_avp_setvalue(avp_xres, &val);
-    ogs_assert(ret == 0);
-    ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_xres);
-    ogs_assert(ret == 0);
+        ret = fd_msg_avp_new(ogs_diam_s6a_e_utran_vector,
+                0, &avp_e_utran_vector);
+        ogs_assert(ret == 0);
 
-    ret = fd_msg_avp_new(ogs_diam_s6a_autn, 0, &avp_autn);
-    ogs_assert(ret == 0);
-    val.os.data = autn;
-    val.os.len = OGS_AUTN_LEN;
-    ret = fd_msg_avp_setvalue(avp_autn, &val);
-    ogs_assert(ret == 0);
-    ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_autn);
-    ogs_assert(ret == 0);
+        ret = fd_msg_avp_new(ogs_diam_s6a_rand, 0, &avp_rand);
+        ogs_assert(ret == 0);
+        val.os.data = rand[i];
+        val.os.len = OGS_RAND_LEN;
+        ret = fd_msg_avp_setvalue(avp_rand, &val);
+        ogs_assert(ret == 0);
+        ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_rand);
+        ogs_assert(ret == 0);
 
-    ret = fd_msg_avp_new(ogs_diam_s6a_kasme, 0, &avp_kasme);
-    ogs_assert(ret == 0);
-    val.os.data = kasme;
-    val.os.len = OGS_SHA256_DIGEST_SIZE;
-    ret = fd_msg_avp_setvalue(avp_kasme, &val);
-    ogs_assert(ret == 0);
-    ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_kasme);
-    ogs_assert(ret == 0);
+        ret = fd_msg_avp_new(ogs_diam_s6a_xres, 0, &avp_xres);
+        ogs_assert(ret == 0);
+        val.os.data = xres;
+        val.os.len = xres_len;
+        ret = fd_msg_avp_setvalue(avp_xres, &val);
+        ogs_assert(ret == 0);
+        ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_xres);
+        ogs_assert(ret == 0);
+
+        ret = fd_msg_avp_new(ogs_diam_s6a_autn, 0, &avp_autn);
+        ogs_assert(ret == 0);
+        val.os.data = autn;
+        val.os.len = OGS_AUTN_LEN;
+        ret = fd_msg_avp_setvalue(avp_autn, &val);
+        ogs_assert(ret == 0);
+        ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_autn);
+        ogs_assert(ret == 0);
+
+        ret = fd_msg_avp_new(ogs_diam_s6a_kasme, 0, &avp_kasme);
+        ogs_assert(ret == 0);
+        val.os.data = kasme;
+        val.os.len = OGS_SHA256_DIGEST_SIZE;
+        ret = fd_msg_avp_setvalue(avp_kasme, &val);
+        ogs_assert(ret == 0);
+        ret = fd_msg_avp_add(avp_e_utran_vector, MSG_BRW_LAST_CHILD, avp_kasme);
+        ogs_assert(ret == 0);
+
+        ret = fd_msg_avp_add(avp, MSG_BRW_LAST_CHILD, avp_e_utran_vector);
+        ogs_assert(ret == 0);
+    }
 
-    ret = fd_msg_avp_add(avp, MSG_BRW_LAST_CHILD, avp_e_utran_vector);
-    ogs_assert(ret == 0);
     ret = fd_msg_avp_add(ans, MSG_BRW_LAST_CHILD, avp);
     ogs_assert(ret == 0);
 
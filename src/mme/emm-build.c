@@ -304,6 +304,7 @@ ogs_pkbuf_t *emm_build_security_mode_command(mme_ue_t *mme_ue)
             mme_ue->kasme, mme_ue->knas_int);
     mme_kdf_nas(MME_KDF_NAS_ENC_ALG, mme_ue->selected_enc_algorithm,
             mme_ue->kasme, mme_ue->knas_enc);
+    nas_security_key_setup(mme_ue);
 
     return nas_security_encode(mme_ue, &message);
 }
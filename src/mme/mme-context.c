@@ -20,6 +20,7 @@
 #include "ogs-sctp.h"
 
 #include "mme-context.h"
+#include "mme-m-tmsi.h"
 #include "mme-event.h"
 #include "mme-timer.h"
 #include "nas-path.h"
@@ -29,6 +30,11 @@
 
 #define MAX_CELL_PER_ENB            8
 
+typedef struct tai_enb_list_s {
+    ogs_tai_t       tai;        /* key of tai_enb_hash */
+    ogs_list_t      enb_list;   /* mme_enb_tai_t */
+} tai_enb_list_t;
+
 static mme_context_t self;
 static ogs_diam_config_t g_diam_conf;
 
@@ -134,9 +140,10 @@ void mme_context_init()
 
     self.enb_addr_hash = ogs_hash_make();
     self.enb_id_hash = ogs_hash_make();
-    self.mme_ue_s1ap_id_hash = ogs_hash_make();
-    self.imsi_ue_hash = ogs_hash_make();
-    self.guti_ue_hash = ogs_hash_make();
+    self.mme_ue_s1ap_id_hash = ogs_hash_make_size(ogs_config()->pool.ue);
+    self.imsi_ue_hash = ogs_hash_make_size(ogs_config()->pool.ue);
+    self.guti_ue_hash = ogs_hash_make_size(ogs_config()->pool.ue);
+    self.tai_enb_hash = ogs_hash_make();
 
     ogs_list_init(&self.mme_ue_list);
 
@@ -166,6 +173,8 @@ void mme_context_final()
     ogs_hash_destroy(self.imsi_ue_hash);
     ogs_assert(self.guti_ue_hash);
     ogs_hash_destroy(self.guti_ue_hash);
+    ogs_assert(self.tai_enb_hash);
+    ogs_hash_destroy(self.tai_enb_hash);
 
     ogs_pool_final(&self.m_tmsi);
     ogs_pool_final(&mme_bearer_pool);
@@ -1936,6 +1945,7 @@ int mme_enb_remove(mme_enb_t *enb)
 
     ogs_hash_set(self.enb_addr_hash, enb->addr, sizeof(ogs_sockaddr_t), NULL);
     ogs_hash_set(self.enb_id_hash, &enb->enb_id, sizeof(enb->enb_id), NULL);
+    mme_enb_clear_supported_ta(enb);
 
     enb_ue_remove_in_enb(enb);
 
@@ -1987,6 +1997,91 @@ int mme_enb_set_enb_id(mme_enb_t *enb, uint32_t enb_id)
     return OGS_OK;
 }
 
+int mme_enb_add_supported_ta(mme_enb_t *enb, ogs_tai_t *tai)
+{
+    tai_enb_list_t *tai_enb = NULL;
+    mme_enb_tai_t *node = NULL;
+    int i;
+
+    ogs_assert(enb);
+    ogs_assert(tai);
+
+    if (enb->num_of_supported_ta_list >=
+            OGS_ARRAY_SIZE(enb->supported_ta_list)) {
+        ogs_warn("Too many supported TAs [%d]", enb->num_of_supported_ta_list);
+        return OGS_ERROR;
+    }
+
+    memcpy(&enb->supported_ta_list[enb->num_of_supported_ta_list],
+            tai, sizeof(ogs_tai_t));
+    node = &enb->supported_ta_node[enb->num_of_supported_ta_list];
+    node->enb = NULL;
+    enb->num_of_supported_ta_list++;
+
+    /* A repeated TAI is indexed only once */
+    for (i = 0; i < enb->num_of_supported_ta_list - 1; i++)
+        if (memcmp(&enb->supported_ta_list[i], tai, sizeof(ogs_tai_t)) == 0)
+            return OGS_OK;
+
+    tai_enb = ogs_hash_get(self.tai_enb_hash, tai, sizeof(ogs_tai_t));
+    if (!tai_enb) {
+        tai_enb = ogs_calloc(1, sizeof *tai_enb);
+        ogs_assert(tai_enb);
+        memcpy(&tai_enb->tai, tai, sizeof(ogs_tai_t));
+        ogs_list_init(&tai_enb->enb_list);
+        ogs_hash_set(self.tai_enb_hash,
+                &tai_enb->tai, sizeof(ogs_tai_t), tai_enb);
+    }
+
+    node->enb = enb;
+    ogs_list_add(&tai_enb->enb_list, node);
+
+    return OGS_OK;
+}
+
+void mme_enb_clear_supported_ta(mme_enb_t *enb)
+{
+    tai_enb_list_t *tai_enb = NULL;
+    mme_enb_tai_t *node = NULL;
+    int i;
+
+    ogs_assert(enb);
+
+    for (i = 0; i < enb->num_of_supported_ta_list; i++) {
+        node = &enb->supported_ta_node[i];
+        if (!node->enb)
+            continue;
+
+        tai_enb = ogs_hash_get(self.tai_enb_hash,
+                &enb->supported_ta_list[i], sizeof(ogs_tai_t));
+        ogs_assert(tai_enb);
+
+        ogs_list_remove(&tai_enb->enb_list, node);
+        node->enb = NULL;
+
+        if (!ogs_list_first(&tai_enb->enb_list)) {
+            ogs_hash_set(self.tai_enb_hash,
+                    &tai_enb->tai, sizeof(ogs_tai_t), NULL);
+            ogs_free(tai_enb);
+        }
+    }
+
+    enb->num_of_supported_ta_list = 0;
+}
+
+ogs_list_t *mme_enb_list_by_tai(ogs_tai_t *tai)
+{
+    tai_enb_list_t *tai_enb = NULL;
+
+    ogs_assert(tai);
+
+    tai_enb = ogs_hash_get(self.tai_enb_hash, tai, sizeof(ogs_tai_t));
+    if (!tai_enb)
+        return NULL;
+
+    return &tai_enb->enb_list;
+}
+
 int mme_enb_sock_type(ogs_sock_t *sock)
 {
     ogs_socknode_t *snode = NULL;
@@ -3121,37 +3216,22 @@ int mme_find_served_tai(ogs_tai_t *tai)
 
 int mme_m_tmsi_pool_generate()
 {
-    int i, j;
-    int index = 0;
-
-    ogs_trace("M-TMSI Pool try to generate...");
-    for (i = 0; index < ogs_config()->pool.ue; i++) {
-        mme_m_tmsi_t *m_tmsi = NULL;
-        int conflict = 0;
-
-        m_tmsi = &self.m_tmsi.array[index];
-        ogs_assert(m_tmsi);
-        *m_tmsi = ogs_random32();
-
-        /* for mapped-GUTI */
-        *m_tmsi |= 0xc0000000;
-        *m_tmsi &= 0xff00ffff;
-
-        for (j = 0; j < index; j++) {
-            if (*m_tmsi == self.m_tmsi.array[j]) {
-                conflict = 1;
-                ogs_trace("[M-TMSI CONFLICT]  %d:0x%x == %d:0x%x",
-                        index, *m_tmsi, j, self.m_tmsi.array[j]);
-                break;
-            }
-        }
-        if (conflict == 1) {
-            continue;
-        }
+    uint32_t key[MME_M_TMSI_ROUNDS];
+    int i;
 
-        index++;
+    if (ogs_config()->pool.ue > (1 << MME_M_TMSI_BITS)) {
+        ogs_error("Too many UEs [%d] for M-TMSI space [%d]",
+                ogs_config()->pool.ue, 1 << MME_M_TMSI_BITS);
+        return OGS_ERROR;
     }
-    self.m_tmsi.size = index;
+
+    for (i = 0; i < MME_M_TMSI_ROUNDS; i++)
+        key[i] = ogs_random32();
+
+    ogs_trace("M-TMSI Pool try to generate...");
+    for (i = 0; i < ogs_config()->pool.ue; i++)
+        self.m_tmsi.array[i] = mme_m_tmsi_permute(i, key);
+    self.m_tmsi.size = i;
     ogs_trace("M-TMSI Pool generate...done");
 
     return OGS_OK;
@@ -152,6 +152,7 @@ typedef struct mme_context_s {
     ogs_hash_t      *mme_ue_s1ap_id_hash;   /* hash table for MME-UE-S1AP-ID */
     ogs_hash_t      *imsi_ue_hash;          /* hash table (IMSI : MME_UE) */
     ogs_hash_t      *guti_ue_hash;          /* hash table (GUTI : MME_UE) */
+    ogs_hash_t      *tai_enb_hash;          /* hash table (TAI : ENB List) */
 
     /* System */
     ogs_queue_t     *queue;         /* Queue for processing MME control */
@@ -215,6 +216,11 @@ typedef struct mme_csmap_s {
     mme_vlr_t       *vlr;
 } mme_csmap_t;
 
+typedef struct mme_enb_tai_s {
+    ogs_lnode_t     lnode;      /* ENBs supporting the same TAI */
+    struct mme_enb_s *enb;      /* NULL if the TAI is repeated in the list */
+} mme_enb_tai_t;
+
 typedef struct mme_enb_s {
     ogs_lnode_t     lnode;
 
@@ -232,6 +238,7 @@ typedef struct mme_enb_s {
 
     uint8_t         num_of_supported_ta_list;
     ogs_tai_t       supported_ta_list[OGS_MAX_NUM_OF_TAI * MAX_NUM_OF_BPLMN];
+    mme_enb_tai_t   supported_ta_node[OGS_MAX_NUM_OF_TAI * MAX_NUM_OF_BPLMN];
 
     ogs_list_t      enb_ue_list;
 
@@ -350,6 +357,8 @@ struct mme_ue_s {
     uint8_t         rand[OGS_RAND_LEN];
     uint8_t         knas_int[OGS_SHA256_DIGEST_SIZE/2]; 
     uint8_t         knas_enc[OGS_SHA256_DIGEST_SIZE/2];
+    ogs_aes_cmac_key_t knas_int_cmac;   /* Expanded knas_int (128-EIA2) */
+    ogs_aes_key_t   knas_enc_aes;       /* Expanded knas_enc (128-EEA2) */
     uint32_t        dl_count;
     union {
         struct {
@@ -664,6 +673,9 @@ int mme_enb_remove_all(void);
 mme_enb_t *mme_enb_find_by_addr(ogs_sockaddr_t *addr);
 mme_enb_t *mme_enb_find_by_enb_id(uint32_t enb_id);
 int mme_enb_set_enb_id(mme_enb_t *enb, uint32_t enb_id);
+int mme_enb_add_supported_ta(mme_enb_t *enb, ogs_tai_t *tai);
+void mme_enb_clear_supported_ta(mme_enb_t *enb);
+ogs_list_t *mme_enb_list_by_tai(ogs_tai_t *tai);
 int mme_enb_sock_type(ogs_sock_t *sock);
 
 enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id);
@@ -23,11 +23,14 @@
 #include "mme-context.h"
 
 #include "s1ap-path.h"
+#include "mme-worker.h"
 
 #define EVENT_POOL 32 /* FIXME : 32 */
 void mme_event_init(void)
 {
-    mme_self()->queue = ogs_queue_create(EVENT_POOL);
+    /* Also room for everything the S1AP workers may hand back at once */
+    mme_self()->queue = ogs_queue_create(EVENT_POOL +
+            ogs_config()->parameter.mme_worker * ogs_config()->pool.packet);
     ogs_assert(mme_self()->queue);
     mme_self()->timer_mgr = ogs_timer_mgr_create();
     ogs_assert(mme_self()->timer_mgr);
@@ -142,7 +145,15 @@ void mme_sctp_event_push(mme_event_e id,
     e->max_num_of_istreams = max_num_of_istreams;
     e->max_num_of_ostreams = max_num_of_ostreams;
 
-    rv = ogs_queue_push(mme_self()->queue, e);
+    if (mme_worker_count()) {
+        rv = mme_worker_push(e);
+    } else {
+        rv = ogs_queue_push(mme_self()->queue, e);
+#if HAVE_USRSCTP
+        if (rv == OGS_OK)
+            ogs_pollset_notify(mme_self()->pollset);
+#endif
+    }
     if (rv != OGS_OK) {
         ogs_warn("ogs_queue_push() failed:%d", (int)rv);
         ogs_free(e->addr);
@@ -150,9 +161,4 @@ void mme_sctp_event_push(mme_event_e id,
             ogs_pkbuf_free(e->pkbuf);
         mme_event_free(e);
     }
-#if HAVE_USRSCTP
-    else {
-        ogs_pollset_notify(mme_self()->pollset);
-    }
-#endif
 }
@@ -24,6 +24,7 @@
 #include "mme-sm.h"
 #include "mme-event.h"
 #include "mme-timer.h"
+#include "mme-worker.h"
 
 #include "mme-fd-path.h"
 
@@ -39,7 +40,8 @@ int mme_initialize()
     mme_context_init();
     mme_event_init();
 
-    rv = ogs_gtp_xact_init(mme_self()->timer_mgr, 512);
+    rv = ogs_gtp_xact_init(
+            mme_self()->timer_mgr, ogs_config()->pool.xact);
     if (rv != OGS_OK) return rv;
 
     rv = mme_context_parse_config();
@@ -55,6 +57,9 @@ int mme_initialize()
     rv = mme_fd_init();
     if (rv != OGS_OK) return OGS_ERROR;
 
+    rv = mme_worker_init(ogs_config()->parameter.mme_worker);
+    if (rv != OGS_OK) return OGS_ERROR;
+
     thread = ogs_thread_create(mme_main, NULL);
     if (!thread) return OGS_ERROR;
 
@@ -67,10 +72,14 @@ void mme_terminate(void)
 {
     if (!initialized) return;
 
+    mme_worker_term();
+
     mme_event_term();
 
     ogs_thread_destroy(thread);
 
+    mme_worker_final();
+
     mme_fd_final();
 
     mme_context_final();
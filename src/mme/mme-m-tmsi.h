@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MME_M_TMSI_H
+#define MME_M_TMSI_H
+
+#include "ogs-core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * M-TMSI for mapped-GUTI has the two upper bits set and
+ * the third octet cleared, which leaves 22 bits of freedom.
+ *
+ * A 4-round Feistel network with random round keys is a permutation
+ * of these 22 bits, so distinct indexes never collide and
+ * no conflict check is needed.
+ */
+#define MME_M_TMSI_BITS         22
+#define MME_M_TMSI_HALF_BITS    (MME_M_TMSI_BITS/2)
+#define MME_M_TMSI_HALF_MASK    ((1 << MME_M_TMSI_HALF_BITS) - 1)
+#define MME_M_TMSI_ROUNDS       4
+
+static ogs_inline uint32_t mme_m_tmsi_permute(
+        uint32_t index, const uint32_t *key)
+{
+    uint32_t l = (index >> MME_M_TMSI_HALF_BITS) & MME_M_TMSI_HALF_MASK;
+    uint32_t r = index & MME_M_TMSI_HALF_MASK;
+    uint32_t v;
+    int i;
+
+    for (i = 0; i < MME_M_TMSI_ROUNDS; i++) {
+        uint32_t f = (r ^ key[i]) * 0x9e3779b1;
+        uint32_t t = r;
+
+        r = l ^ ((f >> 16) & MME_M_TMSI_HALF_MASK);
+        l = t;
+    }
+
+    v = (l << MME_M_TMSI_HALF_BITS) | r;
+
+    /* 0b11xxxxxx 00000000 xxxxxxxx xxxxxxxx */
+    return 0xc0000000 | ((v & 0x3f0000) << 8) | (v & 0xffff);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MME_M_TMSI_H */
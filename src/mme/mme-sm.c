@@ -104,7 +104,7 @@ void mme_state_operational(ogs_fsm_t *s, mme_event_t *e)
     mme_enb_t *enb = NULL;
     uint16_t max_num_of_ostreams = 0;
 
-    s1ap_message_t s1ap_message;
+    s1ap_message_t s1ap_message, *decoded = NULL;
     ogs_pkbuf_t *pkbuf = NULL;
     int rc;
 
@@ -236,10 +236,18 @@ void mme_state_operational(ogs_fsm_t *s, mme_event_t *e)
         ogs_assert(enb);
         ogs_assert(OGS_FSM_STATE(&enb->sm));
 
-        rc = ogs_s1ap_decode(&s1ap_message, pkbuf);
+        /* Already decoded if it came through the S1AP worker */
+        decoded = e->s1ap_message;
+        if (decoded) {
+            rc = OGS_OK;
+        } else {
+            decoded = &s1ap_message;
+            rc = ogs_s1ap_decode(decoded, pkbuf);
+        }
+
         if (rc == OGS_OK) {
             e->enb = enb;
-            e->s1ap_message = &s1ap_message;
+            e->s1ap_message = decoded;
             ogs_fsm_dispatch(&enb->sm, e);
         } else {
             ogs_warn("Cannot process S1AP message");
@@ -248,7 +256,9 @@ void mme_state_operational(ogs_fsm_t *s, mme_event_t *e)
                     S1AP_CauseProtocol_abstract_syntax_error_falsely_constructed_message);
         }
 
-        ogs_s1ap_free(&s1ap_message);
+        ogs_s1ap_free(decoded);
+        if (decoded != &s1ap_message)
+            ogs_free(decoded);
         ogs_pkbuf_free(pkbuf);
         break;
 
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-s1ap.h"
+
+#include "mme-context.h"
+#include "mme-worker.h"
+
+typedef struct mme_worker_s {
+    ogs_thread_t *thread;
+    ogs_queue_t *queue;
+} mme_worker_t;
+
+static mme_worker_t worker[MME_MAX_NUM_OF_WORKER];
+static int num_of_worker = 0;
+
+static void worker_decode(mme_event_t *e)
+{
+    s1ap_message_t *s1ap_message = NULL;
+
+    ogs_assert(e);
+    ogs_assert(e->pkbuf);
+
+    s1ap_message = ogs_calloc(1, sizeof(*s1ap_message));
+    ogs_assert(s1ap_message);
+
+    if (ogs_s1ap_decode(s1ap_message, e->pkbuf) == OGS_OK) {
+        e->s1ap_message = s1ap_message;
+        return;
+    }
+
+    /* Leave it to the main thread to send Error Indication */
+    ogs_s1ap_free(s1ap_message);
+    ogs_free(s1ap_message);
+}
+
+static void worker_main(void *data)
+{
+    mme_worker_t *w = data;
+    int rv;
+
+    ogs_assert(w);
+
+    for ( ;; ) {
+        mme_event_t *e = NULL;
+
+        rv = ogs_queue_pop(w->queue, (void**)&e);
+        if (rv == OGS_DONE)
+            break;
+        if (rv != OGS_OK)
+            continue;
+
+        ogs_assert(e);
+        if (e->id == MME_EVT_S1AP_MESSAGE)
+            worker_decode(e);
+
+        rv = ogs_queue_push(mme_self()->queue, e);
+        if (rv != OGS_OK) {
+            ogs_warn("ogs_queue_push() failed:%d", (int)rv);
+            if (e->s1ap_message) {
+                ogs_s1ap_free(e->s1ap_message);
+                ogs_free(e->s1ap_message);
+            }
+            ogs_free(e->addr);
+            if (e->pkbuf)
+                ogs_pkbuf_free(e->pkbuf);
+            mme_event_free(e);
+            continue;
+        }
+
+        ogs_pollset_notify(mme_self()->pollset);
+    }
+}
+
+int mme_worker_init(int num)
+{
+    int i;
+
+    ogs_assert(num >= 0 && num <= MME_MAX_NUM_OF_WORKER);
+
+    for (i = 0; i < num; i++) {
+        /* Large enough that the main thread never has to wait */
+        worker[i].queue = ogs_queue_create(ogs_config()->pool.packet);
+        ogs_assert(worker[i].queue);
+
+        worker[i].thread = ogs_thread_create(worker_main, &worker[i]);
+        if (!worker[i].thread) {
+            ogs_queue_destroy(worker[i].queue);
+            worker[i].queue = NULL;
+            return OGS_ERROR;
+        }
+        num_of_worker++;
+    }
+
+    if (num_of_worker)
+        ogs_info("S1AP decoded by %d worker threads", num_of_worker);
+
+    return OGS_OK;
+}
+
+void mme_worker_term(void)
+{
+    int i;
+
+    for (i = 0; i < num_of_worker; i++) {
+        ogs_queue_term(worker[i].queue);
+        ogs_thread_destroy(worker[i].thread);
+        worker[i].thread = NULL;
+    }
+}
+
+void mme_worker_final(void)
+{
+    int i;
+
+    for (i = 0; i < num_of_worker; i++) {
+        ogs_queue_destroy(worker[i].queue);
+        worker[i].queue = NULL;
+    }
+    num_of_worker = 0;
+}
+
+int mme_worker_count(void)
+{
+    return num_of_worker;
+}
+
+int mme_worker_push(mme_event_t *e)
+{
+    const uint8_t *p = NULL;
+    uint32_t hash = 2166136261U;
+    socklen_t i, len;
+
+    ogs_assert(e);
+    ogs_assert(e->addr);
+
+    ogs_assert(num_of_worker);
+
+    p = (const uint8_t *)&e->addr->sa;
+    len = ogs_sockaddr_len(e->addr);
+    for (i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619U;
+    }
+
+    /*
+     * Never block here. The worker may itself be waiting for
+     * the main thread to drain mme_self()->queue.
+     */
+    return ogs_queue_trypush(worker[hash % num_of_worker].queue, e);
+}
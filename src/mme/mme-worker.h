@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MME_WORKER_H
+#define MME_WORKER_H
+
+#include "mme-event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MME_MAX_NUM_OF_WORKER   32
+
+/*
+ * S1AP Worker
+ *
+ * Every SCTP event of an eNB association goes through the same worker,
+ * so the main thread still sees them in order. The worker decodes
+ * S1AP messages (ASN.1 PER) and hands the decoded message over in
+ * e->s1ap_message. Everything that touches the MME context stays on
+ * the main thread.
+ */
+int mme_worker_init(int num_of_worker);
+void mme_worker_term(void);
+void mme_worker_final(void);
+
+int mme_worker_count(void);
+int mme_worker_push(mme_event_t *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MME_WORKER_H */
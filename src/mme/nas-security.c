@@ -19,6 +19,15 @@
 
 #include "nas-security.h"
 
+static void mac_calculate(uint8_t algorithm_identity,
+        uint8_t *knas_int, const ogs_aes_cmac_key_t *cmac_key,
+        uint32_t count, uint8_t bearer, uint8_t direction,
+        ogs_pkbuf_t *pkbuf, uint8_t *mac);
+static void cipher(uint8_t algorithm_identity,
+        uint8_t *knas_enc, const ogs_aes_key_t *aes_key,
+        uint32_t count, uint8_t bearer, uint8_t direction,
+        ogs_pkbuf_t *pkbuf);
+
 ogs_pkbuf_t *nas_security_encode(
         mme_ue_t *mme_ue, ogs_nas_message_t *message)
 {
@@ -79,8 +88,8 @@ ogs_pkbuf_t *nas_security_encode(
 
     if (ciphered) {
         /* encrypt NAS message */
-        nas_encrypt(mme_ue->selected_enc_algorithm,
-            mme_ue->knas_enc, mme_ue->dl_count, NAS_SECURITY_BEARER,
+        cipher(mme_ue->selected_enc_algorithm,
+            mme_ue->knas_enc, &mme_ue->knas_enc_aes, mme_ue->dl_count, NAS_SECURITY_BEARER,
             NAS_SECURITY_DOWNLINK_DIRECTION, new);
     }
 
@@ -92,8 +101,8 @@ ogs_pkbuf_t *nas_security_encode(
         uint8_t mac[NAS_SECURITY_MAC_SIZE];
 
         /* calculate NAS MAC(message authentication code) */
-        nas_mac_calculate(mme_ue->selected_int_algorithm,
-            mme_ue->knas_int, mme_ue->dl_count, NAS_SECURITY_BEARER, 
+        mac_calculate(mme_ue->selected_int_algorithm,
+            mme_ue->knas_int, &mme_ue->knas_int_cmac, mme_ue->dl_count, NAS_SECURITY_BEARER, 
             NAS_SECURITY_DOWNLINK_DIRECTION, new, mac);
         memcpy(&h.message_authentication_code, mac, sizeof(mac));
     }
@@ -148,8 +157,8 @@ int nas_security_decode(mme_ue_t *mme_ue,
         memcpy(original_mac, pkbuf->data + 2, SHORT_MAC_SIZE);
 
         ogs_pkbuf_trim(pkbuf, 2);
-        nas_mac_calculate(mme_ue->selected_int_algorithm,
-            mme_ue->knas_int, mme_ue->ul_count.i32, NAS_SECURITY_BEARER,
+        mac_calculate(mme_ue->selected_int_algorithm,
+            mme_ue->knas_int, &mme_ue->knas_int_cmac, mme_ue->ul_count.i32, NAS_SECURITY_BEARER,
             NAS_SECURITY_UPLINK_DIRECTION, pkbuf, mac);
 
         ogs_pkbuf_put_data(pkbuf, original_mac, SHORT_MAC_SIZE);
@@ -202,8 +211,9 @@ int nas_security_decode(mme_ue_t *mme_ue,
             uint32_t original_mac = h->message_authentication_code;
 
             /* calculate NAS MAC(message authentication code) */
-            nas_mac_calculate(mme_ue->selected_int_algorithm,
-                mme_ue->knas_int, mme_ue->ul_count.i32, NAS_SECURITY_BEARER, 
+            mac_calculate(mme_ue->selected_int_algorithm,
+                mme_ue->knas_int, &mme_ue->knas_int_cmac,
+                mme_ue->ul_count.i32, NAS_SECURITY_BEARER, 
                 NAS_SECURITY_UPLINK_DIRECTION, pkbuf, mac);
             h->message_authentication_code = original_mac;
 
@@ -220,8 +230,9 @@ int nas_security_decode(mme_ue_t *mme_ue,
 
         if (security_header_type.ciphered) {
             /* decrypt NAS message */
-            nas_encrypt(mme_ue->selected_enc_algorithm,
-                mme_ue->knas_enc, mme_ue->ul_count.i32, NAS_SECURITY_BEARER,
+            cipher(mme_ue->selected_enc_algorithm,
+                mme_ue->knas_enc, &mme_ue->knas_enc_aes,
+                mme_ue->ul_count.i32, NAS_SECURITY_BEARER,
                 NAS_SECURITY_UPLINK_DIRECTION, pkbuf);
         }
     }
@@ -229,11 +240,29 @@ int nas_security_decode(mme_ue_t *mme_ue,
     return OGS_OK;
 }
 
+void nas_security_key_setup(mme_ue_t *mme_ue)
+{
+    ogs_assert(mme_ue);
+
+    ogs_aes_cmac_setup(&mme_ue->knas_int_cmac, mme_ue->knas_int);
+    ogs_aes_key_setup(&mme_ue->knas_enc_aes, mme_ue->knas_enc, 128);
+}
+
 void nas_mac_calculate(uint8_t algorithm_identity,
         uint8_t *knas_int, uint32_t count, uint8_t bearer, 
         uint8_t direction, ogs_pkbuf_t *pkbuf, uint8_t *mac)
 {
-    uint8_t *ivec = NULL;;
+    mac_calculate(algorithm_identity, knas_int, NULL,
+            count, bearer, direction, pkbuf, mac);
+}
+
+/* cmac_key, if any, is knas_int already expanded for 128-EIA2 */
+static void mac_calculate(uint8_t algorithm_identity,
+        uint8_t *knas_int, const ogs_aes_cmac_key_t *cmac_key,
+        uint32_t count, uint8_t bearer, uint8_t direction,
+        ogs_pkbuf_t *pkbuf, uint8_t *mac)
+{
+    uint8_t *ivec = NULL;
     uint8_t cmac[16];
     uint32_t mac32;
 
@@ -260,7 +289,11 @@ void nas_mac_calculate(uint8_t algorithm_identity,
         memcpy(ivec + 0, &count, sizeof(count));
         ivec[4] = (bearer << 3) | (direction << 2);
 
-        ogs_aes_cmac_calculate(cmac, knas_int, pkbuf->data, pkbuf->len);
+        if (cmac_key)
+            ogs_aes_cmac_calculate_key(
+                    cmac, cmac_key, pkbuf->data, pkbuf->len);
+        else
+            ogs_aes_cmac_calculate(cmac, knas_int, pkbuf->data, pkbuf->len);
         memcpy(mac, cmac, 4);
 
         ogs_pkbuf_pull(pkbuf, 8);
@@ -284,6 +317,16 @@ void nas_mac_calculate(uint8_t algorithm_identity,
 void nas_encrypt(uint8_t algorithm_identity,
         uint8_t *knas_enc, uint32_t count, uint8_t bearer, 
         uint8_t direction, ogs_pkbuf_t *pkbuf)
+{
+    cipher(algorithm_identity, knas_enc, NULL,
+            count, bearer, direction, pkbuf);
+}
+
+/* aes_key, if any, is knas_enc already expanded for 128-EEA2 */
+static void cipher(uint8_t algorithm_identity,
+        uint8_t *knas_enc, const ogs_aes_key_t *aes_key,
+        uint32_t count, uint8_t bearer, uint8_t direction,
+        ogs_pkbuf_t *pkbuf)
 {
     uint8_t ivec[16];
 
@@ -305,8 +348,12 @@ void nas_encrypt(uint8_t algorithm_identity,
         memset(ivec, 0, 16);
         memcpy(ivec + 0, &count, sizeof(count));
         ivec[4] = (bearer << 3) | (direction << 2);
-        ogs_aes_ctr128_encrypt(knas_enc, ivec, 
-                pkbuf->data, pkbuf->len, pkbuf->data);
+        if (aes_key)
+            ogs_aes_ctr128_encrypt_key(aes_key, ivec,
+                    pkbuf->data, pkbuf->len, pkbuf->data);
+        else
+            ogs_aes_ctr128_encrypt(knas_enc, ivec,
+                    pkbuf->data, pkbuf->len, pkbuf->data);
         break;
     case OGS_NAS_SECURITY_ALGORITHMS_128_EEA3:
         zuc_eea3(knas_enc, count, bearer, direction, 
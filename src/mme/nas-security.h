@@ -51,6 +51,9 @@ ogs_pkbuf_t *nas_security_encode(
 int nas_security_decode(mme_ue_t *mme_ue, 
         nas_security_header_type_t security_header_type, ogs_pkbuf_t *pkbuf);
 
+/* Expand knas_int/knas_enc once they are derived */
+void nas_security_key_setup(mme_ue_t *mme_ue);
+
 void nas_mac_calculate(uint8_t algorithm_identity,
         uint8_t *knas_int, uint32_t count, uint8_t bearer, 
         uint8_t direction, ogs_pkbuf_t *pkbuf, uint8_t *mac);
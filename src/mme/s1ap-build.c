@@ -35,7 +35,7 @@ ogs_pkbuf_t *s1ap_build_setup_rsp(void)
     S1AP_ServedGUMMEIs_t *ServedGUMMEIs = NULL;
     S1AP_RelativeMMECapacity_t *RelativeMMECapacity = NULL;
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_successfulOutcome;
     pdu.choice.successfulOutcome = 
         CALLOC(1, sizeof(S1AP_SuccessfulOutcome_t));
@@ -126,7 +126,7 @@ ogs_pkbuf_t *s1ap_build_setup_failure(
     ogs_debug("    Group[%d] Cause[%d] TimeToWait[%ld]",
             group, (int)cause, time_to_wait);
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_unsuccessfulOutcome;
     pdu.choice.unsuccessfulOutcome = 
         CALLOC(1, sizeof(S1AP_UnsuccessfulOutcome_t));
@@ -185,7 +185,7 @@ ogs_pkbuf_t *s1ap_build_downlink_nas_transport(
 
     ogs_debug("[MME] DownlinkNASTransport");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -271,7 +271,7 @@ ogs_pkbuf_t *s1ap_build_initial_context_setup_request(
 
     ogs_debug("[MME] Initial context setup request");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -545,7 +545,7 @@ ogs_pkbuf_t *s1ap_build_ue_context_modification_request(mme_ue_t *mme_ue)
 
     ogs_debug("[MME] UE context modification request");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -683,7 +683,7 @@ ogs_pkbuf_t *s1ap_build_ue_context_release_command(
         return NULL;
     }
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -765,7 +765,7 @@ ogs_pkbuf_t *s1ap_build_e_rab_setup_request(
     enb_ue = mme_ue->enb_ue;
     ogs_assert(enb_ue);
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -902,7 +902,7 @@ ogs_pkbuf_t *s1ap_build_e_rab_modify_request(
     ogs_assert(enb_ue);
 
     ogs_debug("[MME] E-RAB modify request");
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -1038,7 +1038,7 @@ ogs_pkbuf_t *s1ap_build_e_rab_release_command(
 
     ogs_debug("[MME] E-RAB release command");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -1159,7 +1159,7 @@ ogs_pkbuf_t *s1ap_build_paging(
 
     ogs_debug("[MME] Paging");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -1273,7 +1273,7 @@ ogs_pkbuf_t *s1ap_build_mme_configuration_transfer(
 
     ogs_debug("[MME] MME Configuration Transfer");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -1324,7 +1324,7 @@ ogs_pkbuf_t *s1ap_build_path_switch_ack(mme_ue_t *mme_ue)
 
     ogs_debug("[MME] Path switch acknowledge");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_successfulOutcome;
     pdu.choice.successfulOutcome = 
         CALLOC(1, sizeof(S1AP_SuccessfulOutcome_t));
@@ -1401,7 +1401,7 @@ ogs_pkbuf_t *s1ap_build_path_switch_failure(
 
     ogs_debug("[MME] Path switch failure");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_unsuccessfulOutcome;
     pdu.choice.unsuccessfulOutcome = 
         CALLOC(1, sizeof(S1AP_UnsuccessfulOutcome_t));
@@ -1482,7 +1482,7 @@ ogs_pkbuf_t *s1ap_build_handover_command(enb_ue_t *source_ue)
 
     ogs_debug("[MME] Handover command");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_successfulOutcome;
     pdu.choice.successfulOutcome = 
         CALLOC(1, sizeof(S1AP_SuccessfulOutcome_t));
@@ -1643,7 +1643,7 @@ ogs_pkbuf_t *s1ap_build_handover_preparation_failure(
 
     ogs_debug("[MME] Handover preparation failure");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_unsuccessfulOutcome;
     pdu.choice.unsuccessfulOutcome = 
         CALLOC(1, sizeof(S1AP_UnsuccessfulOutcome_t));
@@ -1741,7 +1741,7 @@ ogs_pkbuf_t *s1ap_build_handover_request(
 
     ogs_debug("[MME] Handover request");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -1958,7 +1958,7 @@ ogs_pkbuf_t *s1ap_build_handover_cancel_ack(enb_ue_t *source_ue)
 
     ogs_debug("[MME] Handover cancel acknowledge");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_successfulOutcome;
     pdu.choice.successfulOutcome = 
         CALLOC(1, sizeof(S1AP_SuccessfulOutcome_t));
@@ -2023,7 +2023,7 @@ ogs_pkbuf_t *s1ap_build_mme_status_transfer(
     
     ogs_debug("[MME] MME status transfer");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -2096,7 +2096,7 @@ ogs_pkbuf_t *s1ap_build_error_indication(
 
     ogs_debug("[MME] Error Indication");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -2169,7 +2169,7 @@ ogs_pkbuf_t *s1ap_build_s1_reset(
 
     ogs_debug("[MME] Reset");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -2256,7 +2256,7 @@ ogs_pkbuf_t *s1ap_build_s1_reset_ack(
 
     ogs_debug("[MME] Reset acknowledge");
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_successfulOutcome;
     pdu.choice.successfulOutcome = 
         CALLOC(1, sizeof(S1AP_SuccessfulOutcome_t));
@@ -2357,7 +2357,7 @@ ogs_pkbuf_t *s1ap_build_write_replace_warning_request(sbc_pws_data_t *sbc_pws)
 
     ogs_assert(sbc_pws);
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -2486,7 +2486,7 @@ ogs_pkbuf_t *s1ap_build_kill_request(sbc_pws_data_t *sbc_pws)
 
     ogs_assert(sbc_pws);
 
-    memset(&pdu, 0, sizeof (S1AP_S1AP_PDU_t));
+    ogs_s1ap_init_message(&pdu);
     pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
     pdu.choice.initiatingMessage = 
         CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
@@ -91,7 +91,7 @@ void s1ap_handle_s1_setup_request(mme_enb_t *enb, ogs_s1ap_message_t *message)
 
     ogs_assert(SupportedTAs);
     /* Parse Supported TA */
-    enb->num_of_supported_ta_list = 0;
+    mme_enb_clear_supported_ta(enb);
     for (i = 0; i < SupportedTAs->list.count; i++) {
         S1AP_SupportedTAs_Item_t *SupportedTAs_Item = NULL;
         S1AP_TAC_t *tAC = NULL;
@@ -104,25 +104,21 @@ void s1ap_handle_s1_setup_request(mme_enb_t *enb, ogs_s1ap_message_t *message)
 
         for (j = 0; j < SupportedTAs_Item->broadcastPLMNs.list.count; j++) {
             S1AP_PLMNidentity_t *pLMNidentity = NULL;
+            ogs_tai_t tai;
+
             pLMNidentity = (S1AP_PLMNidentity_t *)
                 SupportedTAs_Item->broadcastPLMNs.list.array[j];
             ogs_assert(pLMNidentity);
 
-            memcpy(&enb->supported_ta_list[enb->num_of_supported_ta_list].tac,
-                    tAC->buf, sizeof(uint16_t));
-            enb->supported_ta_list[enb->num_of_supported_ta_list].tac = 
-                ntohs(enb->supported_ta_list
-                        [enb->num_of_supported_ta_list].tac);
-            memcpy(&enb->supported_ta_list
-                        [enb->num_of_supported_ta_list].plmn_id,
-                    pLMNidentity->buf, sizeof(ogs_plmn_id_t));
+            memcpy(&tai.tac, tAC->buf, sizeof(uint16_t));
+            tai.tac = ntohs(tai.tac);
+            memcpy(&tai.plmn_id, pLMNidentity->buf, sizeof(ogs_plmn_id_t));
             ogs_debug("    PLMN_ID[MCC:%d MNC:%d] TAC[%d]",
-                ogs_plmn_id_mcc(&enb->supported_ta_list
-                    [enb->num_of_supported_ta_list].plmn_id),
-                ogs_plmn_id_mnc(&enb->supported_ta_list
-                    [enb->num_of_supported_ta_list].plmn_id),
-                enb->supported_ta_list[enb->num_of_supported_ta_list].tac);
-            enb->num_of_supported_ta_list++;
+                ogs_plmn_id_mcc(&tai.plmn_id),
+                ogs_plmn_id_mnc(&tai.plmn_id),
+                tai.tac);
+
+            mme_enb_add_supported_ta(enb, &tai);
         }
     }
 
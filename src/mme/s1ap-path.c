@@ -316,29 +316,26 @@ void s1ap_send_ue_context_release_command(
 void s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
 {
     ogs_pkbuf_t *s1apbuf = NULL;
-    mme_enb_t *enb = NULL;
-    int i;
+    ogs_list_t *enb_list = NULL;
+    mme_enb_tai_t *node = NULL;
     int rv;
 
     /* Find enB with matched TAI */
-    ogs_list_for_each(&mme_self()->enb_list, enb) {
-        for (i = 0; i < enb->num_of_supported_ta_list; i++) {
-
-            if (memcmp(&enb->supported_ta_list[i], &mme_ue->tai,
-                        sizeof(ogs_tai_t)) == 0) {
-
-                if (mme_ue->t3413.pkbuf) {
-                    s1apbuf = mme_ue->t3413.pkbuf;
-                } else {
-                    s1apbuf = s1ap_build_paging(mme_ue, cn_domain);
-                    ogs_expect_or_return(s1apbuf);
-                }
+    enb_list = mme_enb_list_by_tai(&mme_ue->tai);
+    if (enb_list) {
+        /* Built once and kept for T3413; each eNB gets a reference */
+        if (!mme_ue->t3413.pkbuf) {
+            s1apbuf = s1ap_build_paging(mme_ue, cn_domain);
+            ogs_expect_or_return(s1apbuf);
+            mme_ue->t3413.pkbuf = s1apbuf;
+        }
 
-                mme_ue->t3413.pkbuf = ogs_pkbuf_copy(s1apbuf);
+        ogs_list_for_each(enb_list, node) {
+            s1apbuf = ogs_pkbuf_copy(mme_ue->t3413.pkbuf);
+            ogs_assert(s1apbuf);
 
-                rv = s1ap_send_to_enb(enb, s1apbuf, S1AP_NON_UE_SIGNALLING);
-                ogs_expect(rv == OGS_OK);
-            }
+            rv = s1ap_send_to_enb(node->enb, s1apbuf, S1AP_NON_UE_SIGNALLING);
+            ogs_expect(rv == OGS_OK);
         }
     }
 
@@ -22,72 +22,76 @@
 #include "s1ap-build.h"
 #include "sbc-handler.h"
 
-void sbc_handle_write_replace_warning_request(sbc_pws_data_t *sbc_pws)
+static int enb_supports_tai(mme_enb_t *enb, ogs_tai_t *tai)
 {
-    ogs_pkbuf_t *s1apbuf = NULL;
+    int i;
+
+    for (i = 0; i < enb->num_of_supported_ta_list; i++)
+        if (!memcmp(&enb->supported_ta_list[i], tai, sizeof(ogs_tai_t)))
+            return 1;
+
+    return 0;
+}
+
+static void sbc_send_to_enb(sbc_pws_data_t *sbc_pws, ogs_pkbuf_t *s1apbuf)
+{
+    ogs_list_t *enb_list = NULL;
+    mme_enb_tai_t *node = NULL;
     mme_enb_t *enb = NULL;
-    int i, j, flag;
+    int i, j;
+
+    if (sbc_pws->no_of_tai == 0) {
+        ogs_list_for_each(&mme_self()->enb_list, enb) {
+            ogs_expect(s1ap_send_to_enb(enb, ogs_pkbuf_copy(s1apbuf),
+                    S1AP_NON_UE_SIGNALLING) == OGS_OK);
+        }
+        return;
+    }
 
     /* Find enB with matched TAI */
-    ogs_list_for_each(&mme_self()->enb_list, enb) {
-        flag = 0;
-        if (sbc_pws->no_of_tai > 0) {
-            for (i = 0, flag = 0; i < enb->num_of_supported_ta_list; i++) {
-                for (j = 0; j < sbc_pws->no_of_tai; j++) {
-                    if (!memcmp(&enb->supported_ta_list[i],
-                                &sbc_pws->tai[j], sizeof(ogs_tai_t)))
-                        flag = 1;
-
-                    if (flag) break;
-                }
-                if (flag) break;
-            }
-        } else
-            flag = 1;
-
-        if (flag) {
-            /* Buidl S1AP Write Replace Warning Request message */
-            s1apbuf = s1ap_build_write_replace_warning_request(sbc_pws);
-            ogs_expect_or_return(s1apbuf);
-
-            /* Send to enb */
-            ogs_expect(s1ap_send_to_enb(
-                    enb, s1apbuf, S1AP_NON_UE_SIGNALLING) == OGS_OK);
+    for (j = 0; j < sbc_pws->no_of_tai; j++) {
+        enb_list = mme_enb_list_by_tai(&sbc_pws->tai[j]);
+        if (!enb_list)
+            continue;
+
+        ogs_list_for_each(enb_list, node) {
+            enb = node->enb;
+
+            /* Already sent for a previous TAI */
+            for (i = 0; i < j; i++)
+                if (enb_supports_tai(enb, &sbc_pws->tai[i]))
+                    break;
+            if (i < j)
+                continue;
+
+            ogs_expect(s1ap_send_to_enb(enb, ogs_pkbuf_copy(s1apbuf),
+                    S1AP_NON_UE_SIGNALLING) == OGS_OK);
         }
     }
 }
 
+void sbc_handle_write_replace_warning_request(sbc_pws_data_t *sbc_pws)
+{
+    ogs_pkbuf_t *s1apbuf = NULL;
+
+    /* Buidl S1AP Write Replace Warning Request message */
+    s1apbuf = s1ap_build_write_replace_warning_request(sbc_pws);
+    ogs_expect_or_return(s1apbuf);
+
+    /* Send to enb */
+    sbc_send_to_enb(sbc_pws, s1apbuf);
+    ogs_pkbuf_free(s1apbuf);
+}
+
 void sbc_handle_stop_warning_request(sbc_pws_data_t *sbc_pws)
 {
     ogs_pkbuf_t *s1apbuf = NULL;
-    mme_enb_t *enb = NULL;
-    int i, j, flag;
 
-    /* Find enB with matched TAI */
-    ogs_list_for_each(&mme_self()->enb_list, enb) {
-        flag = 0;
-        if (sbc_pws->no_of_tai > 0) {
-            for (i = 0, flag = 0; i < enb->num_of_supported_ta_list; i++) {
-                for (j = 0; j < sbc_pws->no_of_tai; j++) {
-                    if (!memcmp(&enb->supported_ta_list[i],
-                                &sbc_pws->tai[j], sizeof(ogs_tai_t)))
-                        flag = 1;
-
-                    if (flag) break;
-                }
-                if (flag) break;
-            }
-        } else
-            flag = 1;
-
-        if (flag) {
-            /* Buidl S1AP Kill request message */
-            s1apbuf = s1ap_build_kill_request(sbc_pws);
-            ogs_expect_or_return(s1apbuf);
-
-            /* Send to enb */
-            ogs_expect(s1ap_send_to_enb(
-                    enb, s1apbuf, S1AP_NON_UE_SIGNALLING) == OGS_OK);
-        }
-    }
+    /* Buidl S1AP Kill request message */
+    s1apbuf = s1ap_build_kill_request(sbc_pws);
+    ogs_expect_or_return(s1apbuf);
+
+    /* Send to enb */
+    sbc_send_to_enb(sbc_pws, s1apbuf);
+    ogs_pkbuf_free(s1apbuf);
 }
@@ -261,6 +261,96 @@ int pcrf_context_parse_config(void)
     return OGS_OK;
 }
 
+/*
+ * QoS Cache Entry
+ *
+ * A copy of the PDN and PCC Rules in ogs_diam_gx_message_t.
+ * Strings are allocated with malloc() so that the cache does not
+ * hold on to the memory pool.
+ */
+static void qos_cache_free(void *data)
+{
+    ogs_diam_gx_message_t *gx_message = data;
+    int i, j;
+
+    ogs_assert(gx_message);
+
+    for (i = 0; i < gx_message->num_of_pcc_rule; i++) {
+        ogs_pcc_rule_t *pcc_rule = &gx_message->pcc_rule[i];
+
+        free(pcc_rule->name);
+        for (j = 0; j < pcc_rule->num_of_flow; j++)
+            free(pcc_rule->flow[j].description);
+    }
+    free(gx_message);
+}
+
+static ogs_diam_gx_message_t *qos_cache_new(ogs_diam_gx_message_t *src)
+{
+    ogs_diam_gx_message_t *gx_message = NULL;
+    int i, j;
+
+    ogs_assert(src);
+
+    gx_message = calloc(1, sizeof(*gx_message));
+    if (!gx_message)
+        return NULL;
+
+    memcpy(&gx_message->pdn, &src->pdn, sizeof(src->pdn));
+    for (i = 0; i < src->num_of_pcc_rule; i++) {
+        ogs_pcc_rule_t *pcc_rule = &gx_message->pcc_rule[i];
+
+        memcpy(pcc_rule, &src->pcc_rule[i], sizeof(*pcc_rule));
+        pcc_rule->name = NULL;
+        pcc_rule->num_of_flow = 0;
+        gx_message->num_of_pcc_rule++;
+
+        pcc_rule->name = strdup(src->pcc_rule[i].name);
+        if (!pcc_rule->name)
+            goto cleanup;
+        for (j = 0; j < src->pcc_rule[i].num_of_flow; j++) {
+            pcc_rule->flow[j].description =
+                strdup(src->pcc_rule[i].flow[j].description);
+            if (!pcc_rule->flow[j].description)
+                goto cleanup;
+            pcc_rule->num_of_flow++;
+        }
+    }
+
+    return gx_message;
+
+cleanup:
+    qos_cache_free(gx_message);
+    return NULL;
+}
+
+static void qos_cache_copy(void *dst, const void *data)
+{
+    ogs_diam_gx_message_t *gx_message = dst;
+    const ogs_diam_gx_message_t *cached = data;
+    int i, j;
+
+    ogs_assert(gx_message);
+    ogs_assert(cached);
+
+    memcpy(&gx_message->pdn, &cached->pdn, sizeof(cached->pdn));
+    memcpy(gx_message->pcc_rule, cached->pcc_rule,
+            sizeof(cached->pcc_rule[0]) * cached->num_of_pcc_rule);
+    gx_message->num_of_pcc_rule = cached->num_of_pcc_rule;
+
+    for (i = 0; i < gx_message->num_of_pcc_rule; i++) {
+        ogs_pcc_rule_t *pcc_rule = &gx_message->pcc_rule[i];
+
+        pcc_rule->name = ogs_strdup(pcc_rule->name);
+        ogs_assert(pcc_rule->name);
+        for (j = 0; j < pcc_rule->num_of_flow; j++) {
+            pcc_rule->flow[j].description =
+                ogs_strdup(pcc_rule->flow[j].description);
+            ogs_assert(pcc_rule->flow[j].description);
+        }
+    }
+}
+
 int pcrf_db_init()
 {
     int rv;
@@ -272,6 +362,12 @@ int pcrf_db_init()
         self.subscriberCollection = mongoc_client_get_collection(
             ogs_mongoc()->client, ogs_mongoc()->name, "subscribers");
         ogs_assert(self.subscriberCollection);
+
+        self.qos_cache = ogs_cache_create(
+                ogs_config()->db_uri, "subscribers",
+                (size_t)ogs_config()->parameter.db_cache * 1024,
+                ogs_time_from_sec(ogs_config()->parameter.db_cache_ttl),
+                qos_cache_copy, qos_cache_free);
     }
 
     return OGS_OK;
@@ -279,6 +375,9 @@ int pcrf_db_init()
 
 int pcrf_db_final()
 {
+    ogs_cache_destroy(self.qos_cache);
+    self.qos_cache = NULL;
+
     if (self.subscriberCollection) {
         mongoc_collection_destroy(self.subscriberCollection);
     }
@@ -302,11 +401,19 @@ int pcrf_db_qos_data(char *imsi_bcd, char *apn,
     bson_iter_t child4_iter, child5_iter, child6_iter;
     const char *utf8 = NULL;
     uint32_t length = 0;
+    char key[OGS_MAX_IMSI_BCD_LEN+1+OGS_MAX_APN_LEN+1];
+    uint64_t version;
 
     ogs_assert(imsi_bcd);
     ogs_assert(apn);
     ogs_assert(gx_message);
 
+    ogs_snprintf(key, sizeof(key), "%s/%s", imsi_bcd, apn);
+    if (ogs_cache_get(self.qos_cache, key, gx_message))
+        return OGS_OK;
+
+    version = ogs_cache_version(self.qos_cache);
+
     ogs_thread_mutex_lock(&self.db_lock);
 
     query = BCON_NEW(
@@ -614,6 +721,15 @@ int pcrf_db_qos_data(char *imsi_bcd, char *apn,
         }
     }
 
+    if (self.qos_cache &&
+        bson_iter_init_find(&iter, document, "_id") &&
+        BSON_ITER_HOLDS_OID(&iter)) {
+        ogs_diam_gx_message_t *cached = qos_cache_new(gx_message);
+        if (cached)
+            ogs_cache_set(self.qos_cache, version, key,
+                    bson_iter_oid(&iter)->bytes, cached, sizeof(*cached));
+    }
+
 out:
     if (query) bson_destroy(query);
     if (opts) bson_destroy(opts);
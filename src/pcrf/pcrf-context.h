@@ -42,6 +42,7 @@ typedef struct pcrf_context_s {
 
     void            *subscriberCollection;
     ogs_thread_mutex_t db_lock;
+    struct ogs_cache_s *qos_cache; /* Keyed by IMSI/APN */
 
     ogs_hash_t      *ip_hash; /* hash table for Gx Frame IPv4/IPv6 */
     ogs_thread_mutex_t hash_lock;
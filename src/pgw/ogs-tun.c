@@ -38,7 +38,7 @@
 #define IFNAMSIZ 32
 #endif
 
-ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
+ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap, int multi_queue)
 {
     ogs_socket_t fd = INVALID_SOCKET;
 #if defined(__linux__)
@@ -49,6 +49,15 @@ ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
 
     ogs_assert(ifname);
 
+    if (multi_queue) {
+#if defined(IFF_MULTI_QUEUE)
+        flags |= IFF_MULTI_QUEUE;
+#else
+        ogs_error("IFF_MULTI_QUEUE is not supported : dev[%s]", ifname);
+        return INVALID_SOCKET;
+#endif
+    }
+
     fd = open(dev, O_RDWR);
     if (fd < 0)
     {
@@ -62,6 +71,11 @@ ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
 
     ogs_assert(ifname);
 
+    if (multi_queue) {
+        ogs_error("Multiqueue TUN is not supported on this platform");
+        return INVALID_SOCKET;
+    }
+
 #define TUNTAP_ID_MAX 255
     for (tun = 0; tun < TUNTAP_ID_MAX; tun++)
     {
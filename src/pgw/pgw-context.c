@@ -47,6 +47,8 @@ void stats_remove_session(void) {
 
 void pgw_context_init(void)
 {
+    uint32_t size;
+
     ogs_assert(context_initiaized == 0);
 
     /* Initial FreeDiameter Config */
@@ -79,7 +81,15 @@ void pgw_context_init(void)
 
     ogs_pool_init(&pgw_pf_pool, ogs_config()->pool.pf);
 
-    self.sess_hash = ogs_hash_make();
+    self.sess_hash = ogs_hash_make_size(ogs_config()->pool.sess);
+
+    /* UE IP Address Index : one IPv4 and one IPv6 snapshot per session */
+    size = 1;
+    while (size < ogs_config()->pool.sess * 2)
+        size <<= 1;
+    self.dl_bucket = calloc(size, sizeof(pgw_dl_t *));
+    ogs_assert(self.dl_bucket);
+    self.dl_mask = size - 1;
 
     ogs_list_init(&self.sess_list);
 
@@ -97,6 +107,10 @@ void pgw_context_final(void)
 
     ogs_assert(self.sess_hash);
     ogs_hash_destroy(self.sess_hash);
+    ogs_assert(self.dl_bucket);
+    free(self.dl_bucket);
+    self.dl_bucket = NULL;
+    self.dl_mask = 0;
 
     ogs_pool_final(&pgw_bearer_pool);
     ogs_pool_final(&pgw_sess_pool);
@@ -766,6 +780,150 @@ static void *sess_hash_keygen(uint8_t *out, int *out_len,
     return out;
 }
 
+static uint32_t dl_hash(uint8_t ipv, uint32_t *addr)
+{
+    uint32_t h = (ipv == 4) ? addr[0] : (addr[0] ^ addr[1]);
+
+    h *= 0x9e3779b1;
+    return (h ^ (h >> 16)) & self.dl_mask;
+}
+
+static int dl_key_cmp(pgw_dl_t *dl, uint8_t ipv, uint32_t *addr)
+{
+    if (dl->ipv != ipv)
+        return 1;
+    if (ipv == 4)
+        return dl->addr[0] != addr[0];
+    return memcmp(dl->addr, addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3);
+}
+
+static void dl_target(pgw_dl_target_t *target, pgw_bearer_t *bearer)
+{
+    if (bearer->gnode && bearer->sgw_s5u_teid) {
+        target->teid = bearer->sgw_s5u_teid;
+        memcpy(&target->addr, &bearer->gnode->remote_addr,
+                sizeof target->addr);
+    }
+}
+
+static pgw_dl_t *dl_build(pgw_sess_t *sess, uint8_t ipv, uint32_t *addr)
+{
+    pgw_classifier_t *classifier = &sess->classifier;
+    pgw_bearer_t *default_bearer = NULL;
+    pgw_dl_t *dl = NULL;
+    int i;
+
+    default_bearer = pgw_default_bearer_in_sess(sess);
+    ogs_assert(default_bearer);
+
+    /* Rules and their targets follow the snapshot in one allocation */
+    dl = ogs_calloc(1, sizeof(*dl) + classifier->num_of_rule *
+            (sizeof(pgw_classifier_rule_t) + sizeof(pgw_dl_target_t)));
+    ogs_assert(dl);
+
+    dl->sess = sess;
+    dl->ipv = ipv;
+    if (ipv == 4)
+        dl->addr[0] = addr[0];
+    else
+        memcpy(dl->addr, addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3);
+
+    dl_target(&dl->target, default_bearer);
+
+    dl->num_of_rule = classifier->num_of_rule;
+    dl->rule = (pgw_classifier_rule_t *)(dl + 1);
+    dl->rule_target = (pgw_dl_target_t *)(dl->rule + dl->num_of_rule);
+    for (i = 0; i < dl->num_of_rule; i++) {
+        memcpy(&dl->rule[i], &classifier->rule[i], sizeof(dl->rule[i]));
+        dl->rule[i].bearer = NULL;  /* Workers must not touch the bearer */
+        dl_target(&dl->rule_target[i], classifier->rule[i].bearer);
+    }
+
+    return dl;
+}
+
+static void dl_link(pgw_dl_t *dl)
+{
+    pgw_dl_t **head = &self.dl_bucket[dl_hash(dl->ipv, dl->addr)];
+
+    dl->next = *head;
+    ogs_atomic_store(head, dl);
+}
+
+static void dl_unlink(pgw_dl_t *dl)
+{
+    pgw_dl_t **prev = &self.dl_bucket[dl_hash(dl->ipv, dl->addr)];
+
+    while (*prev && *prev != dl)
+        prev = &(*prev)->next;
+    ogs_assert(*prev);
+
+    /* Readers standing on dl can still follow dl->next */
+    ogs_atomic_store(prev, dl->next);
+}
+
+static void dl_free(void *data)
+{
+    ogs_free(data);
+}
+
+/* Workers may still be reading it, so it is freed after a grace period */
+static void dl_retire(pgw_dl_t *dl)
+{
+    dl_unlink(dl);
+    if (self.fwd_table)
+        ogs_gtp_fwd_retire(self.fwd_table, &dl->retired, dl_free);
+    else
+        dl_free(dl);
+}
+
+static void sess_unpublish(pgw_sess_t *sess)
+{
+    if (sess->dl4) dl_retire(sess->dl4);
+    if (sess->dl6) dl_retire(sess->dl6);
+    sess->dl4 = sess->dl6 = NULL;
+}
+
+void pgw_sess_publish(pgw_sess_t *sess)
+{
+    pgw_dl_t *old4 = NULL, *old6 = NULL;
+
+    ogs_assert(sess);
+
+    old4 = sess->dl4;
+    old6 = sess->dl6;
+
+    /* New snapshot is linked in front, so it hides the old one */
+    if (sess->ipv4) {
+        sess->dl4 = dl_build(sess, 4, sess->ipv4->addr);
+        dl_link(sess->dl4);
+    }
+    if (sess->ipv6) {
+        sess->dl6 = dl_build(sess, 6, sess->ipv6->addr);
+        dl_link(sess->dl6);
+    }
+
+    if (old4) dl_retire(old4);
+    if (old6) dl_retire(old6);
+}
+
+pgw_dl_t *pgw_dl_find(uint8_t ipv, uint32_t *addr)
+{
+    pgw_dl_t *dl = NULL;
+
+    ogs_assert(self.dl_bucket);
+    ogs_assert(addr);
+
+    dl = ogs_atomic_load(&self.dl_bucket[dl_hash(ipv, addr)]);
+    while (dl) {
+        if (dl_key_cmp(dl, ipv, addr) == 0)
+            return dl;
+        dl = ogs_atomic_load(&dl->next);
+    }
+
+    return NULL;
+}
+
 pgw_sess_t *pgw_sess_add(
         uint8_t *imsi, int imsi_len, char *apn, 
         uint8_t pdn_type, uint8_t ebi, ogs_paa_t *paa)
@@ -850,6 +1008,10 @@ pgw_sess_t *pgw_sess_add(
     ogs_hash_set(self.sess_hash, sess->hash_keybuf, sess->hash_keylen, sess);
 
     ogs_list_add(&self.sess_list, sess);
+
+    /* UE IP Address is known only now */
+    pgw_bearer_publish(bearer);
+    pgw_sess_publish(sess);
     
     stats_add_session();
 
@@ -862,6 +1024,8 @@ int pgw_sess_remove(pgw_sess_t *sess)
 
     ogs_list_remove(&self.sess_list, sess);
 
+    sess_unpublish(sess);
+
     ogs_hash_set(self.sess_hash, sess->hash_keybuf, sess->hash_keylen, NULL);
 
     if (sess->ipv4)
@@ -871,6 +1035,9 @@ int pgw_sess_remove(pgw_sess_t *sess)
 
     pgw_bearer_remove_all(sess);
 
+    if (sess->classifier.rule)
+        ogs_free(sess->classifier.rule);
+
     ogs_pool_free(&pgw_sess_pool, sess);
 
     stats_remove_session();
@@ -909,6 +1076,23 @@ pgw_sess_t *pgw_sess_find_by_imsi_apn(
     return (pgw_sess_t *)ogs_hash_get(self.sess_hash, keybuf, keylen);
 }
 
+pgw_sess_t *pgw_sess_find_by_ipv4(uint32_t addr)
+{
+    pgw_dl_t *dl = pgw_dl_find(4, &addr);
+
+    return dl ? dl->sess : NULL;
+}
+
+pgw_sess_t *pgw_sess_find_by_ipv6(uint32_t *addr6)
+{
+    pgw_dl_t *dl = NULL;
+
+    ogs_assert(addr6);
+
+    dl = pgw_dl_find(6, addr6);
+    return dl ? dl->sess : NULL;
+}
+
 pgw_sess_t *pgw_sess_add_by_message(ogs_gtp_message_t *message)
 {
     pgw_sess_t *sess = NULL;
@@ -1006,6 +1190,8 @@ pgw_bearer_t *pgw_bearer_add(pgw_sess_t *sess)
 
     ogs_list_add(&sess->bearer_list, bearer);
 
+    pgw_bearer_publish(bearer);
+
     return bearer;
 }
 
@@ -1016,6 +1202,9 @@ int pgw_bearer_remove(pgw_bearer_t *bearer)
 
     ogs_list_remove(&bearer->sess->bearer_list, bearer);
 
+    if (self.fwd_table)
+        ogs_gtp_fwd_remove(self.fwd_table, bearer->pgw_s5u_teid);
+
     if (bearer->name)
         ogs_free(bearer->name);
 
@@ -1026,6 +1215,30 @@ int pgw_bearer_remove(pgw_bearer_t *bearer)
     return OGS_OK;
 }
 
+void pgw_bearer_publish(pgw_bearer_t *bearer)
+{
+    pgw_sess_t *sess = NULL;
+    ogs_gtp_fwd_t fwd;
+
+    ogs_assert(bearer);
+    sess = bearer->sess;
+    ogs_assert(sess);
+
+    if (!self.fwd_table)
+        return;
+
+    memset(&fwd, 0, sizeof fwd);
+    fwd.action = OGS_GTP_FWD_TUN;
+    fwd.tun_fd = INVALID_SOCKET;
+    fwd.tun_fd6 = INVALID_SOCKET;
+    if (sess->ipv4 && sess->ipv4->subnet && sess->ipv4->subnet->dev)
+        fwd.tun_fd = sess->ipv4->subnet->dev->fd;
+    if (sess->ipv6 && sess->ipv6->subnet && sess->ipv6->subnet->dev)
+        fwd.tun_fd6 = sess->ipv6->subnet->dev->fd;
+
+    ogs_gtp_fwd_update(self.fwd_table, bearer->pgw_s5u_teid, &fwd);
+}
+
 void pgw_bearer_remove_all(pgw_sess_t *sess)
 {
     pgw_bearer_t *bearer = NULL, *next_bearer = NULL;
@@ -1146,6 +1359,7 @@ pgw_pf_t *pgw_pf_add(pgw_bearer_t *bearer, uint32_t precedence)
     memset(pf, 0, sizeof *pf);
 
     pf->identifier = OGS_NEXT_ID(bearer->pf_identifier, 1, 15);
+    pf->precedence = precedence;
     pf->bearer = bearer;
 
     ogs_list_add(&bearer->pf_list, pf);
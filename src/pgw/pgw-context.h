@@ -42,6 +42,8 @@ extern int __pgw_log_domain;
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __pgw_log_domain
 
+typedef struct pgw_dl_s pgw_dl_t;
+
 typedef struct pgw_context_s {
     const char*         diam_conf_path;   /* PGW Diameter conf path */
     ogs_diam_config_t   *diam_config;     /* PGW Diameter config */
@@ -71,6 +73,10 @@ typedef struct pgw_context_s {
     ogs_timer_mgr_t *timer_mgr;     /* Timer Manager */
     ogs_pollset_t   *pollset;       /* Poll Set for I/O Multiplexing */
 
+    ogs_gtp_fwd_table_t *fwd_table; /* GTP-U Forwarding for Worker Threads */
+    pgw_dl_t        **dl_bucket;    /* Downlink Snapshot by UE IP Address */
+    uint32_t        dl_mask;
+
 #define MAX_NUM_OF_DNS              2
     const char      *dns[MAX_NUM_OF_DNS];
     const char      *dns6[MAX_NUM_OF_DNS];
@@ -107,6 +113,10 @@ typedef struct pgw_dev_s {
     char            ifname[IFNAMSIZ];
     ogs_socket_t    fd;
 
+    /* Multiqueue TUN : queue[0] is the same as fd */
+    ogs_socket_t    queue[OGS_MAX_NUM_OF_GTPU_WORKER];
+    int             num_of_queue;
+
     ogs_sockaddr_t  *link_local_addr;
     ogs_poll_t      *poll;
 } pgw_dev_t;
@@ -136,6 +146,60 @@ typedef struct pgw_subnet_s {
     pgw_dev_t       *dev;           /* Related Context */
 } pgw_subnet_t;
 
+typedef struct pgw_bearer_s pgw_bearer_t;
+typedef struct pgw_classifier_rule_s {
+    /* Pre-masked addresses, IPv4 uses only the first word */
+    uint32_t        local_addr[4];
+    uint32_t        local_mask[4];
+    uint32_t        remote_addr[4];
+    uint32_t        remote_mask[4];
+
+    /* Inclusive ranges, 0-65535 if not specified */
+    uint16_t        local_port_low;
+    uint16_t        local_port_high;
+    uint16_t        remote_port_low;
+    uint16_t        remote_port_high;
+
+    uint8_t         proto;          /* 0 : Any protocol */
+    uint8_t         ipv;            /* 0 : Any, 4 : IPv4, 6 : IPv6 */
+    uint32_t        precedence;
+
+    pgw_bearer_t    *bearer;
+} pgw_classifier_rule_t;
+
+typedef struct pgw_classifier_s {
+    pgw_classifier_rule_t *rule;    /* Sorted by precedence */
+    int             num_of_rule;
+    int             max_num_of_rule;
+} pgw_classifier_t;
+
+typedef struct pgw_dl_target_s {
+    uint32_t        teid;           /* SGW-S5U-TEID, 0 : Not yet known */
+    ogs_sockaddr_t  addr;           /* SGW-S5U Address */
+} pgw_dl_target_t;
+
+/*
+ * Downlink Snapshot for GTP-U Workers
+ *
+ * Read-only copy of the session's classifier and SGW-S5U targets,
+ * chained by UE IP address and replaced as a whole on any change.
+ * This chain is also the only UE IP address index of the sessions.
+ */
+struct pgw_dl_s {
+    ogs_gtp_retired_t retired;      /* Must be first */
+    pgw_dl_t        *next;          /* Hash Chain */
+    struct pgw_sess_s *sess;        /* Main thread only */
+
+    uint8_t         ipv;            /* 4 or 6 */
+    uint32_t        addr[4];        /* UE IPv4 Address or IPv6 Prefix */
+
+    pgw_dl_target_t target;         /* Default Bearer */
+
+    pgw_classifier_rule_t *rule;
+    pgw_dl_target_t *rule_target;
+    int             num_of_rule;
+};
+
 typedef struct pgw_sess_s {
     ogs_lnode_t     lnode;
     uint32_t        index;          /**< An index of this node */
@@ -164,6 +228,13 @@ typedef struct pgw_sess_s {
 
     ogs_list_t      bearer_list;
 
+    /* Downlink Packet Filters of Dedicated Bearers */
+    pgw_classifier_t classifier;
+
+    /* Published for GTP-U Workers */
+    pgw_dl_t        *dl4;
+    pgw_dl_t        *dl6;
+
     /* Related Context */
     ogs_gtp_node_t  *gnode;
 } pgw_sess_t;
@@ -224,6 +295,7 @@ typedef struct pgw_pf_s {
 ED3(uint8_t spare:2;,
     uint8_t direction:2;,
     uint8_t identifier:4;)
+    uint32_t        precedence;
     pgw_rule_t      rule;
 
     pgw_bearer_t    *bearer;
@@ -246,9 +318,15 @@ void pgw_sess_remove_all(void);
 pgw_sess_t *pgw_sess_find(uint32_t index);
 pgw_sess_t *pgw_sess_find_by_teid(uint32_t teid);
 pgw_sess_t *pgw_sess_find_by_imsi_apn(uint8_t *imsi, int imsi_len, char *apn);
+pgw_sess_t *pgw_sess_find_by_ipv4(uint32_t addr);
+pgw_sess_t *pgw_sess_find_by_ipv6(uint32_t *addr6);
+void pgw_sess_publish(pgw_sess_t *sess);
+
+pgw_dl_t *pgw_dl_find(uint8_t ipv, uint32_t *addr);
 
 pgw_bearer_t *pgw_bearer_add(pgw_sess_t *sess);
 int pgw_bearer_remove(pgw_bearer_t *bearer);
+void pgw_bearer_publish(pgw_bearer_t *bearer);
 void pgw_bearer_remove_all(pgw_sess_t *sess);
 pgw_bearer_t *pgw_bearer_find(uint32_t index);
 pgw_bearer_t *pgw_bearer_find_by_pgw_s5u_teid(uint32_t pgw_s5u_teid);
@@ -44,44 +44,58 @@
 uint16_t in_cksum(uint16_t *addr, int len);
 static int pgw_gtp_handle_multicast(ogs_pkbuf_t *recvbuf);
 static int pgw_gtp_handle_slaac(pgw_sess_t *sess, ogs_pkbuf_t *recvbuf);
+static void gtp_encap(uint32_t teid, ogs_pkbuf_t *sendbuf);
+static void pgw_gtp_encap(pgw_bearer_t *bearer, ogs_pkbuf_t *sendbuf);
 static int pgw_gtp_send_to_bearer(pgw_bearer_t *bearer, ogs_pkbuf_t *sendbuf);
 static int pgw_gtp_send_router_advertisement(
         pgw_sess_t *sess, uint8_t *ip6_dst);
 
+static ogs_gtp_batch_t packet_batch;
+
+static ogs_gtp_worker_t worker[OGS_MAX_NUM_OF_GTPU_WORKER];
+static int num_of_worker = 0;
+
+/* Packets handed over from the workers to the PGW thread */
+typedef struct punt_s {
+#define PUNT_GTPU   1   /* GTP-U packet from SGW */
+#define PUNT_TUN    2   /* IP packet from TUN */
+    int type;
+    ogs_pkbuf_t *pkbuf;
+} punt_t;
+static ogs_queue_t *punt_queue = NULL;
+
 static void _gtpv1_tun_recv_cb(short when, ogs_socket_t fd, void *data)
 {
     ogs_pkbuf_t *recvbuf = NULL;
-    int n;
+    int i;
     int rv;
     pgw_bearer_t *bearer = NULL;
 
-    recvbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
-    ogs_pkbuf_reserve(recvbuf, OGS_GTPV1U_HEADER_LEN);
-    ogs_pkbuf_put(recvbuf, OGS_MAX_SDU_LEN-OGS_GTPV1U_HEADER_LEN);
+    /* TUN is non-blocking; drain up to a batch of packets per wakeup */
+    for (i = 0; i < packet_batch.size; i++) {
+        recvbuf = ogs_gtp_batch_read(
+                &packet_batch, fd, OGS_GTPV1U_HEADER_LEN);
+        if (!recvbuf)
+            break;
+
+        /* Find the bearer by packet filter */
+        bearer = pgw_bearer_find_by_packet(recvbuf);
+        if (bearer) {
+            /* Unicast */
+            pgw_gtp_encap(bearer, recvbuf);
+            ogs_gtp_batch_sendto(&packet_batch, bearer->gnode, recvbuf);
+            continue;
+        } else {
+            if (ogs_config()->parameter.multicast) {
+                rv = pgw_gtp_handle_multicast(recvbuf);
+                ogs_assert(rv != OGS_ERROR);
+            }
+        }
 
-    n = ogs_read(fd, recvbuf->data, recvbuf->len);
-    if (n <= 0) {
-        ogs_log_message(OGS_LOG_WARN, ogs_socket_errno, "ogs_read() failed");
         ogs_pkbuf_free(recvbuf);
-        return;
     }
 
-    ogs_pkbuf_trim(recvbuf, n);
-
-    /* Find the bearer by packet filter */
-    bearer = pgw_bearer_find_by_packet(recvbuf);
-    if (bearer) {
-        /* Unicast */
-        rv = pgw_gtp_send_to_bearer(bearer, recvbuf);
-        ogs_assert(rv == OGS_OK);
-    } else {
-        if (ogs_config()->parameter.multicast) {
-            rv = pgw_gtp_handle_multicast(recvbuf);
-            ogs_assert(rv != OGS_ERROR);
-        }
-    }
-
-    ogs_pkbuf_free(recvbuf);
+    ogs_gtp_batch_flush(&packet_batch);
 }
 
 static void _gtpv2_c_recv_cb(short when, ogs_socket_t fd, void *data)
@@ -127,11 +141,9 @@ static void _gtpv2_c_recv_cb(short when, ogs_socket_t fd, void *data)
     }
 }
 
-static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+static void gtpv1_u_handle(ogs_pkbuf_t *pkbuf)
 {
     int rv;
-    ssize_t size;
-    ogs_pkbuf_t *pkbuf = NULL;
     uint32_t len = OGS_GTPV1U_HEADER_LEN;
     ogs_gtp_header_t *gtp_h = NULL;
     struct ip *ip_h = NULL;
@@ -142,20 +154,6 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     pgw_subnet_t *subnet = NULL;
     pgw_dev_t *dev = NULL;
 
-    ogs_assert(fd != INVALID_SOCKET);
-
-    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
-    ogs_pkbuf_put(pkbuf, OGS_MAX_SDU_LEN);
-
-    size = ogs_recv(fd, pkbuf->data, pkbuf->len, 0);
-    if (size <= 0) {
-        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
-                "ogs_recv() failed");
-        goto cleanup;
-    }
-
-    ogs_pkbuf_trim(pkbuf, size);
-
     ogs_assert(pkbuf);
     ogs_assert(pkbuf->len);
 
@@ -173,7 +171,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
     bearer = pgw_bearer_find_by_pgw_s5u_teid(teid);
     if (!bearer) {
-        ogs_warn("[DROP] Cannot find PGW S5U bearer : TEID[0x%x]", teid);
+        ogs_warn_ratelimited(
+                "[DROP] Cannot find PGW S5U bearer : TEID[0x%x]", teid);
         goto cleanup;
     }
     sess = bearer->sess;
@@ -186,7 +185,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
     if (!subnet) {
         ogs_log_hexdump(OGS_LOG_TRACE, pkbuf->data, pkbuf->len);
-        ogs_error("[DROP] Cannot find subnet V:%d, IPv4:%p, IPv6:%p",
+        ogs_error_ratelimited(
+                "[DROP] Cannot find subnet V:%d, IPv4:%p, IPv6:%p",
                 ip_h->ip_v, sess->ipv4, sess->ipv6);
         goto cleanup;
     }
@@ -209,6 +209,192 @@ cleanup:
     ogs_pkbuf_free(pkbuf);
 }
 
+static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    int i, n;
+
+    ogs_assert(fd != INVALID_SOCKET);
+
+    n = ogs_gtp_batch_recv(&packet_batch, fd);
+    for (i = 0; i < n; i++)
+        gtpv1_u_handle(packet_batch.recvbuf[i]);
+}
+
+static void punt(int type, ogs_pkbuf_t *pkbuf)
+{
+    punt_t *p = NULL;
+    int rv;
+
+    p = ogs_calloc(1, sizeof *p);
+    ogs_assert(p);
+
+    p->type = type;
+    p->pkbuf = ogs_pkbuf_alloc(NULL, OGS_GTPV1U_HEADER_LEN + pkbuf->len);
+    if (type == PUNT_TUN)
+        ogs_pkbuf_reserve(p->pkbuf, OGS_GTPV1U_HEADER_LEN);
+    ogs_pkbuf_put_data(p->pkbuf, pkbuf->data, pkbuf->len);
+
+    rv = ogs_queue_trypush(punt_queue, p);
+    if (rv != OGS_OK) {
+        ogs_warn_ratelimited("[PGW] Punt queue full, drop packet");
+        ogs_pkbuf_free(p->pkbuf);
+        ogs_free(p);
+        return;
+    }
+
+    ogs_pollset_notify(pgw_self()->pollset);
+}
+
+static void worker_handler(ogs_gtp_worker_t *worker, ogs_socket_t fd)
+{
+    ogs_gtp_batch_t *batch = &worker->batch;
+    ogs_gtp_header_t *gtp_h = NULL;
+    ogs_gtp_fwd_t *fwd = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    struct ip *ip_h = NULL;
+    ogs_socket_t tun_fd;
+    uint32_t len, teid;
+    int i, n;
+
+    n = ogs_gtp_batch_recv(batch, fd);
+    for (i = 0; i < n; i++) {
+        pkbuf = batch->recvbuf[i];
+        gtp_h = (ogs_gtp_header_t *)pkbuf->data;
+        teid = ntohl(gtp_h->teid);
+
+        fwd = ogs_gtp_fwd_find(worker->table, teid);
+        if (!fwd) {
+            ogs_warn_ratelimited(
+                    "[DROP] Cannot find PGW S5U bearer : TEID[0x%x]", teid);
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        len = OGS_GTPV1U_HEADER_LEN;
+        if (gtp_h->flags & OGS_GTPU_FLAGS_S) len += 4;
+
+        if (fwd->action != OGS_GTP_FWD_TUN || pkbuf->len <= len) {
+            punt(PUNT_GTPU, pkbuf);
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        ip_h = (struct ip *)(pkbuf->data + len);
+        if (ip_h->ip_v == 6 && ogs_config()->parameter.no_slaac == 0 &&
+            ((struct ip6_hdr *)ip_h)->ip6_nxt == IPPROTO_ICMPV6) {
+            /* Router Solicitation is answered by the PGW thread */
+            punt(PUNT_GTPU, pkbuf);
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        tun_fd = INVALID_SOCKET;
+        if (ip_h->ip_v == 4)
+            tun_fd = fwd->tun_fd;
+        else if (ip_h->ip_v == 6)
+            tun_fd = fwd->tun_fd6;
+
+        if (tun_fd == INVALID_SOCKET) {
+            ogs_error_ratelimited("[DROP] Cannot find subnet V:%d, TEID[0x%x]",
+                    ip_h->ip_v, teid);
+        } else if (ogs_write(tun_fd, pkbuf->data + len, pkbuf->len - len) <= 0)
+            ogs_error("ogs_write() failed");
+
+        ogs_pkbuf_free(pkbuf);
+    }
+}
+
+static void worker_tun_handler(ogs_gtp_worker_t *worker, ogs_socket_t fd)
+{
+    char buf[OGS_ADDRSTRLEN];
+    ogs_gtp_batch_t *batch = &worker->batch;
+    ogs_pkbuf_t *recvbuf = NULL;
+    ogs_sock_t *sock = NULL;
+    pgw_dl_target_t *target = NULL;
+    pgw_dl_t *dl = NULL;
+    pgw_flow_t flow;
+    int i, k;
+
+    for (i = 0; i < batch->size; i++) {
+        recvbuf = ogs_gtp_batch_read(batch, fd, OGS_GTPV1U_HEADER_LEN);
+        if (!recvbuf)
+            break;
+
+        if (pgw_flow_parse(recvbuf, &flow) != OGS_OK) {
+            ogs_pkbuf_free(recvbuf);
+            continue;
+        }
+
+        dl = pgw_dl_find(flow.ipv, flow.dst_addr);
+        if (!dl) {
+            if (ogs_config()->parameter.multicast)
+                punt(PUNT_TUN, recvbuf);
+            ogs_pkbuf_free(recvbuf);
+            continue;
+        }
+
+        k = pgw_classifier_match(dl->rule, dl->num_of_rule, &flow);
+        target = (k >= 0) ? &dl->rule_target[k] : &dl->target;
+
+        sock = ogs_gtp_worker_sock(worker, target->addr.ogs_sa_family);
+        if (!target->teid || !sock) {
+            ogs_pkbuf_free(recvbuf);
+            continue;
+        }
+
+        gtp_encap(target->teid, recvbuf);
+        ogs_debug("[PGW] SEND GPU-U to SGW[%s] : TEID[0x%x]",
+                OGS_ADDR(&target->addr, buf), target->teid);
+
+        ogs_gtp_batch_add(batch, sock->fd, &target->addr, recvbuf);
+    }
+
+    ogs_gtp_batch_flush(batch);
+}
+
+void pgw_gtp_handle_punted(void)
+{
+    punt_t *p = NULL;
+    int rv;
+
+    if (!punt_queue)
+        return;
+
+    while (ogs_queue_trypop(punt_queue, (void **)&p) == OGS_OK) {
+        ogs_assert(p);
+        if (p->type == PUNT_GTPU) {
+            gtpv1_u_handle(p->pkbuf);
+        } else {
+            rv = pgw_gtp_handle_multicast(p->pkbuf);
+            ogs_assert(rv != OGS_ERROR);
+            ogs_pkbuf_free(p->pkbuf);
+        }
+        ogs_free(p);
+    }
+}
+
+static int tun_open(pgw_dev_t *dev, int num_of_queue)
+{
+    int i;
+
+    /* One queue per worker, the kernel steers each flow to a queue */
+    for (i = 0; i < num_of_queue; i++) {
+        dev->queue[i] = ogs_tun_open(dev->ifname, IFNAMSIZ, 0,
+                num_of_queue > 1);
+        if (dev->queue[i] == INVALID_SOCKET) {
+            while (i--)
+                ogs_closesocket(dev->queue[i]);
+            return OGS_ERROR;
+        }
+        ogs_assert(ogs_nonblocking(dev->queue[i]) == OGS_OK);
+    }
+
+    dev->fd = dev->queue[0];
+    dev->num_of_queue = num_of_queue;
+
+    return OGS_OK;
+}
+
 int pgw_gtp_open(void)
 {
     pgw_dev_t *dev = NULL;
@@ -242,26 +428,57 @@ int pgw_gtp_open(void)
 
     ogs_assert(pgw_self()->gtpc_addr || pgw_self()->gtpc_addr6);
 
-    ogs_list_for_each(&pgw_self()->gtpu_list, node) {
-        sock = ogs_gtp_server(node);
-        ogs_assert(sock);
+    ogs_gtp_batch_init(&packet_batch, NULL, ogs_config()->parameter.gtpu_batch);
 
-        node->poll = ogs_pollset_add(pgw_self()->pollset,
-                OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+    num_of_worker = ogs_config()->parameter.gtpu_worker;
+    if (num_of_worker > OGS_MAX_NUM_OF_GTPU_WORKER) {
+        ogs_warn("Too many GTP-U workers [%d > %d]",
+                num_of_worker, OGS_MAX_NUM_OF_GTPU_WORKER);
+        num_of_worker = OGS_MAX_NUM_OF_GTPU_WORKER;
     }
-    ogs_list_for_each(&pgw_self()->gtpu_list6, node) {
-        sock = ogs_gtp_server(node);
-        ogs_assert(sock);
 
-        node->poll = ogs_pollset_add(pgw_self()->pollset,
-                OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+    if (num_of_worker) {
+        punt_queue = ogs_queue_create(ogs_config()->pool.packet);
+        ogs_assert(punt_queue);
+
+        pgw_self()->fwd_table =
+            ogs_gtp_fwd_table_create(ogs_config()->pool.bearer);
+        ogs_assert(pgw_self()->fwd_table);
+
+        rc = ogs_gtp_worker_init(worker, num_of_worker,
+                &pgw_self()->gtpu_list, &pgw_self()->gtpu_list6,
+                worker_handler, pgw_self()->fwd_table,
+                ogs_config()->parameter.gtpu_batch,
+                ogs_config()->pool.packet, NULL);
+        if (rc != OGS_OK) return rc;
+
+        /* Control messages are sent through the first worker's sockets */
+        pgw_self()->gtpu_sock = worker[0].gtpu_sock;
+        pgw_self()->gtpu_sock6 = worker[0].gtpu_sock6;
+    } else {
+        ogs_list_for_each(&pgw_self()->gtpu_list, node) {
+            sock = ogs_gtp_server(node);
+            ogs_assert(sock);
+
+            node->poll = ogs_pollset_add(pgw_self()->pollset,
+                    OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+        }
+        ogs_list_for_each(&pgw_self()->gtpu_list6, node) {
+            sock = ogs_gtp_server(node);
+            ogs_assert(sock);
+
+            node->poll = ogs_pollset_add(pgw_self()->pollset,
+                    OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+        }
+
+        pgw_self()->gtpu_sock =
+            ogs_socknode_sock_first(&pgw_self()->gtpu_list);
+        pgw_self()->gtpu_sock6 =
+            ogs_socknode_sock_first(&pgw_self()->gtpu_list6);
     }
 
-    pgw_self()->gtpu_sock = ogs_socknode_sock_first(&pgw_self()->gtpu_list);
     if (pgw_self()->gtpu_sock)
         pgw_self()->gtpu_addr = &pgw_self()->gtpu_sock->local_addr;
-
-    pgw_self()->gtpu_sock6 = ogs_socknode_sock_first(&pgw_self()->gtpu_list6);
     if (pgw_self()->gtpu_sock6)
         pgw_self()->gtpu_addr6 = &pgw_self()->gtpu_sock6->local_addr;
 
@@ -280,15 +497,38 @@ int pgw_gtp_open(void)
 
     /* Open Tun interface */
     for (dev = pgw_dev_first(); dev; dev = pgw_dev_next(dev)) {
-        dev->fd = ogs_tun_open(dev->ifname, IFNAMSIZ, 0);
-        if (dev->fd == INVALID_SOCKET) {
-            ogs_error("tun_open(dev:%s) failed", dev->ifname);
-            return OGS_ERROR;
+        rc = OGS_ERROR;
+        if (num_of_worker) {
+            rc = tun_open(dev, num_of_worker);
+            if (rc != OGS_OK)
+                ogs_warn("Multiqueue TUN is not available(dev:%s), "
+                        "downlink stays on the PGW thread", dev->ifname);
+        }
+
+        if (rc == OGS_OK) {
+            int i;
+
+            for (i = 0; i < dev->num_of_queue; i++) {
+                rc = ogs_gtp_worker_add_fd(
+                        &worker[i], dev->queue[i], worker_tun_handler);
+                ogs_assert(rc == OGS_OK);
+            }
+        } else {
+            rc = tun_open(dev, 1);
+            if (rc != OGS_OK) {
+                ogs_error("tun_open(dev:%s) failed", dev->ifname);
+                return OGS_ERROR;
+            }
+
+            dev->poll = ogs_pollset_add(pgw_self()->pollset,
+                    OGS_POLLIN, dev->fd, _gtpv1_tun_recv_cb, NULL);
+            ogs_assert(dev->poll);
         }
+    }
 
-        dev->poll = ogs_pollset_add(pgw_self()->pollset,
-                OGS_POLLIN, dev->fd, _gtpv1_tun_recv_cb, NULL);
-        ogs_assert(dev->poll);
+    if (num_of_worker) {
+        rc = ogs_gtp_worker_run(worker, num_of_worker);
+        if (rc != OGS_OK) return rc;
     }
 
     /* 
@@ -328,10 +568,35 @@ void pgw_gtp_close(void)
     ogs_socknode_remove_all(&pgw_self()->gtpu_list);
     ogs_socknode_remove_all(&pgw_self()->gtpu_list6);
 
+    if (num_of_worker) {
+        punt_t *p = NULL;
+
+        ogs_gtp_worker_stop(worker, num_of_worker);
+        num_of_worker = 0;
+
+        ogs_gtp_fwd_table_destroy(pgw_self()->fwd_table);
+        pgw_self()->fwd_table = NULL;
+
+        while (ogs_queue_trypop(punt_queue, (void **)&p) == OGS_OK) {
+            ogs_pkbuf_free(p->pkbuf);
+            ogs_free(p);
+        }
+        ogs_queue_destroy(punt_queue);
+        punt_queue = NULL;
+    }
+
     for (dev = pgw_dev_first(); dev; dev = pgw_dev_next(dev)) {
-        ogs_pollset_remove(dev->poll);
-        ogs_closesocket(dev->fd);
+        int i;
+
+        if (dev->poll)
+            ogs_pollset_remove(dev->poll);
+        dev->poll = NULL;
+        for (i = 0; i < dev->num_of_queue; i++)
+            ogs_closesocket(dev->queue[i]);
+        dev->num_of_queue = 0;
     }
+
+    ogs_gtp_batch_final(&packet_batch);
 }
 
 static int pgw_gtp_handle_multicast(ogs_pkbuf_t *recvbuf)
@@ -402,16 +667,10 @@ static int pgw_gtp_handle_slaac(pgw_sess_t *sess, ogs_pkbuf_t *recvbuf)
     return OGS_OK;
 }
 
-static int pgw_gtp_send_to_bearer(pgw_bearer_t *bearer, ogs_pkbuf_t *sendbuf)
+static void gtp_encap(uint32_t teid, ogs_pkbuf_t *sendbuf)
 {
-    char buf[OGS_ADDRSTRLEN];
-    int rv;
     ogs_gtp_header_t *gtp_h = NULL;
 
-    ogs_assert(bearer);
-    ogs_assert(bearer->gnode);
-    ogs_assert(bearer->gnode->sock);
-
     /* Add GTP-U header */
     ogs_assert(ogs_pkbuf_push(sendbuf, OGS_GTPV1U_HEADER_LEN));
     gtp_h = (ogs_gtp_header_t *)sendbuf->data;
@@ -424,15 +683,30 @@ static int pgw_gtp_send_to_bearer(pgw_bearer_t *bearer, ogs_pkbuf_t *sendbuf)
     gtp_h->flags = 0x30;
     gtp_h->type = OGS_GTPU_MSGTYPE_GPDU;
     gtp_h->length = htons(sendbuf->len - OGS_GTPV1U_HEADER_LEN);
-    gtp_h->teid = htonl(bearer->sgw_s5u_teid);
+    gtp_h->teid = htonl(teid);
+}
+
+static void pgw_gtp_encap(pgw_bearer_t *bearer, ogs_pkbuf_t *sendbuf)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(bearer);
+    ogs_assert(bearer->gnode);
+    ogs_assert(bearer->gnode->sock);
+
+    gtp_encap(bearer->sgw_s5u_teid, sendbuf);
 
-    /* Send to SGW */
     ogs_debug("[PGW] SEND GPU-U to SGW[%s] : TEID[0x%x]",
         OGS_ADDR(&bearer->gnode->remote_addr, buf),
         bearer->sgw_s5u_teid);
-    rv =  ogs_gtp_sendto(bearer->gnode, sendbuf);
+}
 
-    return rv;
+static int pgw_gtp_send_to_bearer(pgw_bearer_t *bearer, ogs_pkbuf_t *sendbuf)
+{
+    pgw_gtp_encap(bearer, sendbuf);
+
+    /* Send to SGW */
+    return ogs_gtp_sendto(bearer->gnode, sendbuf);
 }
 
 static int pgw_gtp_send_router_advertisement(
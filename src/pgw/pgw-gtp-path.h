@@ -29,6 +29,7 @@ extern "C" {
 
 int pgw_gtp_open(void);
 void pgw_gtp_close(void);
+void pgw_gtp_handle_punted(void);
 
 #ifdef __cplusplus
 }
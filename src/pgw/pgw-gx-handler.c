@@ -23,8 +23,6 @@
 #include "pgw-gx-handler.h"
 #include "pgw-ipfw.h"
 
-#include "ipfw/ipfw2.h"
-
 static void encode_traffic_flow_template(
         ogs_gtp_tft_t *tft, pgw_bearer_t *bearer);
 static void bearer_binding(pgw_sess_t *sess, ogs_diam_gx_message_t *gx_message);
@@ -167,7 +165,7 @@ static void encode_traffic_flow_template(
             memcpy(tft->pf[i].component[j].ipv6.addr, pf->rule.ip.local.addr,
                     sizeof pf->rule.ip.local.addr);
             tft->pf[i].component[j].ipv6.prefixlen =
-                contigmask((uint8_t *)pf->rule.ip.local.mask, 128);
+                pgw_mask_to_prefix(pf->rule.ip.local.mask);
             j++; len += 18;
         }
 
@@ -177,7 +175,7 @@ static void encode_traffic_flow_template(
             memcpy(tft->pf[i].component[j].ipv6.addr, pf->rule.ip.remote.addr,
                     sizeof pf->rule.ip.remote.addr);
             tft->pf[i].component[j].ipv6.prefixlen =
-                contigmask((uint8_t *)pf->rule.ip.remote.mask, 128);
+                pgw_mask_to_prefix(pf->rule.ip.remote.mask);
             j++; len += 18;
         }
 
@@ -318,6 +316,9 @@ static void bearer_binding(pgw_sess_t *sess, ogs_diam_gx_message_t *gx_message)
                 memcpy(&pf->rule, &rule, sizeof(pgw_rule_t));
                 pf->direction = flow->direction;
             }
+            if (pcc_rule->num_of_flow)
+                pgw_compile_classifier(sess);
+
             memset(&tft, 0, sizeof tft);
             if (pcc_rule->num_of_flow)
                 encode_traffic_flow_template(&tft, bearer);
@@ -20,6 +20,8 @@
 #include "pgw-context.h"
 #include "pgw-event.h"
 #include "pgw-sm.h"
+#include "pgw-gtp-path.h"
+#include "pgw-ipfw.h"
 
 #include "pgw-fd-path.h"
 
@@ -33,9 +35,11 @@ int pgw_initialize()
     int rv;
 
     pgw_context_init();
+    pgw_ipfw_init();
     pgw_event_init();
 
-    rv = ogs_gtp_xact_init(pgw_self()->timer_mgr, 512);
+    rv = ogs_gtp_xact_init(
+            pgw_self()->timer_mgr, ogs_config()->pool.xact);
     if (rv != OGS_OK) return rv;
 
     rv = pgw_context_parse_config();
@@ -69,6 +73,7 @@ void pgw_terminate(void)
 
     pgw_fd_final();
 
+    pgw_ipfw_final();
     pgw_context_final();
 
     ogs_gtp_xact_final();
@@ -88,6 +93,9 @@ static void pgw_main(void *data)
         ogs_pollset_poll(pgw_self()->pollset,
                 ogs_timer_mgr_next(pgw_self()->timer_mgr));
 
+        /* GTP-U packets the workers could not forward on their own */
+        pgw_gtp_handle_punted();
+
         /* Process the MESSAGE FIRST.
          *
          * For example, if UE Context Release Complete is received,
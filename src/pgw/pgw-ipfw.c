@@ -25,133 +25,284 @@
 #include <netinet/tcp.h>
 #include <netinet/udp.h>
 #include <arpa/inet.h>
+#include <netdb.h>
+#include <ctype.h>
 
 #include "pgw-ipfw.h"
 
-#include "ipfw/ipfw2.h"
-#include "ipfw/objs/include_e/netinet/ip_fw.h"
+/* Bounded; a full cache is flushed and refilled by the rules in use */
+#define MAX_NUM_OF_RULE_CACHE 1024
+#define MAX_TOKEN_LEN 64
 
-#define MAX_NUM_OF_TOKEN 32
-#define MAX_NUM_OF_RULE_BUFFER 1024
+typedef struct rule_cache_s {
+    char *description;          /* key of rule_cache_hash */
+    pgw_rule_t rule;
+} rule_cache_t;
 
-void compile_rule(char *av[], uint32_t *rbuf, int *rbufsize, void *tstate);
+static OGS_POOL(rule_cache_pool, rule_cache_t);
+static ogs_hash_t *rule_cache_hash;
 
-int pgw_compile_packet_filter(pgw_rule_t *pgw_rule, char *description)
+void pgw_ipfw_init(void)
 {
-    pgw_rule_t zero_rule;
-    char *token, *dir;
-    char *saveptr;
-    int i = 2;
+    ogs_pool_init(&rule_cache_pool, MAX_NUM_OF_RULE_CACHE);
+    rule_cache_hash = ogs_hash_make();
+}
 
-    char *av[MAX_NUM_OF_TOKEN];
-	uint32_t rulebuf[MAX_NUM_OF_RULE_BUFFER];
-	int rbufsize;
-	struct ip_fw_rule *rule = (struct ip_fw_rule *)rulebuf;
+static void rule_cache_clear(void)
+{
+    ogs_hash_index_t *hi = NULL;
+    rule_cache_t *cache = NULL;
 
-	int l;
-	ipfw_insn *cmd;
+    for (hi = ogs_hash_first(rule_cache_hash); hi; hi = ogs_hash_next(hi)) {
+        cache = ogs_hash_this_val(hi);
+        ogs_assert(cache);
 
-    ogs_assert(pgw_rule);
+        ogs_hash_set(rule_cache_hash,
+                cache->description, OGS_HASH_KEY_STRING, NULL);
+        ogs_free(cache->description);
+        ogs_pool_free(&rule_cache_pool, cache);
+    }
+}
 
-	rbufsize = sizeof(rulebuf);
-	memset(rulebuf, 0, rbufsize);
+void pgw_ipfw_final(void)
+{
+    rule_cache_clear();
 
-    av[0] = NULL;
+    ogs_hash_destroy(rule_cache_hash);
+    ogs_pool_final(&rule_cache_pool);
+}
 
-    /* ACTION */
-    if (!description) { /* FIXME : OLD gcc generates uninitialized warning */
-        ogs_assert_if_reached();
+static const char *next_token(const char *p, char *token)
+{
+    int len = 0;
+
+    while (*p == ' ')
+        p++;
+
+    while (*p && *p != ' ') {
+        if (len == MAX_TOKEN_LEN - 1)
+            return NULL;
+        token[len++] = *p++;
+    }
+    token[len] = 0;
+
+    return p;
+}
+
+/*
+ * Returns the family, 0 for "any", or OGS_ERROR.
+ * "assigned" (TS 29.212 5.4.2) is the UE address, which the session
+ * lookup has already matched, so it is taken as "any".
+ */
+static int parse_addr(const char *token, uint32_t *addr, uint32_t *mask)
+{
+    char buf[MAX_TOKEN_LEN];
+    char *bits = NULL;
+    ogs_ipsubnet_t ipsub;
+
+    if (!strcmp(token, "any") || !strcmp(token, "assigned"))
+        return 0;
+
+    strcpy(buf, token);
+    bits = strchr(buf, '/');
+    if (bits) {
+        *bits++ = 0;
+        if (!strcmp(bits, "0"))
+            return 0;
+    }
+
+    if (ogs_ipsubnet(&ipsub, buf, bits) != OGS_OK) {
+        ogs_error("Invalid address : %s", token);
+        return OGS_ERROR;
+    }
+
+    if (ipsub.family == AF_INET) {
+        addr[0] = ipsub.sub[0];
+        mask[0] = ipsub.mask[0];
+    } else {
+        memcpy(addr, ipsub.sub, OGS_IPV6_LEN);
+        memcpy(mask, ipsub.mask, OGS_IPV6_LEN);
+    }
+
+    return ipsub.family;
+}
+
+/* "port", "low-high"; only the first of a comma-separated list is kept */
+static int parse_ports(const char *token, uint16_t *low, uint16_t *high)
+{
+    char *end = NULL;
+    unsigned long l, h;
+
+    l = strtoul(token, &end, 10);
+    h = l;
+    if (*end == '-')
+        h = strtoul(end + 1, &end, 10);
+
+    if ((*end && *end != ',') || l > 65535 || h > 65535 || l > h) {
+        ogs_error("Invalid ports : %s", token);
         return OGS_ERROR;
     }
-    token = strtok_r(description, " ", &saveptr);
-    if (strcmp(token, "permit") != 0) {
+
+    *low = l;
+    *high = h;
+
+    return OGS_OK;
+}
+
+/*
+ * IPFilterRule (RFC 6733 4.3.1) as sent in Flow-Description:
+ *   permit out <proto> from <src> [ports] to <dst> [ports] [options]
+ * <src> fills the local side of pgw_rule_t and <dst> the remote side.
+ * Options are ignored.
+ */
+static int parse_rule(pgw_rule_t *pgw_rule, const char *description)
+{
+    char token[MAX_TOKEN_LEN];
+    const char *p = description;
+    struct protoent *pe = NULL;
+    char *end = NULL;
+    unsigned long proto;
+    int family;
+
+    memset(pgw_rule, 0, sizeof(pgw_rule_t));
+
+    /* ACTION */
+    p = next_token(p, token);
+    if (!p || strcmp(token, "permit") != 0) {
         ogs_error("Not begins with reserved keyword : 'permit'");
         return OGS_ERROR;
     }
-    av[1] = token;
 
-    /* Save DIRECTION */
-    dir = token = strtok_r(NULL, " ", &saveptr);
-    if (strcmp(token, "out") != 0) {
+    /* DIRECTION */
+    p = next_token(p, token);
+    if (!p || strcmp(token, "out") != 0) {
         ogs_error("Not begins with reserved keyword : 'permit out'");
         return OGS_ERROR;
     }
 
-    /* ADDR */
-    token = strtok_r(NULL, " ", &saveptr);
-    while (token != NULL) {
-        av[i++] = token;
-        token = strtok_r(NULL, " ", &saveptr);
+    /* PROTO */
+    p = next_token(p, token);
+    if (!p || !token[0]) {
+        ogs_error("No protocol : %s", description);
+        return OGS_ERROR;
+    }
+    if (strcmp(token, "ip") != 0) {
+        proto = strtoul(token, &end, 10);
+        if (*end) {
+            pe = getprotobyname(token);
+            if (!pe) {
+                ogs_error("Unknown protocol : %s", token);
+                return OGS_ERROR;
+            }
+            proto = pe->p_proto;
+        } else if (proto > 255) {
+            ogs_error("Invalid protocol : %s", token);
+            return OGS_ERROR;
+        }
+        pgw_rule->proto = proto;
+    }
+
+    /* SOURCE */
+    p = next_token(p, token);
+    if (!p || strcmp(token, "from") != 0) {
+        ogs_error("No 'from' : %s", description);
+        return OGS_ERROR;
+    }
+    p = next_token(p, token);
+    if (!p)
+        return OGS_ERROR;
+    family = parse_addr(token,
+            pgw_rule->ip.local.addr, pgw_rule->ip.local.mask);
+    if (family == OGS_ERROR)
+        return OGS_ERROR;
+    pgw_rule->ipv4_local = (family == AF_INET);
+    pgw_rule->ipv6_local = (family == AF_INET6);
+
+    p = next_token(p, token);
+    if (p && isdigit(token[0])) {
+        if (parse_ports(token, &pgw_rule->port.local.low,
+                    &pgw_rule->port.local.high) != OGS_OK)
+            return OGS_ERROR;
+        p = next_token(p, token);
+    }
+
+    /* DESTINATION */
+    if (!p || strcmp(token, "to") != 0) {
+        ogs_error("No 'to' : %s", description);
+        return OGS_ERROR;
+    }
+    p = next_token(p, token);
+    if (!p)
+        return OGS_ERROR;
+    family = parse_addr(token,
+            pgw_rule->ip.remote.addr, pgw_rule->ip.remote.mask);
+    if (family == OGS_ERROR)
+        return OGS_ERROR;
+    pgw_rule->ipv4_remote = (family == AF_INET);
+    pgw_rule->ipv6_remote = (family == AF_INET6);
+
+    p = next_token(p, token);
+    if (p && isdigit(token[0])) {
+        if (parse_ports(token, &pgw_rule->port.remote.low,
+                    &pgw_rule->port.remote.high) != OGS_OK)
+            return OGS_ERROR;
     }
 
-    /* Add DIRECTION */
-    av[i++] = dir;
+    return OGS_OK;
+}
 
-    av[i] = NULL;
+void pgw_prefix_to_mask(uint32_t *mask, int prefixlen)
+{
+    uint8_t *p = (uint8_t *)mask;
+    int i;
 
-	compile_rule(av, (uint32_t *)rule, &rbufsize, NULL);
+    ogs_assert(mask);
+    ogs_assert(prefixlen >= 0 && prefixlen <= 128);
 
-    memset(pgw_rule, 0, sizeof(pgw_rule_t));
-	for (l = rule->act_ofs, cmd = rule->cmd;
-			l > 0 ; l -= F_LEN(cmd) , cmd += F_LEN(cmd)) {
-        uint32_t *a = NULL;
-        uint16_t *p = NULL;
-		switch (cmd->opcode) {
-        case O_PROTO:
-            pgw_rule->proto = cmd->arg1;
-            break;
-        case O_IP_SRC:
-        case O_IP_SRC_MASK:
-            a = ((ipfw_insn_u32 *)cmd)->d;
-            pgw_rule->ipv4_local = 1;
-            pgw_rule->ip.local.addr[0] = a[0];
-            if (cmd->opcode == O_IP_SRC_MASK)
-                pgw_rule->ip.local.mask[0] = a[1];
-            else
-                pgw_rule->ip.local.mask[0] = 0xffffffff;
-            break;
-        case O_IP_DST:
-        case O_IP_DST_MASK:
-            a = ((ipfw_insn_u32 *)cmd)->d;
-            pgw_rule->ipv4_remote = 1;
-            pgw_rule->ip.remote.addr[0] = a[0];
-            if (cmd->opcode == O_IP_DST_MASK)
-                pgw_rule->ip.remote.mask[0] = a[1];
-            else
-                pgw_rule->ip.remote.mask[0] = 0xffffffff;
-            break;
-        case O_IP6_SRC:
-        case O_IP6_SRC_MASK:
-            a = ((ipfw_insn_u32 *)cmd)->d;
-            pgw_rule->ipv6_local = 1;
-            memcpy(pgw_rule->ip.local.addr, a, OGS_IPV6_LEN);
-            if (cmd->opcode == O_IP6_SRC_MASK)
-                memcpy(pgw_rule->ip.local.mask, a+4, OGS_IPV6_LEN);
-            else
-                n2mask((struct in6_addr *)pgw_rule->ip.local.mask, 128);
-            break;
-        case O_IP6_DST:
-        case O_IP6_DST_MASK:
-            a = ((ipfw_insn_u32 *)cmd)->d;
-            pgw_rule->ipv6_remote = 1;
-            memcpy(pgw_rule->ip.remote.addr, a, OGS_IPV6_LEN);
-            if (cmd->opcode == O_IP6_DST_MASK)
-                memcpy(pgw_rule->ip.remote.mask, a+4, OGS_IPV6_LEN);
-            else
-                n2mask((struct in6_addr *)pgw_rule->ip.remote.mask, 128);
-            break;
-        case O_IP_SRCPORT:
-            p = ((ipfw_insn_u16 *)cmd)->ports;
-            pgw_rule->port.local.low = p[0];
-            pgw_rule->port.local.high = p[1];
-            break;
-        case O_IP_DSTPORT:
-            p = ((ipfw_insn_u16 *)cmd)->ports;
-            pgw_rule->port.remote.low = p[0];
-            pgw_rule->port.remote.high = p[1];
+    memset(mask, 0, OGS_IPV6_LEN);
+    for (i = 0; i < prefixlen / 8; i++)
+        p[i] = 0xff;
+    if (prefixlen % 8)
+        p[i] = 0xff << (8 - prefixlen % 8);
+}
+
+/* Returns -1 if the mask is not contiguous */
+int pgw_mask_to_prefix(const uint32_t *mask)
+{
+    const uint8_t *p = (const uint8_t *)mask;
+    int i, n;
+
+    ogs_assert(mask);
+
+    for (i = 0; i < 128; i++)
+        if ((p[i/8] & (1 << (7 - i%8))) == 0)
             break;
-        }
-	}
+    for (n = i + 1; n < 128; n++)
+        if ((p[n/8] & (1 << (7 - n%8))) != 0)
+            return -1;
+
+    return i;
+}
+
+int pgw_compile_packet_filter(pgw_rule_t *pgw_rule, const char *description)
+{
+    pgw_rule_t zero_rule;
+    rule_cache_t *cache = NULL;
+    int rv;
+
+    ogs_assert(pgw_rule);
+    ogs_assert(description);
+
+    /* PCRF installs the same few Flow-Descriptions for every subscriber */
+    cache = ogs_hash_get(rule_cache_hash, description, OGS_HASH_KEY_STRING);
+    if (cache) {
+        memcpy(pgw_rule, &cache->rule, sizeof(pgw_rule_t));
+        return OGS_OK;
+    }
+
+    rv = parse_rule(pgw_rule, description);
+    if (rv != OGS_OK)
+        return rv;
 
     memset(&zero_rule, 0, sizeof(pgw_rule_t));
     if (memcmp(pgw_rule, &zero_rule, sizeof(pgw_rule_t)) == 0) {
@@ -159,9 +310,110 @@ int pgw_compile_packet_filter(pgw_rule_t *pgw_rule, char *description)
         return OGS_ERROR;
     }
 
+    ogs_pool_alloc(&rule_cache_pool, &cache);
+    if (!cache) {
+        rule_cache_clear();
+        ogs_pool_alloc(&rule_cache_pool, &cache);
+    }
+    ogs_assert(cache);
+
+    cache->description = ogs_strdup(description);
+    ogs_assert(cache->description);
+    memcpy(&cache->rule, pgw_rule, sizeof(pgw_rule_t));
+
+    ogs_hash_set(rule_cache_hash,
+            cache->description, OGS_HASH_KEY_STRING, cache);
+
     return OGS_OK;
 }
 
+void pgw_compile_classifier(pgw_sess_t *sess)
+{
+    pgw_classifier_t *classifier = NULL;
+    pgw_bearer_t *default_bearer = NULL;
+    pgw_bearer_t *bearer = NULL;
+    pgw_pf_t *pf = NULL;
+    int num_of_rule = 0;
+    int i, k;
+
+    ogs_assert(sess);
+    classifier = &sess->classifier;
+
+    default_bearer = pgw_default_bearer_in_sess(sess);
+    ogs_assert(default_bearer);
+
+    ogs_list_for_each(&sess->bearer_list, bearer) {
+        if (bearer == default_bearer || bearer->ebi == 0)
+            continue;
+        ogs_list_for_each(&bearer->pf_list, pf) {
+            if (pf->direction == OGS_FLOW_DOWNLINK_ONLY)
+                num_of_rule++;
+        }
+    }
+
+    if (num_of_rule > classifier->max_num_of_rule) {
+        classifier->rule = ogs_realloc(classifier->rule,
+                num_of_rule * sizeof(pgw_classifier_rule_t));
+        ogs_assert(classifier->rule);
+        classifier->max_num_of_rule = num_of_rule;
+    }
+
+    classifier->num_of_rule = 0;
+    ogs_list_for_each(&sess->bearer_list, bearer) {
+        /* Create Bearer Response is not received if EBI is 0 */
+        if (bearer == default_bearer || bearer->ebi == 0)
+            continue;
+
+        ogs_list_for_each(&bearer->pf_list, pf) {
+            pgw_classifier_rule_t *rule = NULL;
+
+            if (pf->direction != OGS_FLOW_DOWNLINK_ONLY)
+                continue;
+
+            /* Insertion sort : keep list order for the same precedence */
+            i = classifier->num_of_rule++;
+            while (i > 0 &&
+                    classifier->rule[i-1].precedence > pf->precedence) {
+                classifier->rule[i] = classifier->rule[i-1];
+                i--;
+            }
+
+            rule = &classifier->rule[i];
+            memset(rule, 0, sizeof(*rule));
+
+            for (k = 0; k < 4; k++) {
+                rule->local_mask[k] = pf->rule.ip.local.mask[k];
+                rule->local_addr[k] =
+                    pf->rule.ip.local.addr[k] & rule->local_mask[k];
+                rule->remote_mask[k] = pf->rule.ip.remote.mask[k];
+                rule->remote_addr[k] =
+                    pf->rule.ip.remote.addr[k] & rule->remote_mask[k];
+            }
+
+            rule->local_port_low = pf->rule.port.local.low;
+            rule->local_port_high = pf->rule.port.local.high ?
+                    pf->rule.port.local.high : 0xffff;
+            rule->remote_port_low = pf->rule.port.remote.low;
+            rule->remote_port_high = pf->rule.port.remote.high ?
+                    pf->rule.port.remote.high : 0xffff;
+
+            rule->proto = pf->rule.proto;
+            if (pf->rule.ipv4_local || pf->rule.ipv4_remote)
+                rule->ipv = 4;
+            else if (pf->rule.ipv6_local || pf->rule.ipv6_remote)
+                rule->ipv = 6;
+
+            rule->precedence = pf->precedence;
+            rule->bearer = bearer;
+        }
+    }
+
+    ogs_debug("[PGW] Compiled %d packet filters for IMSI[%s] APN[%s]",
+            classifier->num_of_rule, sess->imsi_bcd, sess->pdn.apn);
+
+    pgw_sess_publish(sess);
+}
+
 static int decode_ipv6_header(
         struct ip6_hdr *ip6_h, uint8_t *proto, uint16_t *hlen)
 {
@@ -236,226 +488,146 @@ static int decode_ipv6_header(
     return OGS_OK;
 }
 
-pgw_bearer_t *pgw_bearer_find_by_packet(ogs_pkbuf_t *pkt)
+int pgw_flow_parse(ogs_pkbuf_t *pkt, pgw_flow_t *flow)
 {
     struct ip *ip_h =  NULL;
     struct ip6_hdr *ip6_h =  NULL;
-    uint32_t *src_addr = NULL;
-    uint32_t *dst_addr = NULL;
-    int addr_len = 0;
-    uint8_t proto = 0;
     uint16_t ip_hlen = 0;
-    char buf[OGS_ADDRSTRLEN];
-    pgw_sess_t *sess = NULL;
 
     ogs_assert(pkt);
     ogs_assert(pkt->len);
+    ogs_assert(flow);
+
+    memset(flow, 0, sizeof *flow);
 
     ip_h = (struct ip *)pkt->data;
     if (ip_h->ip_v == 4) {
-        ip_h = (struct ip *)pkt->data;
-        ip6_h = NULL;
-
-        proto = ip_h->ip_p;
+        flow->proto = ip_h->ip_p;
         ip_hlen = (ip_h->ip_hl)*4;
 
-        src_addr = &ip_h->ip_src.s_addr;
-        dst_addr = &ip_h->ip_dst.s_addr;
-        addr_len = 4;
+        memcpy(flow->src_addr, &ip_h->ip_src.s_addr, OGS_IPV4_LEN);
+        memcpy(flow->dst_addr, &ip_h->ip_dst.s_addr, OGS_IPV4_LEN);
+        flow->ipv = 4;
+
+        /* Non-first fragment does not carry the transport header */
+        flow->has_port = (ntohs(ip_h->ip_off) & IP_OFFMASK) == 0;
     } else if (ip_h->ip_v == 6) {
-        ip_h = NULL;
         ip6_h = (struct ip6_hdr *)pkt->data;
 
-        decode_ipv6_header(ip6_h, &proto, &ip_hlen);
+        decode_ipv6_header(ip6_h, &flow->proto, &ip_hlen);
 
-        src_addr = (uint32_t *)ip6_h->ip6_src.s6_addr;
-        dst_addr = (uint32_t *)ip6_h->ip6_dst.s6_addr;
-        addr_len = 16;
+        memcpy(flow->src_addr, ip6_h->ip6_src.s6_addr, OGS_IPV6_LEN);
+        memcpy(flow->dst_addr, ip6_h->ip6_dst.s6_addr, OGS_IPV6_LEN);
+        flow->ipv = 6;
 
-    } else
+        flow->has_port = 1;
+    } else {
         ogs_error("Invalid IP version = %d", ip_h->ip_v);
+        return OGS_ERROR;
+    }
+
+    if ((flow->proto == IPPROTO_TCP || flow->proto == IPPROTO_UDP) &&
+            flow->has_port && pkt->len >= ip_hlen + 4) {
+        /* TCP and UDP share the layout of the port fields */
+        struct udphdr *udph = (struct udphdr *)((char *)pkt->data + ip_hlen);
+
+        flow->src_port = ntohs(udph->uh_sport);
+        flow->dst_port = ntohs(udph->uh_dport);
+    } else {
+        flow->has_port = 0;
+    }
 
     ogs_debug("[PGW] PROTO:%d SRC:%08x %08x %08x %08x",
-            proto, ntohl(src_addr[0]), ntohl(src_addr[1]),
-            ntohl(src_addr[2]), ntohl(src_addr[3]));
+            flow->proto, ntohl(flow->src_addr[0]), ntohl(flow->src_addr[1]),
+            ntohl(flow->src_addr[2]), ntohl(flow->src_addr[3]));
     ogs_debug("[PGW] HLEN:%d  DST:%08x %08x %08x %08x",
-            ip_hlen, ntohl(dst_addr[0]), ntohl(dst_addr[1]),
-            ntohl(dst_addr[2]), ntohl(dst_addr[3]));
-
-
-    /* TODO: Need to use the method of FAST matching algorithm and 
-     *          implementation .
-     *       Until be ready, linear searching will be use to find the bearer.
-     */
-
-    ogs_list_for_each(&pgw_self()->sess_list, sess) {
-        if (sess->ipv4)
-            ogs_debug("[PGW] PAA IPv4:%s",
-                    INET_NTOP(&sess->ipv4->addr, buf));
-        if (sess->ipv6)
-            ogs_debug("[PGW] PAA IPv6:%s",
-                    INET6_NTOP(&sess->ipv6->addr, buf));
-
-        if ((sess->ipv4 && memcmp(dst_addr, sess->ipv4->addr, addr_len) == 0) ||
-            (sess->ipv6 && memcmp(dst_addr, sess->ipv6->addr, addr_len) == 0)) {
-            pgw_bearer_t *default_bearer = NULL;
-            pgw_bearer_t *bearer = NULL;
-
-            /* Save the default bearer */
-            default_bearer = pgw_default_bearer_in_sess(sess);
-            ogs_assert(default_bearer);
-
-            /* Found */
-            ogs_debug("[PGW] Found Session : EBI[%d]", default_bearer->ebi);
-
-            bearer = pgw_bearer_next(default_bearer);
-            /* Find the bearer with matched */
-            for (; bearer; bearer = pgw_bearer_next(bearer)) {
-                pgw_pf_t *pf = NULL;
-
-                if (bearer->ebi == 0) {
-                    /* Create Bearer Response is not received */
-                    continue;
-                }
-
-                for (pf = pgw_pf_first(bearer); pf; pf = pgw_pf_next(pf)) {
-                    int k;
-                    uint32_t src_mask[4];
-                    uint32_t dst_mask[4];
-
-                    ogs_debug("DIR:%d PROTO:%d SRC:%d-%d DST:%d-%d",
-                            pf->direction, pf->rule.proto,
-                            pf->rule.port.local.low,
-                            pf->rule.port.local.high,
-                            pf->rule.port.remote.low,
-                            pf->rule.port.remote.high);
-                    ogs_debug("SRC:%08x %08x %08x %08x/%08x %08x %08x %08x",
-                            ntohl(pf->rule.ip.local.addr[0]),
-                            ntohl(pf->rule.ip.local.addr[1]),
-                            ntohl(pf->rule.ip.local.addr[2]),
-                            ntohl(pf->rule.ip.local.addr[3]),
-                            ntohl(pf->rule.ip.local.mask[0]),
-                            ntohl(pf->rule.ip.local.mask[1]),
-                            ntohl(pf->rule.ip.local.mask[2]),
-                            ntohl(pf->rule.ip.local.mask[3]));
-                    ogs_debug("DST:%08x %08x %08x %08x/%08x %08x %08x %08x",
-                            ntohl(pf->rule.ip.remote.addr[0]),
-                            ntohl(pf->rule.ip.remote.addr[1]),
-                            ntohl(pf->rule.ip.remote.addr[2]),
-                            ntohl(pf->rule.ip.remote.addr[3]),
-                            ntohl(pf->rule.ip.remote.mask[0]),
-                            ntohl(pf->rule.ip.remote.mask[1]),
-                            ntohl(pf->rule.ip.remote.mask[2]),
-                            ntohl(pf->rule.ip.remote.mask[3]));
-
-                    if (pf->direction != 1) {
-                        continue;
-                    }
-
-                    for (k = 0; k < 4; k++) {
-                        src_mask[k] = src_addr[k] & pf->rule.ip.local.mask[k];
-                        dst_mask[k] = dst_addr[k] & pf->rule.ip.remote.mask[k];
-                    }
-
-                    if (memcmp(src_mask, pf->rule.ip.local.addr,
-                                addr_len) == 0 &&
-                        memcmp(dst_mask, pf->rule.ip.remote.addr,
-                                addr_len) == 0) {
-                        /* Protocol match */
-                        if (pf->rule.proto == 0) { /* IP */
-                            /* No need to match port */
-                            break;
-                        }
-
-                        if (pf->rule.proto == proto) {
-                            if (pf->rule.proto == IPPROTO_TCP) {
-                                struct tcphdr *tcph = 
-                                    (struct tcphdr *)
-                                    ((char *)pkt->data + ip_hlen);
-
-                                /* Source port */
-                                if (pf->rule.port.local.low && 
-                                      ntohs(tcph->th_sport) < 
-                                              pf->rule.port.local.low) {
-                                    continue;
-                                }
-
-                                if (pf->rule.port.local.high && 
-                                      ntohs(tcph->th_sport) > 
-                                              pf->rule.port.local.high) {
-                                    continue;
-                                }
-
-                                /* Dst Port*/
-                                if (pf->rule.port.remote.low && 
-                                      ntohs(tcph->th_dport) < 
-                                              pf->rule.port.remote.low) {
-                                    continue;
-                                }
-
-                                if (pf->rule.port.remote.high && 
-                                      ntohs(tcph->th_dport) > 
-                                              pf->rule.port.remote.high) {
-                                    continue;
-                                }
-
-                                /* Matched */
-                                break;
-                            } else if (pf->rule.proto == IPPROTO_UDP) {
-                                struct udphdr *udph = 
-                                    (struct udphdr *)
-                                    ((char *)pkt->data + ip_hlen);
-
-                                /* Source port */
-                                if (pf->rule.port.local.low && 
-                                      ntohs(udph->uh_sport) < 
-                                              pf->rule.port.local.low) {
-                                    continue;
-                                }
-
-                                if (pf->rule.port.local.high && 
-                                      ntohs(udph->uh_sport) > 
-                                              pf->rule.port.local.high) {
-                                    continue;
-                                }
-
-                                /* Dst Port*/
-                                if (pf->rule.port.remote.low && 
-                                      ntohs(udph->uh_dport) < 
-                                              pf->rule.port.remote.low) {
-                                    continue;
-                                }
-
-                                if (pf->rule.port.remote.high && 
-                                      ntohs(udph->uh_dport) > 
-                                              pf->rule.port.remote.high) {
-                                    continue;
-                                }
-
-                                /* Matched */
-                                break;
-                            } else {
-                                /* No need to match port */
-                                break;
-                            }
-
-                        }
-                    }
-
-                }
-
-                if (pf) {
-                    bearer = pf->bearer;
-                    ogs_debug("Found Dedicated Bearer : EBI[%d]", bearer->ebi);
-                    break;
-                }
+            ip_hlen, ntohl(flow->dst_addr[0]), ntohl(flow->dst_addr[1]),
+            ntohl(flow->dst_addr[2]), ntohl(flow->dst_addr[3]));
 
-            }
+    return OGS_OK;
+}
+
+int pgw_classifier_match(
+        pgw_classifier_rule_t *rule, int num_of_rule, pgw_flow_t *flow)
+{
+    int i, k;
+
+    ogs_assert(flow);
+
+    for (i = 0; i < num_of_rule; i++, rule++) {
+        uint32_t diff = 0;
 
-            return (bearer ? bearer : default_bearer);
+        if (rule->ipv && rule->ipv != flow->ipv)
+            continue;
+
+        for (k = 0; k < 4; k++) {
+            diff |= (flow->src_addr[k] & rule->local_mask[k]) ^
+                rule->local_addr[k];
+            diff |= (flow->dst_addr[k] & rule->remote_mask[k]) ^
+                rule->remote_addr[k];
+        }
+        if (diff)
+            continue;
+
+        /* Protocol match */
+        if (rule->proto == 0) /* IP */
+            return i;
+        if (rule->proto != flow->proto)
+            continue;
+
+        if (flow->proto == IPPROTO_TCP || flow->proto == IPPROTO_UDP) {
+            if (!flow->has_port)
+                continue;
+            if (flow->src_port < rule->local_port_low ||
+                flow->src_port > rule->local_port_high ||
+                flow->dst_port < rule->remote_port_low ||
+                flow->dst_port > rule->remote_port_high)
+                continue;
         }
+
+        /* Matched */
+        return i;
     }
 
-    return NULL;
+    return -1;
 }
 
+pgw_bearer_t *pgw_bearer_find_by_packet(ogs_pkbuf_t *pkt)
+{
+    pgw_flow_t flow;
+    pgw_sess_t *sess = NULL;
+    pgw_bearer_t *default_bearer = NULL;
+    pgw_classifier_t *classifier = NULL;
+    int i;
+
+    ogs_assert(pkt);
+    ogs_assert(pkt->len);
+
+    if (pgw_flow_parse(pkt, &flow) != OGS_OK)
+        return NULL;
+
+    if (flow.ipv == 4)
+        sess = pgw_sess_find_by_ipv4(flow.dst_addr[0]);
+    else
+        sess = pgw_sess_find_by_ipv6(flow.dst_addr);
+
+    if (!sess)
+        return NULL;
+
+    /* Save the default bearer */
+    default_bearer = pgw_default_bearer_in_sess(sess);
+    ogs_assert(default_bearer);
+
+    /* Found */
+    ogs_debug("[PGW] Found Session : EBI[%d]", default_bearer->ebi);
+
+    classifier = &sess->classifier;
+    i = pgw_classifier_match(classifier->rule, classifier->num_of_rule, &flow);
+    if (i >= 0) {
+        ogs_debug("Found Dedicated Bearer : EBI[%d]",
+                classifier->rule[i].bearer->ebi);
+        return classifier->rule[i].bearer;
+    }
+
+    return default_bearer;
+}
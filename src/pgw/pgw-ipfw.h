@@ -26,7 +26,29 @@
 extern "C" {
 #endif
 
-int pgw_compile_packet_filter(pgw_rule_t *pf, char *description);
+typedef struct pgw_flow_s {
+    uint32_t        src_addr[4];
+    uint32_t        dst_addr[4];
+    uint16_t        src_port;
+    uint16_t        dst_port;
+    int             has_port;
+    uint8_t         ipv;
+    uint8_t         proto;
+} pgw_flow_t;
+
+void pgw_ipfw_init(void);
+void pgw_ipfw_final(void);
+
+int pgw_compile_packet_filter(pgw_rule_t *pf, const char *description);
+
+/* IPv6 prefix length <-> 128-bit mask in network order */
+void pgw_prefix_to_mask(uint32_t *mask, int prefixlen);
+int pgw_mask_to_prefix(const uint32_t *mask);
+void pgw_compile_classifier(pgw_sess_t *sess);
+
+int pgw_flow_parse(ogs_pkbuf_t *pkt, pgw_flow_t *flow);
+int pgw_classifier_match(
+        pgw_classifier_rule_t *rule, int num_of_rule, pgw_flow_t *flow);
 pgw_bearer_t *pgw_bearer_find_by_packet(ogs_pkbuf_t *pkt);
 
 #ifdef __cplusplus
@@ -20,8 +20,6 @@
 #include "pgw-context.h"
 #include "pgw-s5c-build.h"
 
-#include "ipfw/ipfw2.h"
-
 static int16_t pgw_pco_build(uint8_t *pco_buf, ogs_gtp_tlv_pco_t *tlv_pco);
 
 ogs_pkbuf_t *pgw_s5c_build_create_session_response(
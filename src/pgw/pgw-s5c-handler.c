@@ -23,8 +23,7 @@
 #include "pgw-fd-path.h"
 #include "pgw-s5c-build.h"
 #include "pgw-s5c-handler.h"
-
-#include "ipfw/ipfw2.h"
+#include "pgw-ipfw.h"
 
 void pgw_s5c_handle_create_session_request(
         pgw_sess_t *sess, ogs_gtp_xact_t *xact,
@@ -123,6 +122,7 @@ void pgw_s5c_handle_create_session_request(
     }
     /* Setup GTP Node */
     OGS_SETUP_GTP_NODE(bearer, sgw);
+    pgw_sess_publish(sess);
 
     decoded = ogs_gtp_parse_bearer_qos(&bearer_qos,
         &req->bearer_contexts_to_be_created.bearer_level_qos);
@@ -230,6 +230,9 @@ void pgw_s5c_handle_create_bearer_response(
     /* Set EBI */
     bearer->ebi = req->bearer_contexts.eps_bearer_id.u8;
 
+    /* Bearer is now available for downlink packet filtering */
+    pgw_compile_classifier(sess);
+
     /* Data Plane(DL) : SGW-S5U */
     sgw_s5u_teid = req->bearer_contexts.s5_s8_u_sgw_f_teid.data;
     bearer->sgw_s5u_teid = ntohl(sgw_s5u_teid->teid);
@@ -247,6 +250,7 @@ void pgw_s5c_handle_create_bearer_response(
     }
     /* Setup GTP Node */
     OGS_SETUP_GTP_NODE(bearer, sgw);
+    pgw_sess_publish(sess);
 
     rv = ogs_gtp_xact_commit(xact);
     ogs_expect(rv == OGS_OK);
@@ -318,6 +322,8 @@ void pgw_s5c_handle_delete_bearer_response(
             sess->sgw_s5c_teid, sess->pgw_s5c_teid);
 
     pgw_bearer_remove(bearer);
+
+    pgw_compile_classifier(sess);
 }
 
 static int reconfigure_packet_filter(pgw_pf_t *pf, ogs_gtp_tft_t *tft, int i)
@@ -353,7 +359,7 @@ static int reconfigure_packet_filter(pgw_pf_t *pf, ogs_gtp_tft_t *tft, int i)
             memcpy(pf->rule.ip.remote.addr,
                 tft->pf[i].component[j].ipv6_mask.addr,
                 sizeof(pf->rule.ip.remote.addr));
-            n2mask((struct in6_addr *)pf->rule.ip.remote.mask,
+            pgw_prefix_to_mask(pf->rule.ip.remote.mask,
                 tft->pf[i].component[j].ipv6.prefixlen);
             break;
         case GTP_PACKET_FILTER_IPV6_LOCAL_ADDRESS_TYPE:
@@ -370,7 +376,7 @@ static int reconfigure_packet_filter(pgw_pf_t *pf, ogs_gtp_tft_t *tft, int i)
             memcpy(pf->rule.ip.local.addr,
                 tft->pf[i].component[j].ipv6_mask.addr,
                 sizeof(pf->rule.ip.local.addr));
-            n2mask((struct in6_addr *)pf->rule.ip.local.mask,
+            pgw_prefix_to_mask(pf->rule.ip.local.mask,
                 tft->pf[i].component[j].ipv6.prefixlen);
             break;
         case GTP_PACKET_FILTER_SINGLE_LOCAL_PORT_TYPE:
@@ -532,6 +538,9 @@ void pgw_s5c_handle_bearer_resource_command(
         qos_presence = 1;
     }
 
+    if (tft_presence)
+        pgw_compile_classifier(sess);
+
     if (tft_presence == 0 && qos_presence == 0) {
         /* No modification */
         ogs_gtp_send_error_message(xact, sess ? sess->sgw_s5c_teid : 0,
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sgw-buffer.h"
+
+typedef struct sgw_buffer_s sgw_buffer_t;
+typedef struct sgw_buffer_link_s {
+    ogs_lnode_t     lnode;
+    sgw_buffer_t    *buffer;
+} sgw_buffer_link_t;
+
+struct sgw_buffer_s {
+    ogs_lnode_t     lnode;      /* A node of bearer->buffer_list */
+    sgw_buffer_link_t link;     /* A node of sgw_self()->buffer.list */
+    sgw_buffer_link_t ue_link;  /* A node of sgw_ue->buffer_list */
+
+    ogs_time_t      time;
+    size_t          size;
+    ogs_pkbuf_t     *pkbuf;
+    sgw_bearer_t    *bearer;
+};
+
+static OGS_POOL(sgw_buffer_pool, sgw_buffer_t);
+
+static void buffer_timeout(void *data);
+
+void sgw_buffer_init(void)
+{
+    ogs_pool_init(&sgw_buffer_pool, ogs_config()->pool.packet);
+    ogs_list_init(&sgw_self()->buffer.list);
+
+    sgw_self()->buffer.timer =
+        ogs_timer_add(sgw_self()->timer_mgr, buffer_timeout, NULL);
+    ogs_assert(sgw_self()->buffer.timer);
+}
+
+void sgw_buffer_final(void)
+{
+    ogs_info("[SGW] Buffered:%llu Flushed:%llu Dropped:%llu Expired:%llu",
+            (unsigned long long)sgw_self()->buffer.buffered,
+            (unsigned long long)sgw_self()->buffer.flushed,
+            (unsigned long long)sgw_self()->buffer.dropped,
+            (unsigned long long)sgw_self()->buffer.expired);
+
+    ogs_assert(ogs_list_empty(&sgw_self()->buffer.list));
+
+    ogs_timer_delete(sgw_self()->buffer.timer);
+    ogs_pool_final(&sgw_buffer_pool);
+}
+
+static void buffer_timer_start(void)
+{
+    sgw_buffer_link_t *link = NULL;
+    ogs_time_t now, expire;
+
+    link = ogs_list_first(&sgw_self()->buffer.list);
+    if (!link) {
+        ogs_timer_stop(sgw_self()->buffer.timer);
+        return;
+    }
+
+    now = ogs_get_monotonic_time();
+    expire = link->buffer->time + sgw_self()->buffer.max_age;
+
+    ogs_timer_start(sgw_self()->buffer.timer,
+            expire > now ? expire - now : 0);
+}
+
+static ogs_pkbuf_t *buffer_unlink(sgw_buffer_t *buffer)
+{
+    sgw_bearer_t *bearer = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    bool head;
+
+    ogs_assert(buffer);
+    bearer = buffer->bearer;
+    ogs_assert(bearer);
+    ogs_assert(bearer->sgw_ue);
+
+    head = (ogs_list_first(&sgw_self()->buffer.list) == &buffer->link);
+
+    ogs_list_remove(&bearer->buffer_list, buffer);
+    ogs_list_remove(&sgw_self()->buffer.list, &buffer->link);
+    ogs_list_remove(&bearer->sgw_ue->buffer_list, &buffer->ue_link);
+    bearer->num_buffered_pkt--;
+
+    sgw_self()->buffer.bytes -= buffer->size;
+    bearer->sgw_ue->buffered_bytes -= buffer->size;
+
+    pkbuf = buffer->pkbuf;
+    ogs_pool_free(&sgw_buffer_pool, buffer);
+
+    if (head)
+        buffer_timer_start();
+
+    return pkbuf;
+}
+
+static void buffer_drop(sgw_buffer_t *buffer)
+{
+    ogs_pkbuf_free(buffer_unlink(buffer));
+    sgw_self()->buffer.dropped++;
+}
+
+static void buffer_timeout(void *data)
+{
+    sgw_buffer_link_t *link = NULL;
+    ogs_time_t now;
+
+    now = ogs_get_monotonic_time();
+    while ((link = ogs_list_first(&sgw_self()->buffer.list))) {
+        if (link->buffer->time + sgw_self()->buffer.max_age > now)
+            break;
+
+        ogs_debug("[SGW] Expire buffered packet : EBI[%d]",
+                link->buffer->bearer->ebi);
+        ogs_pkbuf_free(buffer_unlink(link->buffer));
+        sgw_self()->buffer.expired++;
+    }
+
+    buffer_timer_start();
+}
+
+/* Do not pin a large cluster for a small packet */
+static ogs_pkbuf_t *buffer_compact(ogs_pkbuf_t *pkbuf)
+{
+    ogs_pkbuf_t *newbuf = NULL;
+
+    if (pkbuf->len * 2 > pkbuf->cluster->size)
+        return pkbuf;
+
+    newbuf = ogs_pkbuf_alloc(pkbuf->pool, pkbuf->len);
+    ogs_assert(newbuf);
+    ogs_pkbuf_put_data(newbuf, pkbuf->data, pkbuf->len);
+
+    ogs_pkbuf_free(pkbuf);
+
+    return newbuf;
+}
+
+void sgw_buffer_add(sgw_bearer_t *bearer, ogs_pkbuf_t *pkbuf)
+{
+    sgw_ue_t *sgw_ue = NULL;
+    sgw_buffer_t *buffer = NULL;
+    sgw_buffer_link_t *link = NULL;
+    size_t size;
+
+    ogs_assert(bearer);
+    sgw_ue = bearer->sgw_ue;
+    ogs_assert(sgw_ue);
+    ogs_assert(pkbuf);
+
+    pkbuf = buffer_compact(pkbuf);
+    size = pkbuf->cluster->size;
+
+    if (sgw_self()->buffer.policy == SGW_BUFFER_DROP_OLDEST) {
+        /* Oldest of the UE, whichever bearer it was buffered for */
+        while (sgw_ue->buffered_bytes + size >
+                sgw_self()->buffer.max_ue_bytes &&
+                (link = ogs_list_first(&sgw_ue->buffer_list)))
+            buffer_drop(link->buffer);
+
+        while ((sgw_self()->buffer.bytes + size >
+                    sgw_self()->buffer.max_bytes ||
+                    sgw_buffer_pool.avail == 0) &&
+                (link = ogs_list_first(&sgw_self()->buffer.list)))
+            buffer_drop(link->buffer);
+    }
+
+    if (sgw_ue->buffered_bytes + size > sgw_self()->buffer.max_ue_bytes ||
+        sgw_self()->buffer.bytes + size > sgw_self()->buffer.max_bytes) {
+        ogs_debug("[SGW] Drop buffered packet : EBI[%d] UE[%zu] ALL[%zu]",
+                bearer->ebi, sgw_ue->buffered_bytes, sgw_self()->buffer.bytes);
+        ogs_pkbuf_free(pkbuf);
+        sgw_self()->buffer.dropped++;
+        return;
+    }
+
+    ogs_pool_alloc(&sgw_buffer_pool, &buffer);
+    if (!buffer) {
+        ogs_pkbuf_free(pkbuf);
+        sgw_self()->buffer.dropped++;
+        return;
+    }
+    memset(buffer, 0, sizeof *buffer);
+
+    buffer->time = ogs_get_monotonic_time();
+    buffer->size = size;
+    buffer->pkbuf = pkbuf;
+    buffer->bearer = bearer;
+    buffer->link.buffer = buffer;
+    buffer->ue_link.buffer = buffer;
+
+    ogs_list_add(&bearer->buffer_list, buffer);
+    ogs_list_add(&sgw_self()->buffer.list, &buffer->link);
+    ogs_list_add(&sgw_ue->buffer_list, &buffer->ue_link);
+    bearer->num_buffered_pkt++;
+
+    sgw_self()->buffer.bytes += size;
+    sgw_ue->buffered_bytes += size;
+    sgw_self()->buffer.buffered++;
+
+    if (ogs_list_first(&sgw_self()->buffer.list) == &buffer->link)
+        buffer_timer_start();
+}
+
+ogs_pkbuf_t *sgw_buffer_pop(sgw_bearer_t *bearer)
+{
+    sgw_buffer_t *buffer = NULL;
+
+    ogs_assert(bearer);
+
+    buffer = ogs_list_first(&bearer->buffer_list);
+    if (!buffer)
+        return NULL;
+
+    sgw_self()->buffer.flushed++;
+
+    return buffer_unlink(buffer);
+}
+
+void sgw_buffer_clear(sgw_bearer_t *bearer)
+{
+    sgw_buffer_t *buffer = NULL;
+
+    ogs_assert(bearer);
+
+    while ((buffer = ogs_list_first(&bearer->buffer_list)))
+        buffer_drop(buffer);
+}
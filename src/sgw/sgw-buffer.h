@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SGW_BUFFER_H
+#define SGW_BUFFER_H
+
+#include "sgw-context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Downlink packets buffered while S1-U is inactive
+ *
+ * Every packet is charged at the size of its cluster against a global
+ * budget and against the UE. A packet over either limit is dropped
+ * according to the policy, and a packet older than max_age is expired.
+ */
+void sgw_buffer_init(void);
+void sgw_buffer_final(void);
+
+void sgw_buffer_add(sgw_bearer_t *bearer, ogs_pkbuf_t *pkbuf);
+ogs_pkbuf_t *sgw_buffer_pop(sgw_bearer_t *bearer);
+void sgw_buffer_clear(sgw_bearer_t *bearer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGW_BUFFER_H */
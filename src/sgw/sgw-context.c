@@ -20,6 +20,7 @@
 #include <yaml.h>
 
 #include "sgw-context.h"
+#include "sgw-buffer.h"
 
 static sgw_context_t self;
 
@@ -57,7 +58,7 @@ void sgw_context_init(void)
     ogs_pool_init(&sgw_bearer_pool, ogs_config()->pool.bearer);
     ogs_pool_init(&sgw_tunnel_pool, ogs_config()->pool.tunnel);
 
-    self.imsi_ue_hash = ogs_hash_make();
+    self.imsi_ue_hash = ogs_hash_make_size(ogs_config()->pool.ue);
 
     ogs_list_init(&self.sgw_ue_list);
 
@@ -97,6 +98,12 @@ static int sgw_context_prepare(void)
     self.gtpc_port = OGS_GTPV2_C_UDP_PORT;
     self.gtpu_port = OGS_GTPV1_U_UDP_PORT;
 
+    /* Half of the 2048 clusters in the packet pool */
+    self.buffer.policy = SGW_BUFFER_DROP_OLDEST;
+    self.buffer.max_bytes = (size_t)ogs_config()->pool.packet * 1024;
+    self.buffer.max_ue_bytes = 1024 * 1024;
+    self.buffer.max_age = ogs_time_from_sec(10);
+
     return OGS_OK;
 }
 
@@ -383,6 +390,32 @@ int sgw_context_parse_config(void)
                                 NULL, self.gtpu_port);
                         ogs_assert(rv == OGS_OK);
                     }
+                } else if (!strcmp(sgw_key, "buffer")) {
+                    ogs_yaml_iter_t buffer_iter;
+                    ogs_yaml_iter_recurse(&sgw_iter, &buffer_iter);
+                    while (ogs_yaml_iter_next(&buffer_iter)) {
+                        const char *buffer_key =
+                            ogs_yaml_iter_key(&buffer_iter);
+                        const char *v = ogs_yaml_iter_value(&buffer_iter);
+                        ogs_assert(buffer_key);
+                        if (!strcmp(buffer_key, "max")) {
+                            if (v) self.buffer.max_bytes = (size_t)atoi(v) * 1024;
+                        } else if (!strcmp(buffer_key, "ue")) {
+                            if (v) self.buffer.max_ue_bytes =
+                                (size_t)atoi(v) * 1024;
+                        } else if (!strcmp(buffer_key, "age")) {
+                            if (v) self.buffer.max_age =
+                                ogs_time_from_msec(atoi(v));
+                        } else if (!strcmp(buffer_key, "policy")) {
+                            if (v && !strcmp(v, "drop_oldest"))
+                                self.buffer.policy = SGW_BUFFER_DROP_OLDEST;
+                            else if (v && !strcmp(v, "drop_newest"))
+                                self.buffer.policy = SGW_BUFFER_DROP_NEWEST;
+                            else
+                                ogs_warn("unknown policy `%s`", v);
+                        } else
+                            ogs_warn("unknown key `%s`", buffer_key);
+                    }
                 }
                 else
                     ogs_warn("unknown key `%s`", sgw_key);
@@ -462,6 +495,7 @@ sgw_ue_t *sgw_ue_add(uint8_t *imsi, int imsi_len)
     ogs_buffer_to_bcd(sgw_ue->imsi, sgw_ue->imsi_len, sgw_ue->imsi_bcd);
 
     ogs_list_init(&sgw_ue->sess_list);
+    ogs_list_init(&sgw_ue->buffer_list);
 
     ogs_hash_set(self.imsi_ue_hash, sgw_ue->imsi, sgw_ue->imsi_len, sgw_ue);
 
@@ -634,6 +668,7 @@ sgw_bearer_t* sgw_bearer_add(sgw_sess_t *sess)
     bearer->sess = sess;
 
     ogs_list_init(&bearer->tunnel_list);
+    ogs_list_init(&bearer->buffer_list);
 
     tunnel = sgw_tunnel_add(bearer, OGS_GTP_F_TEID_S1_U_SGW_GTP_U);
     ogs_assert(tunnel);
@@ -648,8 +683,6 @@ sgw_bearer_t* sgw_bearer_add(sgw_sess_t *sess)
 
 int sgw_bearer_remove(sgw_bearer_t *bearer)
 {
-    int i;
-
     ogs_assert(bearer);
     ogs_assert(bearer->sess);
 
@@ -658,8 +691,7 @@ int sgw_bearer_remove(sgw_bearer_t *bearer)
     sgw_tunnel_remove_all(bearer);
 
     /* Free the buffered packets */
-    for (i = 0; i < bearer->num_buffered_pkt; i++)
-        ogs_pkbuf_free(bearer->buffered_pkts[i]);
+    sgw_buffer_clear(bearer);
 
     ogs_pool_free(&sgw_bearer_pool, bearer);
 
@@ -732,6 +764,58 @@ sgw_bearer_t *sgw_bearer_next(sgw_bearer_t *bearer)
     return ogs_list_next(bearer);
 }
 
+static void tunnel_publish(sgw_tunnel_t *tunnel)
+{
+    sgw_bearer_t *bearer = NULL;
+    sgw_tunnel_t *egress = NULL;
+    ogs_gtp_fwd_t fwd;
+
+    ogs_assert(tunnel);
+    bearer = tunnel->bearer;
+    ogs_assert(bearer);
+
+    if (tunnel->interface_type == OGS_GTP_F_TEID_S1_U_SGW_GTP_U) {
+        egress = sgw_s5u_tunnel_in_bearer(bearer);
+    } else if (tunnel->interface_type ==
+                OGS_GTP_F_TEID_SGW_GTP_U_FOR_DL_DATA_FORWARDING ||
+            tunnel->interface_type ==
+                OGS_GTP_F_TEID_SGW_GTP_U_FOR_UL_DATA_FORWARDING) {
+        egress = sgw_tunnel_find_by_interface_type(
+                bearer, tunnel->interface_type);
+    } else if (tunnel->interface_type == OGS_GTP_F_TEID_S5_S8_SGW_GTP_U) {
+        /* Buffering and Downlink Data Notification stay on this thread */
+        if (bearer->num_buffered_pkt == 0)
+            egress = sgw_s1u_tunnel_in_bearer(bearer);
+    }
+
+    memset(&fwd, 0, sizeof fwd);
+    if (egress && egress->remote_teid &&
+        egress->gnode && egress->gnode->sock) {
+        fwd.action = OGS_GTP_FWD_GTPU;
+        fwd.remote_teid = egress->remote_teid;
+        memcpy(&fwd.remote_addr,
+                &egress->gnode->remote_addr, sizeof fwd.remote_addr);
+        fwd.fd = egress->gnode->sock->fd;
+    } else {
+        fwd.action = OGS_GTP_FWD_PUNT;
+    }
+
+    ogs_gtp_fwd_update(self.fwd_table, tunnel->local_teid, &fwd);
+}
+
+void sgw_bearer_publish(sgw_bearer_t *bearer)
+{
+    sgw_tunnel_t *tunnel = NULL;
+
+    ogs_assert(bearer);
+
+    if (!self.fwd_table)
+        return;
+
+    ogs_list_for_each(&bearer->tunnel_list, tunnel)
+        tunnel_publish(tunnel);
+}
+
 sgw_tunnel_t *sgw_tunnel_add(sgw_bearer_t *bearer, uint8_t interface_type)
 {
     sgw_tunnel_t *tunnel = NULL;
@@ -751,17 +835,28 @@ sgw_tunnel_t *sgw_tunnel_add(sgw_bearer_t *bearer, uint8_t interface_type)
 
     ogs_list_add(&bearer->tunnel_list, tunnel);
 
+    if (self.fwd_table)
+        tunnel_publish(tunnel);
+
     return tunnel;
 }
 
 int sgw_tunnel_remove(sgw_tunnel_t *tunnel)
 {
+    sgw_bearer_t *bearer = NULL;
+
     ogs_assert(tunnel);
-    ogs_assert(tunnel->bearer);
+    bearer = tunnel->bearer;
+    ogs_assert(bearer);
+
+    if (self.fwd_table)
+        ogs_gtp_fwd_remove(self.fwd_table, tunnel->local_teid);
 
-    ogs_list_remove(&tunnel->bearer->tunnel_list, tunnel);
+    ogs_list_remove(&bearer->tunnel_list, tunnel);
     ogs_pool_free(&sgw_tunnel_pool, tunnel);
 
+    sgw_bearer_publish(bearer);
+
     return OGS_OK;
 }
 
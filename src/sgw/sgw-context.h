@@ -56,6 +56,29 @@ typedef struct sgw_context_s {
     ogs_timer_mgr_t *timer_mgr;     /* Timer Manager */
     ogs_pollset_t   *pollset;       /* Poll Set for I/O Multiplexing */
 
+    ogs_gtp_fwd_table_t *fwd_table; /* GTP-U Forwarding by Local TEID */
+
+    /* Downlink buffering while S1-U is inactive */
+    struct {
+#define SGW_BUFFER_DROP_OLDEST      0
+#define SGW_BUFFER_DROP_NEWEST      1
+        int         policy;
+        size_t      max_bytes;      /* Budget for all UEs */
+        size_t      max_ue_bytes;   /* Budget for each UE */
+        ogs_time_t  max_age;
+
+        size_t      bytes;
+        ogs_list_t  list;           /* All buffered packets, oldest first */
+        ogs_timer_t *timer;         /* Expires the oldest packet */
+
+        uint64_t    buffered;
+        uint64_t    flushed;
+        uint64_t    dropped;
+        uint64_t    expired;
+    } buffer;
+
+    uint64_t        gtpu_dropped;   /* GTP-U for a tunnel already removed */
+
     ogs_list_t      mme_s11_list;   /* MME GTPC Node List */
     ogs_list_t      pgw_s5c_list;   /* PGW GTPC Node List */
     ogs_list_t      enb_s1u_list;   /* eNB GTPU Node List */
@@ -86,6 +109,9 @@ typedef struct sgw_ue_s {
 
     uint32_t        state;
 
+    size_t          buffered_bytes;
+    ogs_list_t      buffer_list;    /* Buffered packets of all bearers */
+
     ogs_list_t      sess_list;
 
     ogs_gtp_node_t  *gnode;
@@ -125,9 +151,7 @@ typedef struct sgw_bearer_s {
 
     /* Pkts which will be buffered in case of UE-IDLE */
     uint32_t        num_buffered_pkt;
-
-#define MAX_NUM_OF_PACKET_BUFFER      512 
-    ogs_pkbuf_t*    buffered_pkts[MAX_NUM_OF_PACKET_BUFFER];
+    ogs_list_t      buffer_list;
 
     ogs_list_t      tunnel_list;
     sgw_sess_t      *sess;
@@ -183,6 +207,7 @@ sgw_bearer_t *sgw_bearer_find_by_ue_ebi(
 sgw_bearer_t *sgw_default_bearer_in_sess(sgw_sess_t *sess);
 sgw_bearer_t *sgw_bearer_first(sgw_sess_t *sess);
 sgw_bearer_t *sgw_bearer_next(sgw_bearer_t *bearer);
+void sgw_bearer_publish(sgw_bearer_t *bearer);
 
 sgw_tunnel_t *sgw_tunnel_add(
         sgw_bearer_t *bearer, uint8_t interface_type);
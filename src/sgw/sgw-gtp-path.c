@@ -20,8 +20,21 @@
 #include "sgw-context.h"
 #include "sgw-event.h"
 #include "sgw-gtp-path.h"
+#include "sgw-buffer.h"
 
 static ogs_pkbuf_pool_t *packet_pool = NULL;
+static ogs_gtp_batch_t packet_batch;
+
+static ogs_gtp_worker_t worker[OGS_MAX_NUM_OF_GTPU_WORKER];
+static int num_of_worker = 0;
+
+/* Packets handed over from the workers to the SGW thread */
+typedef struct punt_s {
+    ogs_socket_t fd;
+    ogs_sockaddr_t from;
+    ogs_pkbuf_t *pkbuf;
+} punt_t;
+static ogs_queue_t *punt_queue = NULL;
 
 static void _gtpv2_c_recv_cb(short when, ogs_socket_t fd, void *data)
 {
@@ -104,116 +117,104 @@ static void _gtpv2_c_recv_cb(short when, ogs_socket_t fd, void *data)
     }
 }
 
-static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+static void gtpv1_u_echo(
+        ogs_socket_t fd, ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
 {
     char buf[OGS_ADDRSTRLEN];
-    int rv;
-    ssize_t size;
-    ogs_pkbuf_t *pkbuf = NULL;
-    ogs_sockaddr_t from;
-    ogs_gtp_header_t *gtp_h = NULL;
-    sgw_bearer_t *bearer = NULL;
-    sgw_tunnel_t *tunnel = NULL;
-    uint32_t teid;
-    int i;
+    ogs_pkbuf_t *echo_rsp;
 
-    ogs_assert(fd != INVALID_SOCKET);
-    ogs_assert(packet_pool);
+    ogs_debug("[SGW] RECV Echo Request from [%s]", OGS_ADDR(from, buf));
+    echo_rsp = ogs_gtp_handle_echo_req(pkbuf);
+    if (echo_rsp) {
+        ssize_t sent;
 
-    pkbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_SDU_LEN);
-    ogs_pkbuf_put(pkbuf, OGS_MAX_SDU_LEN);
+        /* Echo reply */
+        ogs_debug("[SGW] SEND Echo Response to [%s]", OGS_ADDR(from, buf));
 
-    size = ogs_recvfrom(fd, pkbuf->data, pkbuf->len, 0, &from);
-    if (size <= 0) {
-        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
-                "ogs_recvfrom() failed");
-        ogs_pkbuf_free(pkbuf);
-        return;
+        sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, from);
+        if (sent < 0 || sent != echo_rsp->len) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                    "ogs_sendto() failed");
+        }
+        ogs_pkbuf_free(echo_rsp);
     }
+}
 
-    ogs_pkbuf_trim(pkbuf, size);
+static void gtpv1_u_handle(
+        ogs_socket_t fd, ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
+{
+    char buf[OGS_ADDRSTRLEN];
+    int rv;
+    ogs_gtp_header_t *gtp_h = NULL;
+    ogs_gtp_fwd_t *fwd = NULL;
+    sgw_bearer_t *bearer = NULL;
+    sgw_tunnel_t *tunnel = NULL;
+    ogs_pkbuf_t *buffered = NULL;
+    uint32_t teid;
 
     gtp_h = (ogs_gtp_header_t *)pkbuf->data;
     if (gtp_h->type == OGS_GTPU_MSGTYPE_ECHO_REQ) {
-        ogs_pkbuf_t *echo_rsp;
-
-        ogs_debug("[SGW] RECV Echo Request from [%s]",
-                OGS_ADDR(&from, buf));
-        echo_rsp = ogs_gtp_handle_echo_req(pkbuf);
-        if (echo_rsp) {
-            ssize_t sent;
-
-            /* Echo reply */
-            ogs_debug("[SGW] SEND Echo Response to [%s]",
-                    OGS_ADDR(&from, buf));
-
-            sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, &from);
-            if (sent < 0 || sent != echo_rsp->len) {
-                ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
-                        "ogs_sendto() failed");
-            }
-            ogs_pkbuf_free(echo_rsp);
-        }
+        gtpv1_u_echo(fd, pkbuf, from);
     } else if (gtp_h->type == OGS_GTPU_MSGTYPE_GPDU || 
                 gtp_h->type == OGS_GTPU_MSGTYPE_END_MARKER) {
         teid = ntohl(gtp_h->teid);
         if (gtp_h->type == OGS_GTPU_MSGTYPE_GPDU)
             ogs_debug("[SGW] RECV GPU-U from [%s] : TEID[0x%x]",
-                    OGS_ADDR(&from, buf), teid);
+                    OGS_ADDR(from, buf), teid);
         else if (gtp_h->type == OGS_GTPU_MSGTYPE_END_MARKER)
             ogs_debug("[SGW] RECV End Marker from [%s] : TEID[0x%x]",
-                    OGS_ADDR(&from, buf), teid);
+                    OGS_ADDR(from, buf), teid);
 
-        tunnel = sgw_tunnel_find_by_teid(teid);
-        if (!tunnel) {
+        fwd = ogs_gtp_fwd_find(sgw_self()->fwd_table, teid);
+        if (!fwd) {
             if (gtp_h->type == OGS_GTPU_MSGTYPE_GPDU)
-                ogs_warn("[SGW] RECV GPU-U from [%s] : No TEID[0x%x]",
-                        OGS_ADDR(&from, buf), teid);
+                ogs_warn_ratelimited(
+                        "[SGW] RECV GPU-U from [%s] : No TEID[0x%x]",
+                        OGS_ADDR(from, buf), teid);
             else if (gtp_h->type == OGS_GTPU_MSGTYPE_END_MARKER)
-                ogs_warn("[SGW] RECV End Marker from [%s] : No TEID[0x%x]",
-                        OGS_ADDR(&from, buf), teid);
+                ogs_warn_ratelimited(
+                        "[SGW] RECV End Marker from [%s] : No TEID[0x%x]",
+                        OGS_ADDR(from, buf), teid);
+            ogs_pkbuf_free(pkbuf);
+            return;
+        }
+
+        /* Convert TEID */
+        if (fwd->action == OGS_GTP_FWD_GTPU) {
+            ogs_debug("[SGW] SEND GPU-U to [%s]: TEID[0x%x]",
+                OGS_ADDR(&fwd->remote_addr, buf), fwd->remote_teid);
+
+            gtp_h->teid = htonl(fwd->remote_teid);
+            ogs_gtp_batch_add(&packet_batch,
+                    fwd->fd, &fwd->remote_addr, pkbuf);
+            return;
+        }
+
+        /* The tunnel may be gone before a punted packet is handled */
+        tunnel = sgw_tunnel_find_by_teid(teid);
+        if (!tunnel) {
+            sgw_self()->gtpu_dropped++;
+            ogs_warn_ratelimited("[SGW] No tunnel for TEID[0x%x] "
+                    "(%llu dropped)", teid,
+                    (unsigned long long)sgw_self()->gtpu_dropped);
             ogs_pkbuf_free(pkbuf);
             return;
         }
         bearer = tunnel->bearer;
         ogs_assert(bearer);
 
-        /* Convert TEID */
-        if (tunnel->interface_type == OGS_GTP_F_TEID_S1_U_SGW_GTP_U) {
-            sgw_tunnel_t *s5u_tunnel = NULL;
-
-            s5u_tunnel = sgw_s5u_tunnel_in_bearer(bearer);
-            ogs_assert(s5u_tunnel);
-            ogs_assert(s5u_tunnel->gnode);
-            ogs_assert(s5u_tunnel->gnode->sock);
-            ogs_debug("[SGW] SEND GPU-U to PGW[%s]: TEID[0x%x]",
-                OGS_ADDR(&s5u_tunnel->gnode->remote_addr, buf),
-                s5u_tunnel->remote_teid);
-
-            gtp_h->teid = htonl(s5u_tunnel->remote_teid);
-            ogs_gtp_sendto(s5u_tunnel->gnode, pkbuf);
-        } else if (tunnel->interface_type ==
-                    OGS_GTP_F_TEID_SGW_GTP_U_FOR_DL_DATA_FORWARDING ||
-                tunnel->interface_type ==
-                    OGS_GTP_F_TEID_SGW_GTP_U_FOR_UL_DATA_FORWARDING) {
-            sgw_tunnel_t *indirect_tunnel = NULL;
-
-            indirect_tunnel = sgw_tunnel_find_by_interface_type(bearer,
-                    tunnel->interface_type);
-            ogs_assert(indirect_tunnel);
-            ogs_assert(indirect_tunnel->gnode);
-            ogs_assert(indirect_tunnel->gnode->sock);
-            ogs_debug("[SGW] SEND GPU-U to Indirect Tunnel[%s]: TEID[0x%x]",
-                OGS_ADDR(&indirect_tunnel->gnode->remote_addr, buf),
-                indirect_tunnel->remote_teid);
-
-            gtp_h->teid = htonl(indirect_tunnel->remote_teid);
-            ogs_gtp_sendto(indirect_tunnel->gnode, pkbuf);
-        } else if (tunnel->interface_type == OGS_GTP_F_TEID_S5_S8_SGW_GTP_U) {
+        if (tunnel->interface_type == OGS_GTP_F_TEID_S5_S8_SGW_GTP_U) {
             sgw_tunnel_t *s1u_tunnel = NULL;
 
             s1u_tunnel = sgw_s1u_tunnel_in_bearer(bearer);
-            ogs_assert(s1u_tunnel);
+            if (!s1u_tunnel) {
+                sgw_self()->gtpu_dropped++;
+                ogs_warn_ratelimited("[SGW] No S1-U tunnel for TEID[0x%x] "
+                        "(%llu dropped)", teid,
+                        (unsigned long long)sgw_self()->gtpu_dropped);
+                ogs_pkbuf_free(pkbuf);
+                return;
+            }
 
             if (s1u_tunnel->remote_teid) {
                 ogs_assert(s1u_tunnel->gnode);
@@ -223,19 +224,26 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                     s1u_tunnel->remote_teid);
 
                 /* If there is buffered packet, send it first */
-                for (i = 0; i < bearer->num_buffered_pkt; i++) {
+                while ((buffered = sgw_buffer_pop(bearer))) {
                     ogs_gtp_header_t *gtp_h = NULL;
 
-                    gtp_h = (ogs_gtp_header_t *)bearer->buffered_pkts[i]->data;
+                    gtp_h = (ogs_gtp_header_t *)buffered->data;
                     gtp_h->teid = htonl(s1u_tunnel->remote_teid);
 
-                    ogs_gtp_sendto(s1u_tunnel->gnode, bearer->buffered_pkts[i]);
-                    ogs_pkbuf_free(bearer->buffered_pkts[i]);
+                    ogs_gtp_batch_sendto(&packet_batch,
+                            s1u_tunnel->gnode, buffered);
                 }
-                bearer->num_buffered_pkt = 0;
 
                 gtp_h->teid = htonl(s1u_tunnel->remote_teid);
-                ogs_gtp_sendto(s1u_tunnel->gnode, pkbuf);
+                ogs_gtp_batch_sendto(&packet_batch, s1u_tunnel->gnode, pkbuf);
+
+                /*
+                 * Nothing left to buffer, forward it directly from now on.
+                 * Queued datagrams still point to the entries replaced here.
+                 */
+                ogs_gtp_batch_flush(&packet_batch);
+                sgw_bearer_publish(bearer);
+                return;
             } else {
                 /* S1U path is deactivated.
                  * Send downlink_data_notification to MME.
@@ -269,11 +277,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                     }
 
                     /* Buffer the packet */
-                    if (bearer->num_buffered_pkt < MAX_NUM_OF_PACKET_BUFFER) {
-                        bearer->buffered_pkts[bearer->num_buffered_pkt++] = 
-                            pkbuf;
-                        return;
-                    }
+                    sgw_buffer_add(bearer, pkbuf);
+                    return;
                 } else {
                     /* UE is S1U_ACTIVE state but there is no s1u teid */
                     ogs_debug("[SGW] UE is ACITVE but there is no matched "
@@ -282,6 +287,10 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                     /* Just drop it */
                 }
             }
+        } else {
+            ogs_warn_ratelimited(
+                    "[SGW] No egress tunnel for TEID[0x%x] Type[%d]",
+                    teid, tunnel->interface_type);
         }
     }
 
@@ -289,17 +298,127 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     return;
 }
 
+static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    int i, n;
+
+    ogs_assert(fd != INVALID_SOCKET);
+
+    n = ogs_gtp_batch_recv(&packet_batch, fd);
+    for (i = 0; i < n; i++)
+        gtpv1_u_handle(fd,
+                packet_batch.recvbuf[i], &packet_batch.from[i]);
+
+    ogs_gtp_batch_flush(&packet_batch);
+}
+
+static void punt(ogs_socket_t fd, ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
+{
+    punt_t *p = NULL;
+    int rv;
+
+    p = ogs_calloc(1, sizeof *p);
+    ogs_assert(p);
+
+    p->fd = fd;
+    memcpy(&p->from, from, sizeof p->from);
+    p->pkbuf = ogs_pkbuf_alloc(packet_pool, pkbuf->len);
+    ogs_pkbuf_put_data(p->pkbuf, pkbuf->data, pkbuf->len);
+
+    rv = ogs_queue_trypush(punt_queue, p);
+    if (rv != OGS_OK) {
+        ogs_warn_ratelimited("[SGW] Punt queue full, drop GTP-U");
+        ogs_pkbuf_free(p->pkbuf);
+        ogs_free(p);
+        return;
+    }
+
+    ogs_pollset_notify(sgw_self()->pollset);
+}
+
+static void worker_handler(ogs_gtp_worker_t *worker, ogs_socket_t fd)
+{
+    char buf[OGS_ADDRSTRLEN];
+    ogs_gtp_batch_t *batch = &worker->batch;
+    ogs_gtp_header_t *gtp_h = NULL;
+    ogs_gtp_fwd_t *fwd = NULL;
+    ogs_sock_t *sock = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    uint32_t teid;
+    int i, n;
+
+    n = ogs_gtp_batch_recv(batch, fd);
+    for (i = 0; i < n; i++) {
+        pkbuf = batch->recvbuf[i];
+        gtp_h = (ogs_gtp_header_t *)pkbuf->data;
+
+        if (gtp_h->type == OGS_GTPU_MSGTYPE_ECHO_REQ) {
+            gtpv1_u_echo(fd, pkbuf, &batch->from[i]);
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        if (gtp_h->type != OGS_GTPU_MSGTYPE_GPDU &&
+            gtp_h->type != OGS_GTPU_MSGTYPE_END_MARKER) {
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        teid = ntohl(gtp_h->teid);
+        fwd = ogs_gtp_fwd_find(worker->table, teid);
+        if (!fwd) {
+            ogs_warn_ratelimited("[SGW] RECV GTP-U from [%s] : No TEID[0x%x]",
+                    OGS_ADDR(&batch->from[i], buf), teid);
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        if (fwd->action == OGS_GTP_FWD_GTPU) {
+            sock = ogs_gtp_worker_sock(worker, fwd->remote_addr.ogs_sa_family);
+            if (sock) {
+                gtp_h->teid = htonl(fwd->remote_teid);
+                ogs_gtp_batch_add(batch, sock->fd, &fwd->remote_addr, pkbuf);
+                continue;
+            }
+        }
+
+        /* Buffering and Downlink Data Notification need the SGW context */
+        punt(fd, pkbuf, &batch->from[i]);
+        ogs_pkbuf_free(pkbuf);
+    }
+
+    ogs_gtp_batch_flush(batch);
+}
+
+void sgw_gtp_handle_punted(void)
+{
+    punt_t *p = NULL;
+
+    if (!punt_queue)
+        return;
+
+    while (ogs_queue_trypop(punt_queue, (void **)&p) == OGS_OK) {
+        ogs_assert(p);
+        gtpv1_u_handle(p->fd, p->pkbuf, &p->from);
+        ogs_free(p);
+    }
+
+    ogs_gtp_batch_flush(&packet_batch);
+}
+
 int sgw_gtp_open(void)
 {
     ogs_socknode_t *node = NULL;
     ogs_sock_t *sock = NULL;
 
     ogs_pkbuf_config_t config;
-    memset(&config, 0, sizeof config);
 
-    config.cluster_8192_pool = ogs_config()->pool.packet;
+    ogs_pkbuf_packet_init(&config, ogs_config()->pool.packet);
+    config.cluster_8192_pool += ogs_config()->parameter.gtpu_batch;
 
     packet_pool = ogs_pkbuf_pool_create(&config);
+    ogs_gtp_batch_init(&packet_batch,
+            packet_pool, ogs_config()->parameter.gtpu_batch);
 
     ogs_list_for_each(&sgw_self()->gtpc_list, node) {
         sock = ogs_gtp_server(node);
@@ -326,26 +445,59 @@ int sgw_gtp_open(void)
 
     ogs_assert(sgw_self()->gtpc_addr || sgw_self()->gtpc_addr6);
 
-    ogs_list_for_each(&sgw_self()->gtpu_list, node) {
-        sock = ogs_gtp_server(node);
-        ogs_assert(sock);
-
-        node->poll = ogs_pollset_add(sgw_self()->pollset,
-                OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+    num_of_worker = ogs_config()->parameter.gtpu_worker;
+    if (num_of_worker > OGS_MAX_NUM_OF_GTPU_WORKER) {
+        ogs_warn("Too many GTP-U workers [%d > %d]",
+                num_of_worker, OGS_MAX_NUM_OF_GTPU_WORKER);
+        num_of_worker = OGS_MAX_NUM_OF_GTPU_WORKER;
     }
-    ogs_list_for_each(&sgw_self()->gtpu_list6, node) {
-        sock = ogs_gtp_server(node);
-        ogs_assert(sock);
 
-        node->poll = ogs_pollset_add(sgw_self()->pollset,
-                OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+    sgw_self()->fwd_table =
+        ogs_gtp_fwd_table_create(ogs_config()->pool.tunnel);
+    ogs_assert(sgw_self()->fwd_table);
+
+    if (num_of_worker) {
+        int rv;
+
+        punt_queue = ogs_queue_create(ogs_config()->pool.packet);
+        ogs_assert(punt_queue);
+
+        rv = ogs_gtp_worker_init(worker, num_of_worker,
+                &sgw_self()->gtpu_list, &sgw_self()->gtpu_list6,
+                worker_handler, sgw_self()->fwd_table,
+                ogs_config()->parameter.gtpu_batch,
+                ogs_config()->pool.packet, NULL);
+        if (rv != OGS_OK) return rv;
+        rv = ogs_gtp_worker_run(worker, num_of_worker);
+        if (rv != OGS_OK) return rv;
+
+        /* Control messages are sent through the first worker's sockets */
+        sgw_self()->gtpu_sock = worker[0].gtpu_sock;
+        sgw_self()->gtpu_sock6 = worker[0].gtpu_sock6;
+    } else {
+        ogs_list_for_each(&sgw_self()->gtpu_list, node) {
+            sock = ogs_gtp_server(node);
+            ogs_assert(sock);
+
+            node->poll = ogs_pollset_add(sgw_self()->pollset,
+                    OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+        }
+        ogs_list_for_each(&sgw_self()->gtpu_list6, node) {
+            sock = ogs_gtp_server(node);
+            ogs_assert(sock);
+
+            node->poll = ogs_pollset_add(sgw_self()->pollset,
+                    OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+        }
+
+        sgw_self()->gtpu_sock =
+            ogs_socknode_sock_first(&sgw_self()->gtpu_list);
+        sgw_self()->gtpu_sock6 =
+            ogs_socknode_sock_first(&sgw_self()->gtpu_list6);
     }
 
-    sgw_self()->gtpu_sock = ogs_socknode_sock_first(&sgw_self()->gtpu_list);
     if (sgw_self()->gtpu_sock)
         sgw_self()->gtpu_addr = &sgw_self()->gtpu_sock->local_addr;
-
-    sgw_self()->gtpu_sock6 = ogs_socknode_sock_first(&sgw_self()->gtpu_list6);
     if (sgw_self()->gtpu_sock6)
         sgw_self()->gtpu_addr6 = &sgw_self()->gtpu_sock6->local_addr;
 
@@ -361,6 +513,24 @@ void sgw_gtp_close(void)
     ogs_socknode_remove_all(&sgw_self()->gtpu_list);
     ogs_socknode_remove_all(&sgw_self()->gtpu_list6);
 
+    if (num_of_worker) {
+        punt_t *p = NULL;
+
+        ogs_gtp_worker_stop(worker, num_of_worker);
+        num_of_worker = 0;
+
+        while (ogs_queue_trypop(punt_queue, (void **)&p) == OGS_OK) {
+            ogs_pkbuf_free(p->pkbuf);
+            ogs_free(p);
+        }
+        ogs_queue_destroy(punt_queue);
+        punt_queue = NULL;
+    }
+
+    ogs_gtp_fwd_table_destroy(sgw_self()->fwd_table);
+    sgw_self()->fwd_table = NULL;
+
+    ogs_gtp_batch_final(&packet_batch);
     ogs_pkbuf_pool_destroy(packet_pool);
 }
 
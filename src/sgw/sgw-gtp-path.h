@@ -26,6 +26,7 @@ extern "C" {
 
 int sgw_gtp_open(void);
 void sgw_gtp_close(void);
+void sgw_gtp_handle_punted(void);
 
 void sgw_gtp_send_end_marker(sgw_tunnel_t *s1u_tunnel);
 
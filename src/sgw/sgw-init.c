@@ -20,6 +20,8 @@
 #include "sgw-context.h"
 #include "sgw-sm.h"
 #include "sgw-event.h"
+#include "sgw-gtp-path.h"
+#include "sgw-buffer.h"
 
 static ogs_thread_t *thread;
 static void sgw_main(void *data);
@@ -33,12 +35,15 @@ int sgw_initialize()
     sgw_context_init();
     sgw_event_init();
 
-    rv = ogs_gtp_xact_init(sgw_self()->timer_mgr, 512);
+    rv = ogs_gtp_xact_init(
+            sgw_self()->timer_mgr, ogs_config()->pool.xact);
     if (rv != OGS_OK) return rv;
 
     rv = sgw_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    sgw_buffer_init();
+
     rv = ogs_log_config_domain(
             ogs_config()->logger.domain, ogs_config()->logger.level);
     if (rv != OGS_OK) return rv;
@@ -60,6 +65,7 @@ void sgw_terminate(void)
     ogs_thread_destroy(thread);
 
     sgw_context_final();
+    sgw_buffer_final();
 
     ogs_gtp_xact_final();
 
@@ -78,6 +84,9 @@ static void sgw_main(void *data)
         ogs_pollset_poll(sgw_self()->pollset,
                 ogs_timer_mgr_next(sgw_self()->timer_mgr));
 
+        /* GTP-U packets the workers could not forward on their own */
+        sgw_gtp_handle_punted();
+
         /* Process the MESSAGE FIRST.
          *
          * For example, if UE Context Release Complete is received,
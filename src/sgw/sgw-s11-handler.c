@@ -198,7 +198,14 @@ void sgw_s11_handle_create_session_request(ogs_gtp_xact_t *s11_xact,
 
     s5c_xact = ogs_gtp_xact_local_create(
             sess->gnode, &message->h, pkbuf, timeout, sess);
-    ogs_expect_or_return(s5c_xact);
+    if (!s5c_xact) {
+        /* The relay failed, so answer the MME on its own xact */
+        sgw_sess_remove(sess);
+        ogs_gtp_send_error_message(s11_xact, sgw_ue->mme_s11_teid,
+                OGS_GTP_CREATE_SESSION_RESPONSE_TYPE,
+                OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+        return;
+    }
 
     ogs_gtp_xact_associate(s11_xact, s5c_xact);
 
@@ -354,6 +361,7 @@ void sgw_s11_handle_modify_bearer_request(ogs_gtp_xact_t *s11_xact,
 
     /* Setup GTP Node */
     OGS_SETUP_GTP_NODE(s1u_tunnel, enb);
+    sgw_bearer_publish(bearer);
 
     /* Reset UE state */
     SGW_RESET_UE_STATE(sgw_ue, SGW_S1U_INACTIVE);
@@ -420,7 +428,12 @@ void sgw_s11_handle_delete_session_request(ogs_gtp_xact_t *s11_xact,
 
     s5c_xact = ogs_gtp_xact_local_create(
             sess->gnode, &message->h, pkbuf, timeout, sess);
-    ogs_expect_or_return(s5c_xact);
+    if (!s5c_xact) {
+        ogs_gtp_send_error_message(s11_xact, sgw_ue->mme_s11_teid,
+                OGS_GTP_DELETE_SESSION_RESPONSE_TYPE,
+                OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+        return;
+    }
 
     ogs_gtp_xact_associate(s11_xact, s5c_xact);
 
@@ -562,6 +575,7 @@ void sgw_s11_handle_create_bearer_response(ogs_gtp_xact_t *s11_xact,
     }
     /* Setup GTP Node */
     OGS_SETUP_GTP_NODE(s1u_tunnel, enb);
+    sgw_bearer_publish(bearer);
 
     /* Remove S1U-F-TEID */
     req->bearer_contexts.s1_u_enodeb_f_teid.presence = 0;
@@ -869,6 +883,7 @@ void sgw_s11_handle_release_access_bearers_request(ogs_gtp_xact_t *s11_xact,
             ogs_assert(s1u_tunnel);
 
             s1u_tunnel->remote_teid = 0;
+            sgw_bearer_publish(bearer);
 
             bearer = next_bearer;
         }
@@ -1049,6 +1064,7 @@ void sgw_s11_handle_create_indirect_data_forwarding_tunnel_request(
             }
             /* Setup GTP Node */
             OGS_SETUP_GTP_NODE(tunnel, enb);
+            sgw_bearer_publish(bearer);
 
             memset(&rsp_dl_teid[i], 0, sizeof(ogs_gtp_f_teid_t));
             rsp_dl_teid[i].interface_type = tunnel->interface_type;
@@ -1089,6 +1105,7 @@ void sgw_s11_handle_create_indirect_data_forwarding_tunnel_request(
             }
             /* Setup GTP Node */
             OGS_SETUP_GTP_NODE(tunnel, enb);
+            sgw_bearer_publish(bearer);
 
             memset(&rsp_ul_teid[i], 0, sizeof(ogs_gtp_f_teid_t));
             rsp_ul_teid[i].teid = htonl(tunnel->local_teid);
@@ -1277,7 +1294,12 @@ void sgw_s11_handle_bearer_resource_command(ogs_gtp_xact_t *s11_xact,
 
     s5c_xact = ogs_gtp_xact_local_create(
             sess->gnode, &message->h, pkbuf, timeout, sess);
-    ogs_expect_or_return(s5c_xact);
+    if (!s5c_xact) {
+        ogs_gtp_send_error_message(s11_xact, sgw_ue->mme_s11_teid,
+                OGS_GTP_BEARER_RESOURCE_FAILURE_INDICATION_TYPE,
+                OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+        return;
+    }
 
     ogs_gtp_xact_associate(s11_xact, s5c_xact);
 
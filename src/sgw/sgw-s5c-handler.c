@@ -176,6 +176,7 @@ void sgw_s5c_handle_create_session_response(ogs_gtp_xact_t *s5c_xact,
     }
     /* Setup GTP Node */
     OGS_SETUP_GTP_NODE(s5u_tunnel, pgw);
+    sgw_bearer_publish(bearer);
 
     /* Send Control Plane(UL) : SGW-S11 */
     memset(&sgw_s11_teid, 0, sizeof(ogs_gtp_f_teid_t));
@@ -367,6 +368,7 @@ void sgw_s5c_handle_create_bearer_request(ogs_gtp_xact_t *s5c_xact,
     }
     /* Setup GTP Node */
     OGS_SETUP_GTP_NODE(s5u_tunnel, pgw);
+    sgw_bearer_publish(bearer);
 
     /* Remove S5U-F-TEID */
     req->bearer_contexts.s5_s8_u_sgw_f_teid.presence = 0;
@@ -390,7 +392,14 @@ void sgw_s5c_handle_create_bearer_request(ogs_gtp_xact_t *s5c_xact,
 
     s11_xact = ogs_gtp_xact_local_create(
             sgw_ue->gnode, &message->h, pkbuf, timeout, sess);
-    ogs_expect_or_return(s11_xact);
+    if (!s11_xact) {
+        /* The relay failed, so answer the PGW on its own xact */
+        sgw_bearer_remove(bearer);
+        ogs_gtp_send_error_message(s5c_xact, sess->pgw_s5c_teid,
+                OGS_GTP_CREATE_BEARER_RESPONSE_TYPE,
+                OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+        return;
+    }
 
     ogs_gtp_xact_associate(s5c_xact, s11_xact);
 
@@ -454,7 +463,12 @@ void sgw_s5c_handle_update_bearer_request(ogs_gtp_xact_t *s5c_xact,
     if (!s11_xact) {
         s11_xact = ogs_gtp_xact_local_create(
                 sgw_ue->gnode, &message->h, pkbuf, timeout, sess);
-        ogs_expect_or_return(s11_xact);
+        if (!s11_xact) {
+            ogs_gtp_send_error_message(s5c_xact, sess->pgw_s5c_teid,
+                    OGS_GTP_UPDATE_BEARER_RESPONSE_TYPE,
+                    OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+            return;
+        }
 
         ogs_gtp_xact_associate(s5c_xact, s11_xact);
     } else {
@@ -519,7 +533,12 @@ void sgw_s5c_handle_delete_bearer_request(ogs_gtp_xact_t *s5c_xact,
 
     s11_xact = ogs_gtp_xact_local_create(
             sgw_ue->gnode, &message->h, pkbuf, timeout, sess);
-    ogs_expect_or_return(s11_xact);
+    if (!s11_xact) {
+        ogs_gtp_send_error_message(s5c_xact, sess->pgw_s5c_teid,
+                OGS_GTP_DELETE_BEARER_RESPONSE_TYPE,
+                OGS_GTP_CAUSE_NO_RESOURCES_AVAILABLE);
+        return;
+    }
 
     ogs_gtp_xact_associate(s5c_xact, s11_xact);
 
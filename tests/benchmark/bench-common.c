@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-common.h"
+
+int bench_initialize(int argc, char **argv, int default_count)
+{
+    ogs_pkbuf_config_t config;
+    int count = default_count;
+
+    if (argc > 1)
+        count = atoi(argv[1]);
+    if (count <= 0) {
+        fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    ogs_core_initialize();
+    ogs_pkbuf_default_init(&config);
+    /* ogs_malloc() is backed by the default pool: leave room for
+     * a few small objects per element and some large arrays */
+    config.cluster_128_pool = ogs_max(config.cluster_128_pool, count * 4);
+    config.cluster_256_pool = ogs_max(config.cluster_256_pool, count);
+    config.cluster_512_pool = ogs_max(config.cluster_512_pool, count * 2);
+    config.cluster_big_pool = 64;
+    ogs_pkbuf_default_create(&config);
+
+    return count;
+}
+
+void bench_terminate(void)
+{
+    ogs_pkbuf_default_destroy();
+    ogs_core_terminate();
+}
+
+void bench_report(const char *name, int count, int ops, ogs_time_t usec)
+{
+    printf("%-24s n=%-8d %10.1f ns/op\n",
+            name, count, ops ? (double)usec * 1000 / ops : 0);
+}
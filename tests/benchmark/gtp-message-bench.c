@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * GTPv2-C TLV parse and build of the captured Create Session Request
+ * used by gtp-message-test.
+ */
+
+#include "ogs-gtp.h"
+
+#include "bench-common.h"
+
+int main(int argc, char **argv)
+{
+    /* Create Session Request */
+    const char *payload =
+        "0100080055153011 340010f44c000600 9471527600414b00 0800536120009178"
+        "840056000d001855 f501102255f50100 019d015300030055 f501520001000657"
+        "0009008a80000084 0a32360a57000901 87000000000a3236 254700220005766f"
+        "6c7465036e673204 6d6e6574066d6e63 303130066d636335 3535046770727380"
+        "000100fc63000100 014f000500010000 00007f0001000048 000800000003e800"
+        "0007d04e001a0080 8021100100001081 0600000000830600 000000000d00000a"
+        "005d001f00490001 0005500016004505 0000000000000000 0000000000000000"
+        "0000000072000200 40005f0002005400";
+    char hexbuf[OGS_MAX_SDU_LEN];
+    int len = 240;
+
+    ogs_gtp_create_session_request_t req;
+    ogs_pkbuf_t *pkbuf = NULL, *built = NULL;
+    ogs_time_t t;
+    int count, i;
+
+    count = bench_initialize(argc, argv, 1000000);
+    ogs_log_install_domain(&__ogs_gtp_domain, "gtp", OGS_LOG_ERROR);
+
+    pkbuf = ogs_pkbuf_alloc(NULL, len);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf, OGS_HEX(payload, strlen(payload), hexbuf), len);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        memset(&req, 0, sizeof(req));
+        ogs_assert(ogs_tlv_parse_msg(&req,
+                    &ogs_gtp_tlv_desc_create_session_request,
+                    pkbuf, OGS_TLV_MODE_T1_L2_I1) == OGS_OK);
+    }
+    bench_report("parse", count, count, ogs_get_monotonic_time() - t);
+    ogs_assert(req.charging_characteristics.presence);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        built = ogs_tlv_build_msg(&ogs_gtp_tlv_desc_create_session_request,
+                &req, OGS_TLV_MODE_T1_L2_I1);
+        ogs_assert(built);
+        ogs_assert(built->len == len);
+        ogs_pkbuf_free(built);
+    }
+    bench_report("build", count, count, ogs_get_monotonic_time() - t);
+
+    built = ogs_tlv_build_msg(&ogs_gtp_tlv_desc_create_session_request,
+            &req, OGS_TLV_MODE_T1_L2_I1);
+    ogs_assert(built);
+    ogs_assert(memcmp(built->data, pkbuf->data, len) == 0);
+    ogs_pkbuf_free(built);
+
+    ogs_pkbuf_free(pkbuf);
+
+    bench_terminate();
+
+    return 0;
+}
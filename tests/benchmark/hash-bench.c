@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ogs_hash insert/lookup with the MME's key shapes: 8-byte BCD IMSIs
+ * and GUTIs that differ only in the trailing M-TMSI, inserted in order
+ * and shuffled. The worst single insertion shows the cost of growing.
+ */
+
+#include "bench-common.h"
+
+typedef struct bench_imsi_s {
+    uint8_t imsi[8];
+} bench_imsi_t;
+
+typedef struct bench_guti_s {
+    uint8_t plmn_id[3];
+    uint16_t mme_gid;
+    uint8_t mme_code;
+    uint32_t m_tmsi;
+} __attribute__ ((packed)) bench_guti_t;
+
+static void run(const char *name, uint8_t *keys, int klen, int count)
+{
+    ogs_hash_t *hash = NULL;
+    ogs_time_t t, start, worst = 0;
+    int i, miss = 0;
+    char label[32];
+
+    hash = ogs_hash_make();
+    ogs_assert(hash);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        t = ogs_get_monotonic_time();
+        ogs_hash_set(hash, keys + i * klen, klen, keys + i * klen);
+        t = ogs_get_monotonic_time() - t;
+        if (t > worst)
+            worst = t;
+    }
+    t = ogs_get_monotonic_time() - start;
+    ogs_snprintf(label, sizeof(label), "%s/insert", name);
+    bench_report(label, count, count, t);
+    printf("%-24s n=%-8d %10lld us\n", "  worst insert", count,
+            (long long)worst);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        int j = (int)(((uint64_t)i * 7919) % count);
+        if (ogs_hash_get(hash, keys + j * klen, klen) == NULL)
+            miss++;
+    }
+    t = ogs_get_monotonic_time() - start;
+    ogs_snprintf(label, sizeof(label), "%s/get", name);
+    bench_report(label, count, count, t);
+
+    ogs_assert(miss == 0);
+    ogs_hash_destroy(hash);
+}
+
+static void shuffle(uint8_t *keys, int klen, int count)
+{
+    uint8_t tmp[16];
+    int i, j;
+
+    ogs_assert(klen <= sizeof(tmp));
+
+    srand(1);
+    for (i = count - 1; i > 0; i--) {
+        j = rand() % (i + 1);
+        memcpy(tmp, keys + i * klen, klen);
+        memcpy(keys + i * klen, keys + j * klen, klen);
+        memcpy(keys + j * klen, tmp, klen);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench_imsi_t *imsi = NULL;
+    bench_guti_t *guti = NULL;
+    int count, i, k;
+
+    count = bench_initialize(argc, argv, 100000);
+
+    imsi = calloc(count, sizeof(*imsi));
+    ogs_assert(imsi);
+    guti = calloc(count, sizeof(*guti));
+    ogs_assert(guti);
+
+    for (i = 0; i < count; i++) {
+        /* IMSI 00101xxxxxxxxxx in TBCD */
+        uint8_t digit[16] = { 0, 0, 1, 0, 1 };
+        uint64_t msin = 1234500000ULL + i;
+
+        for (k = 14; k >= 5; k--) {
+            digit[k] = msin % 10;
+            msin /= 10;
+        }
+        digit[15] = 0xf;
+        for (k = 0; k < 8; k++)
+            imsi[i].imsi[k] = digit[2*k] | (digit[2*k+1] << 4);
+
+        guti[i].plmn_id[0] = 0x00;
+        guti[i].plmn_id[1] = 0xf1;
+        guti[i].plmn_id[2] = 0x10;
+        guti[i].mme_gid = htobe16(2);
+        guti[i].mme_code = 1;
+        guti[i].m_tmsi = htobe32(0xc0000000 | i);
+    }
+
+    run("imsi", (uint8_t *)imsi, sizeof(*imsi), count);
+    run("guti", (uint8_t *)guti, sizeof(*guti), count);
+
+    shuffle((uint8_t *)imsi, sizeof(*imsi), count);
+    shuffle((uint8_t *)guti, sizeof(*guti), count);
+
+    run("imsi-shuffled", (uint8_t *)imsi, sizeof(*imsi), count);
+    run("guti-shuffled", (uint8_t *)guti, sizeof(*guti), count);
+
+    free(guti);
+    free(imsi);
+
+    bench_terminate();
+
+    return 0;
+}
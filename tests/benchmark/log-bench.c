@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The two per-packet ogs_debug() calls of the SGW GTP-U path with debug
+ * logging off: through the level-checking macro, and through a direct
+ * ogs_log_printf() call as the macro expanded to before.
+ *
+ * Then the caller's cost of a per-packet ogs_warn() written to stderr
+ * and a file (both /dev/null here) by the synchronous writer, by the
+ * asynchronous writer, and rate-limited.
+ *
+ * This is CPU time per packet only, not GTP-U packets per second. That
+ * needs a running SGW with eNB and PGW peers and a traffic generator.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench-common.h"
+
+#define ogs_debug_unchecked(...) \
+    ogs_log_printf(OGS_LOG_DEBUG, OGS_LOG_DOMAIN, \
+    0, __FILE__, __LINE__, OGS_FUNC,  \
+    0, __VA_ARGS__)
+
+static ogs_sockaddr_t from, to;
+static volatile uint32_t sink;
+
+static void packet_unchecked(uint32_t teid)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_debug_unchecked("[SGW] RECV GPU-U from [%s] : TEID[0x%x]",
+            OGS_ADDR(&from, buf), teid);
+    ogs_debug_unchecked("[SGW] SEND GPU-U to [%s]: TEID[0x%x]",
+            OGS_ADDR(&to, buf), teid + 1);
+    sink = teid;
+}
+
+static void packet_checked(uint32_t teid)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_debug("[SGW] RECV GPU-U from [%s] : TEID[0x%x]",
+            OGS_ADDR(&from, buf), teid);
+    ogs_debug("[SGW] SEND GPU-U to [%s]: TEID[0x%x]",
+            OGS_ADDR(&to, buf), teid + 1);
+    sink = teid;
+}
+
+static void writer_run(const char *name, int count)
+{
+    ogs_time_t t;
+    char label[32];
+    int i;
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_warn("[DROP] Cannot find PGW S5U bearer : TEID[0x%x]", i);
+    ogs_snprintf(label, sizeof(label), "%s/warn", name);
+    bench_report(label, count, count, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_warn_ratelimited(
+                "[DROP] Cannot find PGW S5U bearer : TEID[0x%x]", i);
+    ogs_snprintf(label, sizeof(label), "%s/warn-ratelimited", name);
+    bench_report(label, count, count, ogs_get_monotonic_time() - t);
+}
+
+int main(int argc, char **argv)
+{
+    ogs_log_t *log = NULL;
+    ogs_time_t t;
+    int count, i, fd, saved_stderr;
+
+    count = bench_initialize(argc, argv, 1000000);
+    ogs_assert(!ogs_log_enabled(OGS_LOG_DEBUG, OGS_LOG_DOMAIN));
+
+    memset(&from, 0, sizeof(from));
+    from.ogs_sa_family = AF_INET;
+    from.sin.sin_addr.s_addr = htobe32(0x0a000001);
+    from.ogs_sin_port = htobe16(2152);
+    to = from;
+    to.sin.sin_addr.s_addr = htobe32(0x0a000002);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        packet_unchecked(i);
+    bench_report("debug-off/unchecked", count, count,
+            ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        packet_checked(i);
+    bench_report("debug-off/checked", count, count,
+            ogs_get_monotonic_time() - t);
+
+    log = ogs_log_add_file("/dev/null");
+    ogs_assert(log);
+
+    fflush(stderr);
+    saved_stderr = dup(STDERR_FILENO);
+    ogs_assert(saved_stderr >= 0);
+    fd = open("/dev/null", O_WRONLY);
+    ogs_assert(fd >= 0);
+    ogs_assert(dup2(fd, STDERR_FILENO) >= 0);
+    close(fd);
+
+    writer_run("sync", count / 10);
+
+    ogs_assert(ogs_log_async_start() == OGS_OK);
+    writer_run("async", count / 10);
+    t = ogs_get_monotonic_time();
+    ogs_log_async_flush();
+    bench_report("async/flush", count / 10, 1, ogs_get_monotonic_time() - t);
+    ogs_log_async_stop();
+
+    fflush(stderr);
+    ogs_assert(dup2(saved_stderr, STDERR_FILENO) >= 0);
+    close(saved_stderr);
+
+    ogs_log_remove(log);
+
+    bench_terminate();
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * M-TMSI pool generation: the former ogs_random32() draw with a scan
+ * of all earlier values, which is O(n^2), against the Feistel
+ * permutation used by mme_m_tmsi_pool_generate().
+ */
+
+#include "bench-common.h"
+#include "mme/mme-m-tmsi.h"
+
+/* The scan is quadratic, so the old scheme is measured up to this */
+#define MAX_NUM_OF_SCAN     32768
+
+static int generate_scan(uint32_t *array, int count)
+{
+    int index = 0, i, conflict = 0;
+
+    while (index < count) {
+        uint32_t m_tmsi = ogs_random32();
+
+        /* for mapped-GUTI */
+        m_tmsi |= 0xc0000000;
+        m_tmsi &= 0xff00ffff;
+
+        for (i = 0; i < index; i++)
+            if (m_tmsi == array[i])
+                break;
+        if (i < index) {
+            conflict++;
+            continue;
+        }
+
+        array[index++] = m_tmsi;
+    }
+
+    return conflict;
+}
+
+static void generate_permute(uint32_t *array, int count)
+{
+    uint32_t key[MME_M_TMSI_ROUNDS];
+    int i;
+
+    for (i = 0; i < MME_M_TMSI_ROUNDS; i++)
+        key[i] = ogs_random32();
+
+    for (i = 0; i < count; i++)
+        array[i] = mme_m_tmsi_permute(i, key);
+}
+
+static void check(uint32_t *array, int count)
+{
+    uint8_t *seen = NULL;
+    int i;
+
+    seen = calloc(1, 1 << MME_M_TMSI_BITS);
+    ogs_assert(seen);
+
+    for (i = 0; i < count; i++) {
+        uint32_t v = array[i];
+
+        ogs_assert((v & 0xc0000000) == 0xc0000000);
+        ogs_assert((v & 0x00ff0000) == 0);
+
+        v = (v & 0xffff) | ((v >> 8) & 0x3f0000);
+        ogs_assert(seen[v] == 0);
+        seen[v] = 1;
+    }
+
+    free(seen);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t *array = NULL;
+    int count, scan, conflict;
+    ogs_time_t t;
+
+    count = bench_initialize(argc, argv, 1 << MME_M_TMSI_BITS);
+    ogs_assert(count <= (1 << MME_M_TMSI_BITS));
+
+    array = calloc(count, sizeof(*array));
+    ogs_assert(array);
+
+    scan = ogs_min(count, MAX_NUM_OF_SCAN);
+    t = ogs_get_monotonic_time();
+    conflict = generate_scan(array, scan);
+    bench_report("scan", scan, scan, ogs_get_monotonic_time() - t);
+    printf("%-24s n=%-8d %10d\n", "  conflicts", scan, conflict);
+    check(array, scan);
+
+    t = ogs_get_monotonic_time();
+    generate_permute(array, count);
+    bench_report("permute", count, count, ogs_get_monotonic_time() - t);
+    check(array, count);
+
+    free(array);
+
+    bench_terminate();
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Flow-Description compilation for PCC rules: distinct descriptions,
+ * each parsed and entered in the rule cache, and the same few
+ * descriptions installed again and again, as PCRF sends them for
+ * every subscriber.
+ */
+
+#include "pgw-ipfw.h"
+
+#include "bench-common.h"
+
+#define DESCRIPTION_LEN 64
+
+static const char *common_description[] = {
+    "permit out 17 from 10.45.0.2 to 172.16.1.3 5060",
+    "permit out 17 from 172.20.166.84 to 10.45.0.2 20002",
+    "permit out udp from 10.45.0.2 49152-65535 to 172.16.1.3 5060",
+    "permit out 6 from 192.168.1.0/24 80 to 10.45.0.0/16 1024-2048",
+    "permit out tcp from any to 8.8.8.8 443",
+    "permit out ip from 10.45.0.2 to any",
+    "permit out 17 from 2001:db8::1 to 2001:db8:cafe::/48 5060",
+    "permit out 58 from 2001:db8::/64 to any",
+};
+
+int main(int argc, char **argv)
+{
+    pgw_rule_t rule;
+    char **description = NULL;
+    ogs_time_t t;
+    int count, i, n = OGS_ARRAY_SIZE(common_description);
+
+    count = bench_initialize(argc, argv, 100000);
+    pgw_ipfw_init();
+
+    description = calloc(count, sizeof(*description));
+    ogs_assert(description);
+    for (i = 0; i < count; i++) {
+        description[i] = malloc(DESCRIPTION_LEN);
+        ogs_assert(description[i]);
+        snprintf(description[i], DESCRIPTION_LEN,
+                "permit out 17 from 10.%d.%d.%d to 172.16.1.3 %d",
+                (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff,
+                1024 + i % 60000);
+    }
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_assert(pgw_compile_packet_filter(
+                    &rule, description[i]) == OGS_OK);
+    bench_report("distinct", count, count, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_assert(pgw_compile_packet_filter(
+                    &rule, common_description[i % n]) == OGS_OK);
+    bench_report("common", count, count, ogs_get_monotonic_time() - t);
+
+    for (i = 0; i < count; i++)
+        free(description[i]);
+    free(description);
+
+    pgw_ipfw_final();
+    bench_terminate();
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * S1AP decode+free of an InitialUEMessage and build+encode of an
+ * InitialContextSetupRequest with two E-RABs, both of which go through
+ * the per-message asn1c arena.
+ */
+
+#include "ogs-s1ap.h"
+
+#include "bench-common.h"
+
+static ogs_pkbuf_t *build_initial_context_setup_request(void)
+{
+    ogs_s1ap_message_t pdu;
+    S1AP_InitiatingMessage_t *initiatingMessage = NULL;
+    S1AP_InitialContextSetupRequest_t *InitialContextSetupRequest = NULL;
+    S1AP_InitialContextSetupRequestIEs_t *ie = NULL;
+    S1AP_E_RABToBeSetupListCtxtSUReq_t *E_RABToBeSetupListCtxtSUReq = NULL;
+    ogs_ip_t ip;
+    int i;
+
+    ogs_s1ap_init_message(&pdu);
+    pdu.present = S1AP_S1AP_PDU_PR_initiatingMessage;
+    pdu.choice.initiatingMessage =
+        CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
+
+    initiatingMessage = pdu.choice.initiatingMessage;
+    initiatingMessage->procedureCode =
+        S1AP_ProcedureCode_id_InitialContextSetup;
+    initiatingMessage->criticality = S1AP_Criticality_reject;
+    initiatingMessage->value.present =
+        S1AP_InitiatingMessage__value_PR_InitialContextSetupRequest;
+
+    InitialContextSetupRequest =
+        &initiatingMessage->value.choice.InitialContextSetupRequest;
+
+    ie = CALLOC(1, sizeof(S1AP_InitialContextSetupRequestIEs_t));
+    ASN_SEQUENCE_ADD(&InitialContextSetupRequest->protocolIEs, ie);
+    ie->id = S1AP_ProtocolIE_ID_id_MME_UE_S1AP_ID;
+    ie->criticality = S1AP_Criticality_reject;
+    ie->value.present =
+        S1AP_InitialContextSetupRequestIEs__value_PR_MME_UE_S1AP_ID;
+    ie->value.choice.MME_UE_S1AP_ID = 1;
+
+    ie = CALLOC(1, sizeof(S1AP_InitialContextSetupRequestIEs_t));
+    ASN_SEQUENCE_ADD(&InitialContextSetupRequest->protocolIEs, ie);
+    ie->id = S1AP_ProtocolIE_ID_id_eNB_UE_S1AP_ID;
+    ie->criticality = S1AP_Criticality_reject;
+    ie->value.present =
+        S1AP_InitialContextSetupRequestIEs__value_PR_ENB_UE_S1AP_ID;
+    ie->value.choice.ENB_UE_S1AP_ID = 2;
+
+    ie = CALLOC(1, sizeof(S1AP_InitialContextSetupRequestIEs_t));
+    ASN_SEQUENCE_ADD(&InitialContextSetupRequest->protocolIEs, ie);
+    ie->id = S1AP_ProtocolIE_ID_id_uEaggregateMaximumBitrate;
+    ie->criticality = S1AP_Criticality_reject;
+    ie->value.present =
+        S1AP_InitialContextSetupRequestIEs__value_PR_UEAggregateMaximumBitrate;
+    asn_uint642INTEGER(&ie->value.choice.UEAggregateMaximumBitrate.
+            uEaggregateMaximumBitRateUL, 1000000);
+    asn_uint642INTEGER(&ie->value.choice.UEAggregateMaximumBitrate.
+            uEaggregateMaximumBitRateDL, 2000000);
+
+    ie = CALLOC(1, sizeof(S1AP_InitialContextSetupRequestIEs_t));
+    ASN_SEQUENCE_ADD(&InitialContextSetupRequest->protocolIEs, ie);
+    ie->id = S1AP_ProtocolIE_ID_id_E_RABToBeSetupListCtxtSUReq;
+    ie->criticality = S1AP_Criticality_reject;
+    ie->value.present =
+    S1AP_InitialContextSetupRequestIEs__value_PR_E_RABToBeSetupListCtxtSUReq;
+    E_RABToBeSetupListCtxtSUReq =
+        &ie->value.choice.E_RABToBeSetupListCtxtSUReq;
+
+    memset(&ip, 0, sizeof(ip));
+    ip.ipv4 = 1;
+    ip.addr = htobe32(0x7f000001);
+
+    for (i = 0; i < 2; i++) {
+        S1AP_E_RABToBeSetupItemCtxtSUReqIEs_t *item = NULL;
+        S1AP_E_RABToBeSetupItemCtxtSUReq_t *e_rab = NULL;
+
+        item = CALLOC(1, sizeof(S1AP_E_RABToBeSetupItemCtxtSUReqIEs_t));
+        ASN_SEQUENCE_ADD(&E_RABToBeSetupListCtxtSUReq->list, item);
+        item->id = S1AP_ProtocolIE_ID_id_E_RABToBeSetupItemCtxtSUReq;
+        item->criticality = S1AP_Criticality_reject;
+        item->value.present =
+    S1AP_E_RABToBeSetupItemCtxtSUReqIEs__value_PR_E_RABToBeSetupItemCtxtSUReq;
+
+        e_rab = &item->value.choice.E_RABToBeSetupItemCtxtSUReq;
+        e_rab->e_RAB_ID = 5 + i;
+        e_rab->e_RABlevelQoSParameters.qCI = 9;
+        ogs_s1ap_ip_to_BIT_STRING(&ip, &e_rab->transportLayerAddress);
+        ogs_s1ap_uint32_to_OCTET_STRING(0x1234 + i, &e_rab->gTP_TEID);
+
+        e_rab->nAS_PDU = CALLOC(1, sizeof(S1AP_NAS_PDU_t));
+        e_rab->nAS_PDU->size = 60;
+        e_rab->nAS_PDU->buf = CALLOC(e_rab->nAS_PDU->size, sizeof(uint8_t));
+    }
+
+    ie = CALLOC(1, sizeof(S1AP_InitialContextSetupRequestIEs_t));
+    ASN_SEQUENCE_ADD(&InitialContextSetupRequest->protocolIEs, ie);
+    ie->id = S1AP_ProtocolIE_ID_id_SecurityKey;
+    ie->criticality = S1AP_Criticality_reject;
+    ie->value.present =
+        S1AP_InitialContextSetupRequestIEs__value_PR_SecurityKey;
+    ie->value.choice.SecurityKey.size = 32; /* KeNB : 256 bits */
+    ie->value.choice.SecurityKey.buf =
+        CALLOC(ie->value.choice.SecurityKey.size, sizeof(uint8_t));
+
+    return ogs_s1ap_encode(&pdu);
+}
+
+int main(int argc, char **argv)
+{
+    /* InitialUE(Attach Request) */
+    const char *payload =
+        "000c406f000006000800020001001a00"
+        "3c3b17df675aa8050741020bf600f110"
+        "000201030003e605f070000010000502"
+        "15d011d15200f11030395c0a003103e5"
+        "e0349011035758a65d0100e0c1004300"
+        "060000f1103039006440080000f1108c"
+        "3378200086400130004b00070000f110"
+        "000201";
+    char hexbuf[OGS_MAX_SDU_LEN];
+    ogs_s1ap_message_t message;
+    ogs_pkbuf_t *pkbuf = NULL, *encoded = NULL, *expected = NULL;
+    ogs_time_t t;
+    int count, i;
+
+    count = bench_initialize(argc, argv, 100000);
+    ogs_log_install_domain(&__ogs_s1ap_domain, "s1ap", OGS_LOG_ERROR);
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf,
+            OGS_HEX(payload, strlen(payload), hexbuf), 115);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        ogs_assert(ogs_s1ap_decode(&message, pkbuf) == OGS_OK);
+        ogs_s1ap_free(&message);
+    }
+    bench_report("decode+free", count, count, ogs_get_monotonic_time() - t);
+
+    expected = build_initial_context_setup_request();
+    ogs_assert(expected);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        encoded = build_initial_context_setup_request();
+        ogs_assert(encoded);
+        ogs_assert(encoded->len == expected->len);
+        ogs_assert(memcmp(encoded->data, expected->data, encoded->len) == 0);
+        ogs_pkbuf_free(encoded);
+    }
+    bench_report("build+encode", count, count, ogs_get_monotonic_time() - t);
+
+    ogs_pkbuf_free(expected);
+    ogs_pkbuf_free(pkbuf);
+
+    bench_terminate();
+
+    return 0;
+}
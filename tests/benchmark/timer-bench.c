@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Timer start/restart/stop/expire with the red-black tree and with the
+ * hierarchical timing wheel (ogs_core()->timer.wheel). Timeouts are
+ * spread over 1..61 seconds, as for UE and transaction timers.
+ */
+
+#include "bench-common.h"
+
+static int fired;
+
+static void timer_cb(void *data)
+{
+    fired++;
+}
+
+static void run(const char *name, int wheel, int count)
+{
+    ogs_timer_mgr_t *manager = NULL;
+    ogs_timer_t **timer = NULL;
+    ogs_time_t t, *duration = NULL;
+    char label[32];
+    int i;
+
+    ogs_core()->timer.wheel = wheel;
+    manager = ogs_timer_mgr_create();
+    ogs_assert(manager);
+
+    timer = calloc(count, sizeof(*timer));
+    ogs_assert(timer);
+    duration = calloc(count, sizeof(*duration));
+    ogs_assert(duration);
+    for (i = 0; i < count; i++) {
+        timer[i] = ogs_timer_add(manager, timer_cb, NULL);
+        ogs_assert(timer[i]);
+    }
+
+    for (i = 0; i < count; i++)
+        duration[i] = ogs_time_from_msec(1000 + ogs_random32() % 60000);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_timer_start(timer[i], duration[i]);
+    ogs_snprintf(label, sizeof(label), "%s/start", name);
+    bench_report(label, count, count, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_timer_start(timer[i], duration[count - 1 - i]);
+    ogs_snprintf(label, sizeof(label), "%s/restart", name);
+    bench_report(label, count, count, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++)
+        ogs_timer_stop(timer[i]);
+    ogs_snprintf(label, sizeof(label), "%s/stop", name);
+    bench_report(label, count, count, ogs_get_monotonic_time() - t);
+
+    for (i = 0; i < count; i++)
+        ogs_timer_start(timer[i],
+                ogs_time_from_msec(1 + ogs_random32() % 500));
+    ogs_msleep(600);
+
+    fired = 0;
+    t = ogs_get_monotonic_time();
+    ogs_timer_mgr_expire(manager);
+    ogs_snprintf(label, sizeof(label), "%s/expire", name);
+    bench_report(label, count, count, ogs_get_monotonic_time() - t);
+    ogs_assert(fired == count);
+
+    for (i = 0; i < count; i++)
+        ogs_timer_delete(timer[i]);
+    free(duration);
+    free(timer);
+
+    ogs_timer_mgr_destroy(manager);
+}
+
+int main(int argc, char **argv)
+{
+    int count;
+
+    count = bench_initialize(argc, argv, 1000000);
+    ogs_core()->timer.pool = count;
+
+    run("rbtree", 0, count);
+    run("wheel", 1, count);
+
+    bench_terminate();
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Downlink lookup against a populated PGW context: pgw_dl_find() as
+ * done by the GTP-U workers, and pgw_bearer_find_by_packet() on the
+ * PGW thread, for packets hitting the default and a dedicated bearer.
+ */
+
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+
+#include "pgw-context.h"
+#include "pgw-ipfw.h"
+
+#include "bench-common.h"
+
+#define STRIDE 7919
+
+static void sess_populate(int count)
+{
+    pgw_sess_t *sess = NULL;
+    pgw_bearer_t *bearer = NULL;
+    pgw_pf_t *pf = NULL;
+    ogs_paa_t paa;
+    uint8_t imsi[8];
+    int i, rv;
+
+    for (i = 0; i < count; i++) {
+        memset(imsi, 0, sizeof imsi);
+        memcpy(imsi, &i, sizeof i);
+
+        /* IPv4 from the pool, one static /64 per UE */
+        memset(&paa, 0, sizeof paa);
+        paa.pdn_type = OGS_GTP_PDN_TYPE_IPV4V6;
+        paa.both.addr6[0] = 0x20;
+        paa.both.addr6[1] = 0x01;
+        paa.both.addr6[2] = 0x0d;
+        paa.both.addr6[3] = 0xb8;
+        paa.both.addr6[4] = i >> 8;
+        paa.both.addr6[5] = i;
+        paa.both.addr6[15] = 1;
+
+        sess = pgw_sess_add(imsi, sizeof imsi, (char *)"internet",
+                OGS_GTP_PDN_TYPE_IPV4V6, 5, &paa);
+        ogs_assert(sess);
+
+        bearer = pgw_bearer_add(sess);
+        ogs_assert(bearer);
+        bearer->ebi = 6;
+
+        pf = pgw_pf_add(bearer, 1);
+        ogs_assert(pf);
+        pf->direction = OGS_FLOW_DOWNLINK_ONLY;
+        rv = pgw_compile_packet_filter(&pf->rule,
+                "permit out 17 from 172.16.1.3 5060 to 10.45.0.0/16");
+        ogs_assert(rv == OGS_OK);
+
+        pgw_compile_classifier(sess);
+    }
+}
+
+static ogs_pkbuf_t *udp_packet(uint32_t src, uint16_t sport, uint16_t dport)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    struct ip *ip_h = NULL;
+    struct udphdr *udp_h = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, sizeof *ip_h + sizeof *udp_h);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put(pkbuf, sizeof *ip_h + sizeof *udp_h);
+    memset(pkbuf->data, 0, pkbuf->len);
+
+    ip_h = (struct ip *)pkbuf->data;
+    ip_h->ip_v = 4;
+    ip_h->ip_hl = sizeof *ip_h >> 2;
+    ip_h->ip_p = IPPROTO_UDP;
+    ip_h->ip_src.s_addr = src;
+
+    udp_h = (struct udphdr *)(ip_h + 1);
+    udp_h->uh_sport = htons(sport);
+    udp_h->uh_dport = htons(dport);
+
+    return pkbuf;
+}
+
+static void find_by_packet(const char *name, pgw_sess_t **sess,
+        int count, int lookups, ogs_pkbuf_t *pkbuf, uint8_t ebi)
+{
+    struct ip *ip_h = (struct ip *)pkbuf->data;
+    pgw_bearer_t *bearer = NULL;
+    ogs_time_t t;
+    int i;
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < lookups; i++) {
+        ip_h->ip_dst.s_addr = sess[i % count]->ipv4->addr[0];
+        bearer = pgw_bearer_find_by_packet(pkbuf);
+        ogs_assert(bearer && bearer->ebi == ebi);
+    }
+    bench_report(name, count, lookups, ogs_get_monotonic_time() - t);
+}
+
+int main(int argc, char **argv)
+{
+    pgw_sess_t **sess = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    int count, lookups, i, miss = 0;
+    ogs_time_t t;
+
+    count = bench_initialize(argc, argv, 10000);
+    lookups = count < 1000 ? 1000 : count;
+
+    sess = calloc(count, sizeof(*sess));
+    ogs_assert(sess);
+
+    ogs_config_init();
+    ogs_config()->pool.sess = count;
+    ogs_config()->pool.bearer = count * 2;
+    ogs_config()->pool.pf = count * 2;
+
+    pgw_context_init();
+    pgw_ipfw_init();
+
+    /* Session setup logs a line per UE */
+    ogs_log_set_domain_level(__pgw_log_domain, OGS_LOG_ERROR);
+
+    ogs_assert(pgw_subnet_add("10.45.0.1", "16", NULL, "ogstun"));
+    ogs_assert(pgw_subnet_add("2001:db8::1", "32", NULL, "ogstun"));
+    ogs_assert(pgw_ue_pool_generate() == OGS_OK);
+
+    sess_populate(count);
+
+    /* Stride through the sessions so lookups do not follow the pool */
+    for (i = 0; i < count; i++) {
+        sess[i] = pgw_sess_find_by_teid(1 + (i * STRIDE) % count);
+        ogs_assert(sess[i]);
+    }
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < lookups; i++)
+        if (pgw_dl_find(4, sess[i % count]->ipv4->addr) == NULL)
+            miss++;
+    bench_report("dl_find/ipv4", count, lookups, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < lookups; i++)
+        if (pgw_dl_find(6, sess[i % count]->ipv6->addr) == NULL)
+            miss++;
+    bench_report("dl_find/ipv6", count, lookups, ogs_get_monotonic_time() - t);
+
+    ogs_assert(miss == 0);
+
+    pkbuf = udp_packet(inet_addr("8.8.8.8"), 53, 40000);
+    find_by_packet("packet/default", sess, count, lookups, pkbuf, 5);
+    ogs_pkbuf_free(pkbuf);
+
+    pkbuf = udp_packet(inet_addr("172.16.1.3"), 5060, 20000);
+    find_by_packet("packet/dedicated", sess, count, lookups, pkbuf, 6);
+    ogs_pkbuf_free(pkbuf);
+
+    free(sess);
+
+    pgw_ipfw_final();
+    pgw_context_final();
+    ogs_config_final();
+
+    bench_terminate();
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * GTPv2-C and PFCP transactions in flight towards a single peer:
+ * local create, response lookup by XID and teardown, as between
+ * the MME and its SGW during an attach storm.
+ */
+
+#include "ogs-gtp.h"
+#include "ogs-pfcp.h"
+
+#include "bench-common.h"
+
+#define LOOKUPS 2000000
+
+static void gtp_run(ogs_timer_mgr_t *manager, int count)
+{
+    ogs_gtp_node_t *gnode = NULL;
+    ogs_sockaddr_t *sa = NULL;
+    ogs_gtp_xact_t **xact = NULL;
+    ogs_gtp_header_t h;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_time_t t;
+    int i, r, rounds = LOOKUPS / count + 1;
+
+    ogs_gtp_node_init(1);
+    ogs_gtp_xact_init(manager, count);
+
+    ogs_assert(ogs_getaddrinfo(&sa, AF_INET, "127.0.0.2",
+                OGS_GTPV2_C_UDP_PORT, 0) == OGS_OK);
+    gnode = ogs_gtp_node_new(sa);
+    ogs_assert(gnode);
+    memcpy(&gnode->remote_addr, sa, sizeof(gnode->remote_addr));
+
+    xact = calloc(count, sizeof(*xact));
+    ogs_assert(xact);
+
+    memset(&h, 0, sizeof(h));
+    h.type = OGS_GTP_CREATE_SESSION_REQUEST_TYPE;
+    h.teid = 1;
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        pkbuf = ogs_pkbuf_alloc(NULL, OGS_GTPV2C_HEADER_LEN + 64);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_reserve(pkbuf, OGS_GTPV2C_HEADER_LEN);
+        ogs_pkbuf_put(pkbuf, 64);
+
+        xact[i] = ogs_gtp_xact_local_create(gnode, &h, pkbuf, NULL, NULL);
+        ogs_assert(xact[i]);
+    }
+    bench_report("gtp/create", count, count, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (r = 0; r < rounds; r++)
+        for (i = 0; i < count; i++)
+            ogs_assert(ogs_gtp_xact_find_by_xid(gnode,
+                        OGS_GTP_CREATE_SESSION_RESPONSE_TYPE,
+                        xact[i]->xid) == xact[i]);
+    bench_report("gtp/find", count, rounds * count,
+            ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    ogs_gtp_xact_delete_all(gnode);
+    bench_report("gtp/delete", count, count, ogs_get_monotonic_time() - t);
+
+    free(xact);
+    ogs_gtp_node_free(gnode);
+
+    ogs_gtp_xact_final();
+    ogs_gtp_node_final();
+}
+
+static void pfcp_run(ogs_timer_mgr_t *manager, int count)
+{
+    ogs_pfcp_node_t *pnode = NULL;
+    ogs_sockaddr_t *sa = NULL;
+    ogs_pfcp_xact_t **xact = NULL;
+    ogs_pfcp_header_t h;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_time_t t;
+    int i, r, rounds = LOOKUPS / count + 1;
+
+    ogs_pfcp_node_init(1);
+    ogs_pfcp_xact_init(manager, count);
+
+    ogs_assert(ogs_getaddrinfo(&sa, AF_INET, "127.0.0.3",
+                OGS_PFCP_UDP_PORT, 0) == OGS_OK);
+    pnode = ogs_pfcp_node_new(sa);
+    ogs_assert(pnode);
+    memcpy(&pnode->remote_addr, sa, sizeof(pnode->remote_addr));
+
+    xact = calloc(count, sizeof(*xact));
+    ogs_assert(xact);
+
+    memset(&h, 0, sizeof(h));
+    h.type = OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE;
+    h.seid = 1;
+
+    t = ogs_get_monotonic_time();
+    for (i = 0; i < count; i++) {
+        pkbuf = ogs_pkbuf_alloc(NULL, OGS_PFCP_HEADER_LEN + 64);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_reserve(pkbuf, OGS_PFCP_HEADER_LEN);
+        ogs_pkbuf_put(pkbuf, 64);
+
+        xact[i] = ogs_pfcp_xact_local_create(pnode, &h, pkbuf, NULL, NULL);
+        ogs_assert(xact[i]);
+    }
+    bench_report("pfcp/create", count, count, ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    for (r = 0; r < rounds; r++)
+        for (i = 0; i < count; i++)
+            ogs_assert(ogs_pfcp_xact_find_by_xid(pnode,
+                        OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE,
+                        xact[i]->xid) == xact[i]);
+    bench_report("pfcp/find", count, rounds * count,
+            ogs_get_monotonic_time() - t);
+
+    t = ogs_get_monotonic_time();
+    ogs_pfcp_xact_delete_all(pnode);
+    bench_report("pfcp/delete", count, count, ogs_get_monotonic_time() - t);
+
+    free(xact);
+    ogs_pfcp_node_free(pnode);
+
+    ogs_pfcp_xact_final();
+    ogs_pfcp_node_final();
+}
+
+int main(int argc, char **argv)
+{
+    ogs_timer_mgr_t *manager = NULL;
+    int count;
+
+    count = bench_initialize(argc, argv, 10000);
+    ogs_log_install_domain(&__ogs_gtp_domain, "gtp", OGS_LOG_ERROR);
+    ogs_log_install_domain(&__ogs_pfcp_domain, "pfcp", OGS_LOG_ERROR);
+
+    /* Response and holding timer per transaction */
+    ogs_core()->timer.pool = 2 * count;
+    manager = ogs_timer_mgr_create();
+    ogs_assert(manager);
+
+    gtp_run(manager, count);
+    pfcp_run(manager, count);
+
+    ogs_timer_mgr_destroy(manager);
+
+    bench_terminate();
+
+    return 0;
+}
@@ -386,6 +386,60 @@ static void hash_count_5(abts_case *tc, void *data)
     ogs_hash_destroy(h);
 }
 
+/* Stops early in growing from 8k to 16k buckets */
+#define NUM_OF_GROW_KEY 8200
+static void hash_grow_test(abts_case *tc, void *data)
+{
+    static int key[NUM_OF_GROW_KEY];
+    ogs_hash_t *h = NULL;
+    ogs_hash_index_t *hi;
+    int i, miss, count;
+
+    h = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, h);
+
+    /* Lookups also see the buckets that are not moved yet */
+    miss = 0;
+    for (i = 0; i < NUM_OF_GROW_KEY; i++) {
+        key[i] = i * 7919;
+        ogs_hash_set(h, &key[i], sizeof(key[i]), &key[i]);
+        if (ogs_hash_get(h, &key[i/2], sizeof(key[i/2])) != &key[i/2])
+            miss++;
+    }
+    ABTS_INT_EQUAL(tc, 0, miss);
+    ABTS_INT_EQUAL(tc, NUM_OF_GROW_KEY, ogs_hash_count(h));
+
+    count = 0;
+    for (hi = ogs_hash_first(h); hi; hi = ogs_hash_next(hi))
+        count++;
+    ABTS_INT_EQUAL(tc, NUM_OF_GROW_KEY, count);
+
+    for (i = 0; i < NUM_OF_GROW_KEY; i += 2)
+        ogs_hash_set(h, &key[i], sizeof(key[i]), NULL);
+    ABTS_INT_EQUAL(tc, NUM_OF_GROW_KEY/2, ogs_hash_count(h));
+
+    miss = 0;
+    for (i = 0; i < NUM_OF_GROW_KEY; i++)
+        if (ogs_hash_get(h, &key[i], sizeof(key[i])) != (i % 2 ? &key[i] : NULL))
+            miss++;
+    ABTS_INT_EQUAL(tc, 0, miss);
+
+    ogs_hash_destroy(h);
+
+    h = ogs_hash_make_size(NUM_OF_GROW_KEY);
+    ABTS_PTR_NOTNULL(tc, h);
+
+    miss = 0;
+    for (i = 0; i < NUM_OF_GROW_KEY; i++)
+        ogs_hash_set(h, &key[i], sizeof(key[i]), &key[i]);
+    for (i = 0; i < NUM_OF_GROW_KEY; i++)
+        if (ogs_hash_get(h, &key[i], sizeof(key[i])) != &key[i])
+            miss++;
+    ABTS_INT_EQUAL(tc, 0, miss);
+
+    ogs_hash_destroy(h);
+}
+
 abts_suite *test_hash(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -406,6 +460,7 @@ abts_suite *test_hash(abts_suite *suite)
     abts_run_test(suite, hash_clear_test, NULL);
     abts_run_test(suite, hash_traverse, NULL);
     abts_run_test(suite, summation_test, NULL);
+    abts_run_test(suite, hash_grow_test, NULL);
 
     return suite;
 }
@@ -103,11 +103,93 @@ static void test_basic(abts_case *tc, void *data)
 #endif
 }
 
+static int evaluated(int *count)
+{
+    (*count)++;
+    return 0;
+}
+
+static void test_level(abts_case *tc, void *data)
+{
+    int count = 0;
+    int domain_id = ogs_log_get_domain_id("core");
+    int core_level = ogs_log_get_domain_level(domain_id);
+
+    ogs_log_set_domain_level(domain_id, OGS_LOG_ERROR);
+    ABTS_TRUE(tc, ogs_log_enabled(OGS_LOG_ERROR, domain_id));
+    ABTS_TRUE(tc, !ogs_log_enabled(OGS_LOG_WARN, domain_id));
+
+    ogs_debug("%d", evaluated(&count));
+    ogs_trace("%d", evaluated(&count));
+    ABTS_INT_EQUAL(tc, 0, count);
+
+    ogs_log_set_mask_level("core", OGS_LOG_DEBUG);
+    ABTS_TRUE(tc, ogs_log_enabled(OGS_LOG_DEBUG, domain_id));
+    ABTS_TRUE(tc, !ogs_log_enabled(OGS_LOG_TRACE, domain_id));
+
+    ogs_log_set_domain_level(domain_id, core_level);
+}
+
+static void test_ratelimit(abts_case *tc, void *data)
+{
+    int i, n = 0;
+    ogs_log_ratelimit_t ratelimit;
+
+    memset(&ratelimit, 0, sizeof(ratelimit));
+
+    for (i = 0; i < OGS_LOG_RATELIMIT_BURST * 3; i++)
+        n += ogs_log_ratelimit(&ratelimit, OGS_LOG_WARN, OGS_LOG_DOMAIN,
+                __FILE__, __LINE__, OGS_FUNC);
+
+    ABTS_INT_EQUAL(tc, OGS_LOG_RATELIMIT_BURST, n);
+    ABTS_INT_EQUAL(tc, OGS_LOG_RATELIMIT_BURST * 2, ratelimit.suppressed);
+}
+
+#define NUM_OF_ASYNC_RECORD 100
+static void test_async(abts_case *tc, void *data)
+{
+    int rv, fd;
+    char name[] = "/tmp/ogs-log-XXXXXX";
+    FILE *fp = NULL;
+    ogs_log_t *log = NULL;
+    int i;
+
+    fd = mkstemp(name);
+    ABTS_TRUE(tc, fd >= 0);
+    close(fd);
+
+    rv = ogs_log_async_start();
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    log = ogs_log_add_file(name);
+    ABTS_PTR_NOTNULL(tc, log);
+
+    /* Blank content keeps the stderr target quiet */
+    for (i = 0; i < NUM_OF_ASYNC_RECORD; i++)
+        ogs_log_print(OGS_LOG_ERROR, " ");
+
+    ogs_log_async_flush();
+
+    fp = fopen(name, "r");
+    ABTS_PTR_NOTNULL(tc, fp);
+    fseek(fp, 0, SEEK_END);
+    ABTS_INT_EQUAL(tc, NUM_OF_ASYNC_RECORD, ftell(fp));
+    fclose(fp);
+
+    ogs_log_remove(log);
+    ogs_log_async_stop();
+
+    unlink(name);
+}
+
 abts_suite *test_log(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test_basic, NULL);
+    abts_run_test(suite, test_level, NULL);
+    abts_run_test(suite, test_ratelimit, NULL);
+    abts_run_test(suite, test_async, NULL);
 
     return suite;
 }
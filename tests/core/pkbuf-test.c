@@ -70,12 +70,75 @@ static void test2_func(abts_case *tc, void *data)
     ogs_pkbuf_free(p3);
 }
 
+static void test3_func(abts_case *tc, void *data)
+{
+    ogs_pkbuf_config_t config;
+    ogs_pkbuf_pool_t *pool = NULL;
+    ogs_pkbuf_cache_t *cache = NULL;
+    ogs_pkbuf_t *pkbuf[3], *p2 = NULL;
+    int i;
+
+    memset(&config, 0, sizeof config);
+    config.cluster_128_pool = 2;
+    config.cluster_2048_pool = 2;
+    pool = ogs_pkbuf_pool_create(&config);
+    ABTS_PTR_NOTNULL(tc, pool);
+
+    /* 128 exhausted, borrow 2048 */
+    for (i = 0; i < 3; i++) {
+        pkbuf[i] = ogs_pkbuf_alloc(pool, 100);
+        ABTS_PTR_NOTNULL(tc, pkbuf[i]);
+    }
+    ABTS_INT_EQUAL(tc, 2048, pkbuf[2]->cluster->size);
+    ABTS_INT_EQUAL(tc, 100, pkbuf[2]->end - pkbuf[2]->head);
+    for (i = 0; i < 3; i++)
+        ogs_pkbuf_free(pkbuf[i]);
+
+    cache = ogs_pkbuf_cache_create(pool);
+    ABTS_PTR_NOTNULL(tc, cache);
+
+    for (i = 0; i < 3; i++) {
+        pkbuf[i] = ogs_pkbuf_cache_alloc(cache, 100);
+        ABTS_PTR_NOTNULL(tc, pkbuf[i]);
+        ABTS_PTR_EQUAL(tc, cache, pkbuf[i]->cache);
+        ABTS_INT_EQUAL(tc, 0, pkbuf[i]->len);
+        ABTS_INT_EQUAL(tc, 100, pkbuf[i]->end - pkbuf[i]->head);
+    }
+    ABTS_INT_EQUAL(tc, 2048, pkbuf[2]->cluster->size);
+
+    p2 = ogs_pkbuf_copy(pkbuf[0]);
+    ABTS_PTR_NOTNULL(tc, p2);
+    ABTS_PTR_EQUAL(tc, NULL, p2->cache);
+    for (i = 0; i < 3; i++)
+        ogs_pkbuf_free(pkbuf[i]);
+    ogs_pkbuf_free(p2);
+
+    pkbuf[0] = ogs_pkbuf_cache_alloc(cache, 100);
+    ABTS_PTR_NOTNULL(tc, pkbuf[0]);
+    ABTS_INT_EQUAL(tc, 1, pkbuf[0]->cluster->ref);
+    ogs_pkbuf_free(pkbuf[0]);
+
+    /* In-flight pkbufs outlive the cache */
+    pkbuf[0] = ogs_pkbuf_cache_alloc(cache, 100);
+    ABTS_PTR_NOTNULL(tc, pkbuf[0]);
+    p2 = ogs_pkbuf_copy(pkbuf[0]);
+    ABTS_PTR_NOTNULL(tc, p2);
+    ABTS_INT_EQUAL(tc, 2, pkbuf[0]->cluster->ref);
+    ogs_pkbuf_cache_destroy(cache);
+    ogs_pkbuf_free(pkbuf[0]);
+    ABTS_INT_EQUAL(tc, 1, p2->cluster->ref);
+    ogs_pkbuf_free(p2);
+
+    ogs_pkbuf_pool_destroy(pool);
+}
+
 abts_suite *test_pkbuf(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test1_func, NULL);
     abts_run_test(suite, test2_func, NULL);
+    abts_run_test(suite, test3_func, NULL);
 
     return suite;
 }
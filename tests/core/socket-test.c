@@ -427,6 +427,53 @@ static void test8_func(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, OGS_OK, rv);
 }
 
+static void test9_func(abts_case *tc, void *data)
+{
+    ogs_sock_t *udp, *client;
+    int rv, i, n, total;
+    ogs_sockaddr_t *addr, from[3], *to[3];
+    ogs_socknode_t *node;
+    ogs_pkbuf_t *pkbuf[3];
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", PORT, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    node = ogs_socknode_new(addr);
+    ABTS_PTR_NOTNULL(tc, node);
+    udp = ogs_udp_server(node);
+    ABTS_PTR_NOTNULL(tc, udp);
+
+    client = ogs_udp_socket(AF_INET, NULL);
+    ABTS_PTR_NOTNULL(tc, client);
+
+    for (i = 0; i < 3; i++) {
+        pkbuf[i] = ogs_pkbuf_alloc(NULL, STRLEN);
+        ABTS_PTR_NOTNULL(tc, pkbuf[i]);
+        ogs_pkbuf_put_data(pkbuf[i], DATASTR, i+1);
+        to[i] = addr;
+    }
+    n = ogs_sendmmsg(client->fd, pkbuf, to, 3, 0);
+    ABTS_INT_EQUAL(tc, 3, n);
+
+    for (i = 0; i < 3; i++) {
+        ogs_pkbuf_free(pkbuf[i]);
+        pkbuf[i] = ogs_pkbuf_alloc(NULL, STRLEN);
+        ABTS_PTR_NOTNULL(tc, pkbuf[i]);
+        ogs_pkbuf_put(pkbuf[i], STRLEN);
+    }
+    for (total = 0; total < 3; total += n) {
+        n = ogs_recvmmsg(udp->fd, &pkbuf[total], &from[total], 3 - total, 0);
+        ABTS_TRUE(tc, n > 0);
+    }
+    for (i = 0; i < 3; i++) {
+        ABTS_INT_EQUAL(tc, i+1, pkbuf[i]->len);
+        ABTS_TRUE(tc, memcmp(pkbuf[i]->data, DATASTR, i+1) == 0);
+        ogs_pkbuf_free(pkbuf[i]);
+    }
+
+    ogs_sock_destroy(client);
+    ogs_socknode_free(node);
+}
+
 abts_suite *test_socket(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -439,6 +486,7 @@ abts_suite *test_socket(abts_suite *suite)
     abts_run_test(suite, test6_func, NULL);
     abts_run_test(suite, test7_func, NULL);
     abts_run_test(suite, test8_func, NULL);
+    abts_run_test(suite, test9_func, NULL);
 
     return suite;
 }
@@ -51,7 +51,9 @@ static void test1_func(abts_case *tc, void *data)
 
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
 
+    ogs_core()->timer.wheel = (uintptr_t)data;
     timer = ogs_timer_mgr_create();
+    ogs_core()->timer.wheel = 0;
     pollset = ogs_pollset_create();
     ogs_assert(timer);
     for(n = 0; n < sizeof(timer_duration)/sizeof(ogs_time_t); n++) {
@@ -126,7 +128,9 @@ static void test2_func(abts_case *tc, void *data)
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
     memset(tm_num, 0, sizeof(int)*(TEST_DURATION/TEST_TIMER_PRECISION));
 
+    ogs_core()->timer.wheel = (uintptr_t)data;
     timer = ogs_timer_mgr_create();
+    ogs_core()->timer.wheel = 0;
     ogs_assert(timer);
 
     for(n = 0; n < TEST_TIMER_NUM; n++) {
@@ -168,7 +172,9 @@ static void test3_func(abts_case *tc, void *data)
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
     memset(tm_num, 0, sizeof(int)*(TEST_DURATION/TEST_TIMER_PRECISION));
 
+    ogs_core()->timer.wheel = (uintptr_t)data;
     timer = ogs_timer_mgr_create();
+    ogs_core()->timer.wheel = 0;
     ogs_assert(timer);
 
     for(n = 0; n < TEST_TIMER_NUM; n++) {
@@ -208,6 +214,65 @@ static void test3_func(abts_case *tc, void *data)
     ogs_timer_mgr_destroy(timer);
 }
 
+static int test4_order[4];
+static int test4_count;
+
+static void test4_expire(void *data)
+{
+    test4_order[test4_count++] = (uintptr_t)data;
+}
+
+/* Timing wheel across cascades, restart and stop */
+static void test4_func(abts_case *tc, void *data)
+{
+    ogs_timer_mgr_t *timer = NULL;
+    ogs_timer_t *t[4];
+    ogs_time_t wait;
+    int n;
+
+    memset(test4_order, 0, sizeof(test4_order));
+    test4_count = 0;
+
+    ogs_core()->timer.wheel = 1;
+    timer = ogs_timer_mgr_create();
+    ogs_core()->timer.wheel = 0;
+    ogs_assert(timer);
+
+    for (n = 0; n < 4; n++) {
+        t[n] = ogs_timer_add(timer, test4_expire, (void*)(uintptr_t)(n+1));
+        ogs_assert(t[n]);
+    }
+
+    /* Level 2 (> 4 secs), Level 1, Level 0 */
+    ogs_timer_start(t[0], ogs_time_from_sec(5));
+    ogs_timer_start(t[1], ogs_time_from_msec(300));
+    ogs_timer_start(t[2], ogs_time_from_msec(30));
+    ogs_timer_start(t[3], ogs_time_from_msec(200));
+
+    wait = ogs_timer_mgr_next(timer);
+    ABTS_TRUE(tc, wait > 0 && wait <= ogs_time_from_msec(31));
+
+    /* Restart moves it, stop removes it */
+    ogs_timer_start(t[0], ogs_time_from_msec(100));
+    ogs_timer_stop(t[3]);
+
+    for (n = 0; n < 40 && test4_count < 3; n++) {
+        ogs_usleep(ogs_time_from_msec(10));
+        ogs_timer_mgr_expire(timer);
+    }
+
+    ABTS_INT_EQUAL(tc, 3, test4_count);
+    ABTS_INT_EQUAL(tc, 3, test4_order[0]);
+    ABTS_INT_EQUAL(tc, 1, test4_order[1]);
+    ABTS_INT_EQUAL(tc, 2, test4_order[2]);
+    ABTS_INT_EQUAL(tc, OGS_INFINITE_TIME, ogs_timer_mgr_next(timer));
+
+    for (n = 0; n < 4; n++)
+        ogs_timer_delete(t[n]);
+
+    ogs_timer_mgr_destroy(timer);
+}
+
 abts_suite *test_timer(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -216,5 +281,11 @@ abts_suite *test_timer(abts_suite *suite)
     abts_run_test(suite, test2_func, NULL);
     abts_run_test(suite, test3_func, NULL);
 
+    /* Timing wheel */
+    abts_run_test(suite, test1_func, (void *)1);
+    abts_run_test(suite, test2_func, (void *)1);
+    abts_run_test(suite, test3_func, (void *)1);
+    abts_run_test(suite, test4_func, NULL);
+
     return suite;
 }
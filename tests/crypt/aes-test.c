@@ -282,6 +282,28 @@ static void aes_test3(abts_case *tc, void *data)
     }
 }
 
+static void aes_test4(abts_case *tc, void *data)
+{
+    static const int key_bits[3] = { 128, 192, 256 };
+    uint32_t rk[OGS_AES_RKLENGTH(OGS_AES_MAX_KEY_BITS)];
+    ogs_aes_key_t aes;
+    uint8_t key[32], pt[16], ct1[16], ct2[16];
+    int i, j, nrounds;
+
+    for (i = 0; i < 3; i++) {
+        ogs_random(key, sizeof key);
+        nrounds = ogs_aes_setup_enc(rk, key, key_bits[i]);
+        ABTS_INT_EQUAL(tc, nrounds, ogs_aes_key_setup(&aes, key, key_bits[i]));
+
+        for (j = 0; j < 100; j++) {
+            ogs_random(pt, sizeof pt);
+            ogs_aes_encrypt(rk, nrounds, pt, ct1);
+            ogs_aes_key_encrypt(&aes, pt, ct2);
+            ABTS_INT_EQUAL(tc, 0, memcmp(ct1, ct2, 16));
+        }
+    }
+}
+
 /*  RFC 4493
 
     --------------------------------------------------
@@ -370,6 +392,7 @@ static void cmac_test(abts_case *tc, void *data)
     };
 
     uint8_t cmac[16];
+    ogs_aes_cmac_key_t cmac_key;
 
     int i, rc;
     int rv;
@@ -383,6 +406,16 @@ static void cmac_test(abts_case *tc, void *data)
         ABTS_INT_EQUAL(tc, 0, rc);
     }
 
+    ogs_aes_cmac_setup(&cmac_key, key);
+    for (i = 0; i < 4; i++)
+    {
+        rv = ogs_aes_cmac_calculate_key(cmac, &cmac_key, msg[i], msglen[i]);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+        rc = memcmp(cmac, cmac_answer[i], 16);
+        ABTS_INT_EQUAL(tc, 0, rc);
+    }
+
     for (i = 0; i < 4; i++)
     {
         rv = ogs_aes_cmac_verify(cmac_answer[i], key, msg[i], msglen[i]);
@@ -404,6 +437,7 @@ abts_suite *test_aes(abts_suite *suite)
     abts_run_test(suite, aes_test1, NULL);
     abts_run_test(suite, aes_test2, NULL);
     abts_run_test(suite, aes_test3, NULL);
+    abts_run_test(suite, aes_test4, NULL);
     abts_run_test(suite, cmac_test, NULL);
 
     return suite;
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+
+#include "pgw-context.h"
+#include "pgw-ipfw.h"
+
+#include "core/abts.h"
+
+static pgw_sess_t *sess_add(void)
+{
+    pgw_sess_t *sess = NULL;
+    ogs_paa_t paa;
+    uint8_t imsi[8] = "\x10\x32\x54\x76\x98\x10\x32\xf4";
+
+    if (!pgw_subnet_first()) {
+        ogs_assert(pgw_subnet_add("10.45.0.1", "16", NULL, "ogstun"));
+        ogs_assert(pgw_ue_pool_generate() == OGS_OK);
+    }
+
+    memset(&paa, 0, sizeof paa);
+    paa.pdn_type = OGS_GTP_PDN_TYPE_IPV4;
+
+    sess = pgw_sess_add(imsi, sizeof imsi, (char *)"internet",
+            OGS_GTP_PDN_TYPE_IPV4, 5, &paa);
+    ogs_assert(sess);
+
+    return sess;
+}
+
+static pgw_bearer_t *bearer_add(pgw_sess_t *sess, uint8_t ebi)
+{
+    pgw_bearer_t *bearer = pgw_bearer_add(sess);
+
+    ogs_assert(bearer);
+    bearer->ebi = ebi;
+
+    return bearer;
+}
+
+static void pf_add(pgw_bearer_t *bearer, uint32_t precedence,
+        uint8_t direction, const char *description)
+{
+    pgw_pf_t *pf = pgw_pf_add(bearer, precedence);
+
+    ogs_assert(pf);
+    pf->direction = direction;
+    ogs_assert(pgw_compile_packet_filter(&pf->rule, description) == OGS_OK);
+}
+
+/* Downlink IPv4 packet towards the UE */
+static uint8_t find_ebi(pgw_sess_t *sess, const char *src,
+        uint8_t proto, uint16_t sport, uint16_t dport)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    struct ip *ip_h = NULL;
+    struct udphdr *udp_h = NULL;
+    pgw_bearer_t *bearer = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, sizeof *ip_h + sizeof *udp_h);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put(pkbuf, sizeof *ip_h + sizeof *udp_h);
+    memset(pkbuf->data, 0, pkbuf->len);
+
+    ip_h = (struct ip *)pkbuf->data;
+    ip_h->ip_v = 4;
+    ip_h->ip_hl = sizeof *ip_h >> 2;
+    ip_h->ip_p = proto;
+    ip_h->ip_src.s_addr = inet_addr(src);
+    ip_h->ip_dst.s_addr = sess->ipv4->addr[0];
+
+    udp_h = (struct udphdr *)(ip_h + 1);
+    udp_h->uh_sport = htons(sport);
+    udp_h->uh_dport = htons(dport);
+
+    bearer = pgw_bearer_find_by_packet(pkbuf);
+    ogs_pkbuf_free(pkbuf);
+
+    return bearer ? bearer->ebi : 0;
+}
+
+static void classifier_test1(abts_case *tc, void *data)
+{
+    pgw_sess_t *sess = NULL;
+    pgw_bearer_t *bearer6 = NULL, *bearer7 = NULL;
+
+    sess = sess_add();
+
+    /* Lower precedence wins, whatever the bearer order */
+    bearer6 = bearer_add(sess, 6);
+    pf_add(bearer6, 20, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out 17 from 172.16.1.0/24 to assigned");
+    bearer7 = bearer_add(sess, 7);
+    pf_add(bearer7, 10, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out 17 from 172.16.1.3 5060 to assigned");
+    pgw_compile_classifier(sess);
+
+    ABTS_INT_EQUAL(tc, 2, sess->classifier.num_of_rule);
+    ABTS_INT_EQUAL(tc, 10, sess->classifier.rule[0].precedence);
+    ABTS_INT_EQUAL(tc, 20, sess->classifier.rule[1].precedence);
+
+    ABTS_INT_EQUAL(tc, 7,
+            find_ebi(sess, "172.16.1.3", IPPROTO_UDP, 5060, 20000));
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "172.16.1.3", IPPROTO_UDP, 5061, 20000));
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "172.16.1.4", IPPROTO_UDP, 5060, 20000));
+
+    /* Nothing matches : default bearer */
+    ABTS_INT_EQUAL(tc, 5,
+            find_ebi(sess, "172.16.2.3", IPPROTO_UDP, 5060, 20000));
+    ABTS_INT_EQUAL(tc, 5,
+            find_ebi(sess, "172.16.1.3", IPPROTO_TCP, 5060, 20000));
+
+    pgw_sess_remove(sess);
+}
+
+static void classifier_test2(abts_case *tc, void *data)
+{
+    pgw_sess_t *sess = NULL;
+    pgw_bearer_t *bearer6 = NULL, *bearer7 = NULL;
+
+    sess = sess_add();
+
+    /* Same precedence keeps the order of the bearers */
+    bearer6 = bearer_add(sess, 6);
+    pf_add(bearer6, 10, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out tcp from any 8000-8080 to assigned");
+    bearer7 = bearer_add(sess, 7);
+    pf_add(bearer7, 10, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out tcp from any to assigned");
+    pf_add(bearer7, 1, OGS_FLOW_UPLINK_ONLY,
+            "permit out tcp from any to assigned");
+    pgw_compile_classifier(sess);
+
+    ABTS_INT_EQUAL(tc, 2, sess->classifier.num_of_rule);
+
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "8.8.8.8", IPPROTO_TCP, 8000, 40000));
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "8.8.8.8", IPPROTO_TCP, 8080, 40000));
+    ABTS_INT_EQUAL(tc, 7,
+            find_ebi(sess, "8.8.8.8", IPPROTO_TCP, 7999, 40000));
+    ABTS_INT_EQUAL(tc, 7,
+            find_ebi(sess, "8.8.8.8", IPPROTO_TCP, 8081, 40000));
+    ABTS_INT_EQUAL(tc, 5,
+            find_ebi(sess, "8.8.8.8", IPPROTO_UDP, 8000, 40000));
+
+    pgw_sess_remove(sess);
+}
+
+static void classifier_test3(abts_case *tc, void *data)
+{
+    pgw_sess_t *sess = NULL;
+    pgw_bearer_t *bearer6 = NULL, *bearer7 = NULL, *bearer8 = NULL;
+    pgw_classifier_rule_t *rule = NULL;
+    pgw_flow_t flow;
+    pgw_dl_t *dl = NULL;
+    uint32_t addr;
+
+    sess = sess_add();
+    addr = sess->ipv4->addr[0];
+
+    bearer6 = bearer_add(sess, 6);
+    pf_add(bearer6, 30, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out ip from 172.16.1.3 to assigned");
+    bearer7 = bearer_add(sess, 7);
+    pf_add(bearer7, 20, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out 17 from 172.16.1.3 to assigned 20000-20010");
+
+    /* Create Bearer Response not yet received */
+    bearer8 = bearer_add(sess, 0);
+    pf_add(bearer8, 10, OGS_FLOW_DOWNLINK_ONLY,
+            "permit out ip from any to assigned 20000");
+    pgw_compile_classifier(sess);
+
+    ABTS_INT_EQUAL(tc, 2, sess->classifier.num_of_rule);
+
+    /* Protocol 0 matches any protocol, without looking at ports */
+    ABTS_INT_EQUAL(tc, 7,
+            find_ebi(sess, "172.16.1.3", IPPROTO_UDP, 5060, 20010));
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "172.16.1.3", IPPROTO_UDP, 5060, 20011));
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "172.16.1.3", IPPROTO_ICMP, 0, 0));
+
+    /* Non-first fragment has no ports */
+    memset(&flow, 0, sizeof flow);
+    flow.ipv = 4;
+    flow.proto = IPPROTO_UDP;
+    flow.src_addr[0] = inet_addr("172.16.1.3");
+    flow.dst_addr[0] = sess->ipv4->addr[0];
+    ABTS_INT_EQUAL(tc, 1, pgw_classifier_match(
+            sess->classifier.rule, sess->classifier.num_of_rule, &flow));
+
+    /* Deleting the bearer publishes a classifier without its filters */
+    pgw_bearer_remove(bearer7);
+    pgw_compile_classifier(sess);
+
+    ABTS_INT_EQUAL(tc, 1, sess->classifier.num_of_rule);
+    ABTS_INT_EQUAL(tc, 6,
+            find_ebi(sess, "172.16.1.3", IPPROTO_UDP, 5060, 20010));
+
+    dl = pgw_dl_find(4, sess->ipv4->addr);
+    ABTS_PTR_EQUAL(tc, sess->dl4, dl);
+    ABTS_PTR_EQUAL(tc, sess, dl->sess);
+    ABTS_INT_EQUAL(tc, 1, dl->num_of_rule);
+    rule = &dl->rule[0];
+    ABTS_INT_EQUAL(tc, 30, rule->precedence);
+    ABTS_PTR_EQUAL(tc, NULL, rule->bearer);
+
+    pgw_bearer_remove(bearer6);
+    pgw_compile_classifier(sess);
+
+    ABTS_INT_EQUAL(tc, 0, sess->classifier.num_of_rule);
+    ABTS_INT_EQUAL(tc, 0, pgw_dl_find(4, sess->ipv4->addr)->num_of_rule);
+    ABTS_INT_EQUAL(tc, 5,
+            find_ebi(sess, "172.16.1.3", IPPROTO_UDP, 5060, 20010));
+
+    ABTS_PTR_EQUAL(tc, sess, pgw_sess_find_by_ipv4(addr));
+    pgw_sess_remove(sess);
+    ABTS_PTR_EQUAL(tc, NULL, pgw_sess_find_by_ipv4(addr));
+}
+
+abts_suite *test_classifier(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, classifier_test1, NULL);
+    abts_run_test(suite, classifier_test2, NULL);
+    abts_run_test(suite, classifier_test3, NULL);
+
+    return suite;
+}
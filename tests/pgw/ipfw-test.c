@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+
+#include "pgw-context.h"
+#include "pgw-ipfw.h"
+
+#include "core/abts.h"
+
+/* Expected values are those the ipfw compile_rule() produced */
+
+static void ipfw_test1(abts_case *tc, void *data)
+{
+    pgw_rule_t rule;
+    int rv;
+
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out 17 from 10.45.0.2 to 172.16.1.3 5060");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ABTS_INT_EQUAL(tc, 17, rule.proto);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv4_local);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv4_remote);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv6_local);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv6_remote);
+    ABTS_TRUE(tc, rule.ip.local.addr[0] == inet_addr("10.45.0.2"));
+    ABTS_TRUE(tc, rule.ip.local.mask[0] == 0xffffffff);
+    ABTS_TRUE(tc, rule.ip.remote.addr[0] == inet_addr("172.16.1.3"));
+    ABTS_TRUE(tc, rule.ip.remote.mask[0] == 0xffffffff);
+    ABTS_INT_EQUAL(tc, 0, rule.port.local.low);
+    ABTS_INT_EQUAL(tc, 0, rule.port.local.high);
+    ABTS_INT_EQUAL(tc, 5060, rule.port.remote.low);
+    ABTS_INT_EQUAL(tc, 5060, rule.port.remote.high);
+}
+
+static void ipfw_test2(abts_case *tc, void *data)
+{
+    pgw_rule_t rule;
+    int rv;
+
+    /* Address is masked, "any" leaves the side empty */
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out tcp from 192.168.1.77/24 80 to any 1024-2048");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ABTS_INT_EQUAL(tc, 6, rule.proto);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv4_local);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv4_remote);
+    ABTS_TRUE(tc, rule.ip.local.addr[0] == inet_addr("192.168.1.0"));
+    ABTS_TRUE(tc, rule.ip.local.mask[0] == inet_addr("255.255.255.0"));
+    ABTS_TRUE(tc, rule.ip.remote.addr[0] == 0);
+    ABTS_TRUE(tc, rule.ip.remote.mask[0] == 0);
+    ABTS_INT_EQUAL(tc, 80, rule.port.local.low);
+    ABTS_INT_EQUAL(tc, 80, rule.port.local.high);
+    ABTS_INT_EQUAL(tc, 1024, rule.port.remote.low);
+    ABTS_INT_EQUAL(tc, 2048, rule.port.remote.high);
+
+    /* x.x.x.x/0 is "any" */
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out 6 from 0.0.0.0/0 to 10.45.0.0/16 443");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv4_local);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv4_remote);
+    ABTS_TRUE(tc, rule.ip.local.mask[0] == 0);
+    ABTS_TRUE(tc, rule.ip.remote.addr[0] == inet_addr("10.45.0.0"));
+    ABTS_TRUE(tc, rule.ip.remote.mask[0] == inet_addr("255.255.0.0"));
+}
+
+static void ipfw_test3(abts_case *tc, void *data)
+{
+    pgw_rule_t rule;
+    uint32_t addr[4];
+    int rv;
+
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out 17 from 2001:db8::1 to 2001:db8:cafe::/48 5060");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ABTS_INT_EQUAL(tc, 17, rule.proto);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv4_local);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv4_remote);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv6_local);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv6_remote);
+
+    inet_pton(AF_INET6, "2001:db8::1", addr);
+    ABTS_TRUE(tc, memcmp(rule.ip.local.addr, addr, OGS_IPV6_LEN) == 0);
+    ABTS_INT_EQUAL(tc, 128, pgw_mask_to_prefix(rule.ip.local.mask));
+
+    inet_pton(AF_INET6, "2001:db8:cafe::", addr);
+    ABTS_TRUE(tc, memcmp(rule.ip.remote.addr, addr, OGS_IPV6_LEN) == 0);
+    ABTS_TRUE(tc, rule.ip.remote.mask[0] == 0xffffffff);
+    ABTS_TRUE(tc, rule.ip.remote.mask[1] == htobe32(0xffff0000));
+    ABTS_TRUE(tc, rule.ip.remote.mask[2] == 0);
+    ABTS_TRUE(tc, rule.ip.remote.mask[3] == 0);
+    ABTS_INT_EQUAL(tc, 48, pgw_mask_to_prefix(rule.ip.remote.mask));
+
+    ABTS_INT_EQUAL(tc, 5060, rule.port.remote.low);
+    ABTS_INT_EQUAL(tc, 5060, rule.port.remote.high);
+}
+
+static void ipfw_test4(abts_case *tc, void *data)
+{
+    pgw_rule_t rule;
+    int rv;
+
+    /* "assigned" is the UE address, so the side stays unconstrained */
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out 17 from 172.16.1.3 5060 to assigned 20000-20010");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ABTS_INT_EQUAL(tc, 1, rule.ipv4_local);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv4_remote);
+    ABTS_INT_EQUAL(tc, 0, rule.ipv6_remote);
+    ABTS_TRUE(tc, rule.ip.remote.mask[0] == 0);
+    ABTS_INT_EQUAL(tc, 5060, rule.port.local.low);
+    ABTS_INT_EQUAL(tc, 5060, rule.port.local.high);
+    ABTS_INT_EQUAL(tc, 20000, rule.port.remote.low);
+    ABTS_INT_EQUAL(tc, 20010, rule.port.remote.high);
+}
+
+static void ipfw_test5(abts_case *tc, void *data)
+{
+    pgw_rule_t rule;
+    int rv;
+
+    /* Protocol by number and by name */
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out 58 from 2001:db8::/64 to any");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 58, rule.proto);
+    ABTS_INT_EQUAL(tc, 64, pgw_mask_to_prefix(rule.ip.local.mask));
+
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out udp from any to 10.45.0.2");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 17, rule.proto);
+
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out icmp from any to 10.45.0.2");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 1, rule.proto);
+
+    /* "ip" is any protocol */
+    rv = pgw_compile_packet_filter(&rule,
+            "permit out ip from 10.45.0.2 to any");
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 0, rule.proto);
+    ABTS_INT_EQUAL(tc, 1, rule.ipv4_local);
+}
+
+static void ipfw_test6(abts_case *tc, void *data)
+{
+    const char *malformed[] = {
+        "",
+        "deny out 17 from 10.45.0.2 to any",
+        "permit in 17 from 10.45.0.2 to any",
+        "permit out",
+        "permit out 17 10.45.0.2 to any",
+        "permit out 17 from 10.45.0.2 any",
+        "permit out 17 from 10.45.0.2 to",
+        "permit out 17 from 10.45.0.300 to any",
+        "permit out 17 from 10.45.0.2/40 to any",
+        "permit out 17 from 10.45.0.2 to any 70000",
+        "permit out 17 from 10.45.0.2 to any 2000-1000",
+        "permit out 17 from 10.45.0.2 to any 5060x",
+        "permit out 256 from 10.45.0.2 to any",
+        "permit out foo from 10.45.0.2 to any",
+        /* Nothing to match on */
+        "permit out ip from any to any",
+        "permit out ip from any to assigned",
+    };
+    pgw_rule_t rule;
+    int i;
+
+    for (i = 0; i < OGS_ARRAY_SIZE(malformed); i++)
+        ABTS_INT_EQUAL(tc, OGS_ERROR,
+                pgw_compile_packet_filter(&rule, malformed[i]));
+}
+
+static void ipfw_test7(abts_case *tc, void *data)
+{
+    const char *description =
+            "permit out 6 from 192.168.1.0/24 80 to 10.45.0.0/16 1024-2048";
+    pgw_rule_t rule1, rule2;
+
+    /* Second compile comes from the cache */
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            pgw_compile_packet_filter(&rule1, description));
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            pgw_compile_packet_filter(&rule2, description));
+    ABTS_TRUE(tc, memcmp(&rule1, &rule2, sizeof(pgw_rule_t)) == 0);
+}
+
+abts_suite *test_ipfw(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, ipfw_test1, NULL);
+    abts_run_test(suite, ipfw_test2, NULL);
+    abts_run_test(suite, ipfw_test3, NULL);
+    abts_run_test(suite, ipfw_test4, NULL);
+    abts_run_test(suite, ipfw_test5, NULL);
+    abts_run_test(suite, ipfw_test6, NULL);
+    abts_run_test(suite, ipfw_test7, NULL);
+
+    return suite;
+}
@@ -306,11 +306,126 @@ static void gtp_message_test1(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, 0, req.ue_tcp_port.presence);
 }
 
+static void gtp_message_test2(abts_case *tc, void *data)
+{
+    int rv;
+    /* Create Session Request with Charging Characteristics moved first */
+    const char *_payload =
+        "5f00020054000100 080055153011 340010f44c000600 9471527600414b00"
+        "0800536120009178 840056000d001855 f501102255f50100 019d015300030055"
+        "f501520001000657 0009008a80000084 0a32360a57000901 87000000000a3236"
+        "254700220005766f 6c7465036e673204 6d6e6574066d6e63 303130066d636335"
+        "3535046770727380 000100fc63000100 014f000500010000 00007f0001000048"
+        "000800000003e800 0007d04e001a0080 8021100100001081 0600000000830600"
+        "000000000d00000a 005d001f00490001 0005500016004505 0000000000000000"
+        "0000000000000000 0000000072000200 4000";
+    char hexbuf[OGS_MAX_SDU_LEN];
+    int len = 240;
+
+    ogs_gtp_create_session_request_t req;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    OGS_HEX(_payload, strlen(_payload), hexbuf);
+
+    pkbuf = ogs_pkbuf_alloc(NULL, len);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ogs_pkbuf_put_data(pkbuf, hexbuf, len);
+
+    memset(&req, 0, sizeof(req));
+    rv = ogs_tlv_parse_msg(&req, &ogs_gtp_tlv_desc_create_session_request,
+            pkbuf, OGS_TLV_MODE_T1_L2_I1);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ABTS_INT_EQUAL(tc, 1, req.charging_characteristics.presence);
+    ABTS_INT_EQUAL(tc, 2, req.charging_characteristics.len);
+    ABTS_TRUE(tc, memcmp("\x54\x00",
+                req.charging_characteristics.data, 2) == 0);
+    ABTS_INT_EQUAL(tc, 1, req.imsi.presence);
+    ABTS_INT_EQUAL(tc, 8, req.imsi.len);
+    ABTS_INT_EQUAL(tc, 1, req.rat_type.presence);
+    ABTS_INT_EQUAL(tc, OGS_GTP_RAT_TYPE_EUTRAN, req.rat_type.u8);
+    ABTS_INT_EQUAL(tc, 1, req.bearer_contexts_to_be_created.presence);
+    ABTS_INT_EQUAL(tc, 5, req.bearer_contexts_to_be_created.eps_bearer_id.u8);
+    ABTS_INT_EQUAL(tc, 22,
+            req.bearer_contexts_to_be_created.bearer_level_qos.len);
+    ABTS_INT_EQUAL(tc, 1, req.ue_time_zone.presence);
+
+    /* Truncated IE is rejected */
+    ogs_pkbuf_trim(pkbuf, len - 1);
+    memset(&req, 0, sizeof(req));
+    rv = ogs_tlv_parse_msg(&req, &ogs_gtp_tlv_desc_create_session_request,
+            pkbuf, OGS_TLV_MODE_T1_L2_I1);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
+#define NUM_OF_TEST_XACT 100
+
+static void gtp_message_test3(abts_case *tc, void *data)
+{
+    /* Many transactions in flight towards a single peer */
+    int rv, i;
+    ogs_timer_mgr_t *timer_mgr = NULL;
+    ogs_sockaddr_t *addr = NULL;
+    ogs_gtp_node_t *gnode = NULL;
+    ogs_gtp_header_t h;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_gtp_xact_t *local[NUM_OF_TEST_XACT], *remote[NUM_OF_TEST_XACT];
+
+    timer_mgr = ogs_timer_mgr_create();
+    ogs_assert(timer_mgr);
+    rv = ogs_gtp_xact_init(timer_mgr, 2 * NUM_OF_TEST_XACT);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", OGS_GTPV2_C_UDP_PORT, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    gnode = ogs_gtp_node_new(addr);
+    ogs_assert(gnode);
+    memcpy(&gnode->remote_addr, addr, sizeof(gnode->remote_addr));
+
+    memset(&h, 0, sizeof(h));
+    h.type = OGS_GTP_CREATE_SESSION_REQUEST_TYPE;
+    h.teid = 1;
+
+    for (i = 0; i < NUM_OF_TEST_XACT; i++) {
+        pkbuf = ogs_pkbuf_alloc(NULL, OGS_TLV_MAX_HEADROOM + 8);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_reserve(pkbuf, OGS_TLV_MAX_HEADROOM);
+        memset(ogs_pkbuf_put(pkbuf, 8), 0, 8);
+
+        local[i] = ogs_gtp_xact_local_create(gnode, &h, pkbuf, NULL, NULL);
+        ABTS_PTR_NOTNULL(tc, local[i]);
+
+        /* Remote XIDs overlap the local ones on purpose */
+        remote[i] = ogs_gtp_xact_remote_create(
+                gnode, OGS_GTP_XID_TO_SQN(local[i]->xid));
+        ABTS_PTR_NOTNULL(tc, remote[i]);
+    }
+
+    for (i = 0; i < NUM_OF_TEST_XACT; i++) {
+        ABTS_PTR_EQUAL(tc, local[i], ogs_gtp_xact_find_by_xid(gnode,
+                    OGS_GTP_CREATE_SESSION_RESPONSE_TYPE, local[i]->xid));
+        ABTS_PTR_EQUAL(tc, remote[i], ogs_gtp_xact_find_by_xid(gnode,
+                    OGS_GTP_CREATE_SESSION_REQUEST_TYPE, remote[i]->xid));
+    }
+    ABTS_PTR_EQUAL(tc, NULL, ogs_gtp_xact_find_by_xid(gnode,
+                OGS_GTP_CREATE_SESSION_RESPONSE_TYPE,
+                local[NUM_OF_TEST_XACT-1]->xid + 1));
+
+    ogs_gtp_node_free(gnode);
+
+    ogs_gtp_xact_final();
+    ogs_timer_mgr_destroy(timer_mgr);
+}
+
 abts_suite *test_gtp_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, gtp_message_test1, NULL);
+    abts_run_test(suite, gtp_message_test2, NULL);
+    abts_run_test(suite, gtp_message_test3, NULL);
 
     return suite;
 }
@@ -188,6 +188,41 @@ static void s1ap_message_test7(abts_case *tc, void *data)
     ogs_pkbuf_free(pkbuf);
 }
 
+static void s1ap_message_test8(abts_case *tc, void *data)
+{
+    /* InitialUE(Attach Request) decoded and encoded again */
+    const char *payload = 
+        "000c406f000006000800020001001a00"
+        "3c3b17df675aa8050741020bf600f110"
+        "000201030003e605f070000010000502"
+        "15d011d15200f11030395c0a003103e5"
+        "e0349011035758a65d0100e0c1004300"
+        "060000f1103039006440080000f1108c"
+        "3378200086400130004b00070000f110"
+        "000201";
+
+    ogs_s1ap_message_t message;
+    ogs_pkbuf_t *pkbuf, *s1apbuf;
+    int result;
+    char hexbuf[OGS_MAX_SDU_LEN];
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf, 
+            OGS_HEX(payload, strlen(payload), hexbuf), 115);
+
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, 0, result);
+
+    s1apbuf = ogs_s1ap_encode(&message);
+    ABTS_PTR_NOTNULL(tc, s1apbuf);
+    ABTS_INT_EQUAL(tc, 115, s1apbuf->len);
+    ABTS_TRUE(tc, memcmp(pkbuf->data, s1apbuf->data, s1apbuf->len) == 0);
+    ogs_pkbuf_free(s1apbuf);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
 abts_suite *test_s1ap_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -199,6 +234,7 @@ abts_suite *test_s1ap_message(abts_suite *suite)
     abts_run_test(suite, s1ap_message_test5, NULL);
     abts_run_test(suite, s1ap_message_test6, NULL);
     abts_run_test(suite, s1ap_message_test7, NULL);
+    abts_run_test(suite, s1ap_message_test8, NULL);
 
     return suite;
 }